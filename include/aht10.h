@@ -1,23 +1,50 @@
 #ifndef __AHT10_H__
 #define __AHT10_H__
 
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
 #include "driver/i2c.h"
 #include "esp_err.h"
+#include "sdkconfig.h"
 
 // AHT10 I2C设备地址
 #define AHT10_ADDR 0x38
+#define AHT10_ADDR_ALT 0x39 // ADR引脚接高电平时的地址
 
 // AHT10命令定义
 #define AHT10_CMD_INIT 0xE1    // 初始化命令
 #define AHT10_CMD_MEASURE 0xAC // 测量命令
 #define AHT10_CMD_RESET 0xBA   // 软复位命令
 
+// AHT10状态位定义
+#define AHT10_STATUS_BUSY 0x80 // bit7：1表示测量进行中
+#define AHT10_STATUS_CAL 0x08  // bit3：1表示已校准
+
+// 测量时序（单位：毫秒）
+#define AHT10_MEASURE_TYPICAL_MS 75  // 典型转换时间，触发后首次查询前的等待
+#define AHT10_POLL_INTERVAL_MS 5     // 忙状态下的轮询间隔
+#define AHT10_MEASURE_TIMEOUT_MS 150 // 超过该时间仍忙则判定超时
+
+// 测量帧长度（状态字节 + 20位湿度 + 20位温度）
+#define AHT10_FRAME_LEN 6
+
+// 批量解析时无效帧的输出值
+#define AHT10_CENTI_INVALID INT16_MIN
+#define AHT10_HUM_CENTI_INVALID UINT16_MAX
+
 // 温湿度数据结构体
 typedef struct {
     float temperature; // 温度，单位：摄氏度
     float humidity;    // 湿度，单位：百分比
 } aht10_data_t;
 
+// 定点温湿度，由原始值只经乘法和移位得到
+typedef struct {
+    int16_t temp_centi; // 温度，单位：0.01℃（-5000 至 15000）
+    uint16_t hum_centi; // 湿度，单位：0.01%（0 至 10000）
+} aht10_fixed_t;
+
 /**
  * @brief 初始化AHT10传感器
  * 
@@ -35,5 +62,127 @@ esp_err_t aht10_init(i2c_port_t i2c_num);
  */
 esp_err_t aht10_read_data(i2c_port_t i2c_num, aht10_data_t *data);
 
+/**
+ * @brief 触发一次温湿度测量，立即返回
+ * 
+ * @param i2c_num I2C端口号
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t aht10_trigger_measurement(i2c_port_t i2c_num);
+
+/**
+ * @brief 读取状态字节，判断测量是否仍在进行
+ * 
+ * @param i2c_num I2C端口号
+ * @param busy 输出忙标志（状态位7）
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t aht10_is_busy(i2c_port_t i2c_num, bool *busy);
+
+/**
+ * @brief 读取并解析测量结果
+ * 
+ * 一次读取6字节，首字节即状态字节，因此该函数本身也可用于轮询。
+ * 
+ * @param i2c_num I2C端口号
+ * @param data 存储温湿度数据的结构体指针
+ * @return esp_err_t 成功返回ESP_OK；转换未完成返回ESP_ERR_NOT_FINISHED
+ */
+esp_err_t aht10_collect(i2c_port_t i2c_num, aht10_data_t *data);
+
+/**
+ * @brief 初始化指定地址的AHT10传感器
+ * 
+ * @param i2c_num I2C端口号
+ * @param dev_addr 设备地址（AHT10_ADDR或AHT10_ADDR_ALT）
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t aht10_init_at(i2c_port_t i2c_num, uint8_t dev_addr);
+
+/**
+ * @brief 触发指定地址的AHT10测量，立即返回
+ * 
+ * @param i2c_num I2C端口号
+ * @param dev_addr 设备地址
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t aht10_trigger_measurement_at(i2c_port_t i2c_num, uint8_t dev_addr);
+
+/**
+ * @brief 读取指定地址AHT10的状态字节，判断测量是否仍在进行
+ * 
+ * @param i2c_num I2C端口号
+ * @param dev_addr 设备地址
+ * @param busy 输出忙标志（状态位7）
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t aht10_is_busy_at(i2c_port_t i2c_num, uint8_t dev_addr, bool *busy);
+
+/**
+ * @brief 读取并解析指定地址的AHT10测量结果
+ * 
+ * @param i2c_num I2C端口号
+ * @param dev_addr 设备地址
+ * @param data 存储温湿度数据的结构体指针
+ * @return esp_err_t 成功返回ESP_OK；转换未完成返回ESP_ERR_NOT_FINISHED
+ */
+esp_err_t aht10_collect_at(i2c_port_t i2c_num, uint8_t dev_addr, aht10_data_t *data);
+
+/**
+ * @brief 读取并以定点数解析指定地址的AHT10测量结果
+ * 
+ * @param i2c_num I2C端口号
+ * @param dev_addr 设备地址
+ * @param fixed 输出定点温湿度
+ * @return esp_err_t 成功返回ESP_OK；转换未完成返回ESP_ERR_NOT_FINISHED
+ */
+esp_err_t aht10_collect_fixed_at(i2c_port_t i2c_num, uint8_t dev_addr, aht10_fixed_t *fixed);
+
+/**
+ * @brief 以定点数解析6字节测量帧，只使用乘法和移位
+ * 
+ * @param frame 原始数据，首字节为状态字节
+ * @param out 输出定点温湿度
+ * @return esp_err_t 成功返回ESP_OK；状态字节忙标志置位（数据无效）返回ESP_ERR_NOT_FINISHED
+ */
+esp_err_t aht10_decode_frame(const uint8_t frame[AHT10_FRAME_LEN], aht10_fixed_t *out);
+
+/**
+ * @brief 批量解析测量帧（用于历史回放和补录），结果按温度、湿度分别写入两个数组
+ * 
+ * 忙标志置位的帧输出AHT10_CENTI_INVALID和AHT10_HUM_CENTI_INVALID。
+ * 
+ * @param frames 连续存放的测量帧
+ * @param count 帧数
+ * @param temp_centi 温度输出数组，单位：0.01℃
+ * @param hum_centi 湿度输出数组，单位：0.01%
+ * @return size_t 有效帧数
+ */
+size_t aht10_decode_batch(const uint8_t (*frames)[AHT10_FRAME_LEN], size_t count,
+                          int16_t *temp_centi, uint16_t *hum_centi);
+
+/**
+ * @brief 将定点温湿度转换为浮点视图
+ * 
+ * @param fixed 定点温湿度
+ * @param data 输出浮点温湿度
+ */
+void aht10_fixed_to_float(const aht10_fixed_t *fixed, aht10_data_t *data);
+
+/**
+ * @brief 将浮点温湿度四舍五入为定点表示，由定点值换算得到的浮点数可无损还原
+ * 
+ * @param data 浮点温湿度
+ * @param fixed 输出定点温湿度
+ */
+void aht10_float_to_fixed(const aht10_data_t *data, aht10_fixed_t *fixed);
+
+#if CONFIG_PERF_BENCHMARKS
+/**
+ * @brief 对比浮点逐帧解析与定点批量解析的耗时，并校验两者误差
+ */
+void aht10_decode_benchmark(void);
+#endif
+
 
 #endif
\ No newline at end of file
@@ -0,0 +1,74 @@
+#ifndef __BOOT_PROF_H__
+#define __BOOT_PROF_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+
+// 阶段名称最大长度（含结束符）
+#define BOOT_PROF_NAME_LEN 16
+
+// 一个启动阶段
+typedef struct {
+    char name[BOOT_PROF_NAME_LEN];  // 阶段名称
+    uint32_t start_us;              // 开始时间（自芯片启动）
+    uint32_t duration_us;           // 耗时
+    int32_t heap_delta;             // 空闲堆变化，负数表示该阶段占用的内存
+} boot_prof_stage_t;
+
+// 一次启动的时间线
+typedef struct {
+    uint32_t boot_count;            // 自上电以来的启动序号
+    uint8_t reset_reason;           // 复位原因（esp_reset_reason_t）
+    uint8_t stage_count;            // 已记录的阶段数
+    bool complete;                  // 是否执行到boot_prof_finish()
+    uint32_t app_start_us;          // 进入app_main的时间（含二级引导后的系统初始化）
+    uint32_t total_us;              // 最后一个阶段结束的时间
+    uint32_t free_heap_start;       // 进入app_main时的空闲堆
+    uint32_t free_heap_end;         // 最后一个阶段结束时的空闲堆
+    boot_prof_stage_t stages[CONFIG_BOOT_PROF_MAX_STAGES];
+} boot_prof_record_t;
+
+/**
+ * @brief 开始记录本次启动，应在app_main开头调用
+ *
+ * 记录保存在RTC内存中，软件复位、看门狗复位和异常重启后仍保留，上电复位时清空。
+ * 保留最近CONFIG_BOOT_PROF_HISTORY次启动。
+ */
+void boot_prof_start(void);
+
+/**
+ * @brief 结束一个阶段，阶段从上一次标记（或boot_prof_start）开始
+ *
+ * 超过CONFIG_BOOT_PROF_MAX_STAGES的阶段被忽略。
+ *
+ * @param name 阶段名称，超长部分截断
+ */
+void boot_prof_mark(const char *name);
+
+/**
+ * @brief 标记启动完成
+ *
+ * 未完成的记录说明启动过程中发生了复位，可结合下一次启动的复位原因排查。
+ */
+void boot_prof_finish(void);
+
+/**
+ * @brief 读取一条保存的启动记录
+ *
+ * @param index 0为本次启动，1为上一次，依此类推
+ * @param record 输出记录
+ * @return bool 记录存在返回true
+ */
+bool boot_prof_get(size_t index, boot_prof_record_t *record);
+
+/**
+ * @brief 复位原因的名称
+ *
+ * @param reason 复位原因（esp_reset_reason_t）
+ * @return const char* 名称，如"poweron"、"panic"
+ */
+const char *boot_prof_reset_reason_name(uint8_t reason);
+
+#endif
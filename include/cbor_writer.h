@@ -0,0 +1,77 @@
+#ifndef __CBOR_WRITER_H__
+#define __CBOR_WRITER_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+#include "chunk_buf.h"
+#include "sdkconfig.h"
+
+/**
+ * 流式CBOR（RFC 8949）写入器
+ *
+ * 与json_writer相同，直接编码到调用者提供的缓冲区，不进行堆分配；
+ * 绑定HTTP请求时缓冲区写满即分块发送。元素个数未知的容器使用不定长编码，
+ * 以cbor_end()结束；个数已知的小数组（如单个采样）用cbor_arr_begin_n()，省去结束字节。
+ * 整数按数值大小选择最短编码：0-23占1字节，24-255占2字节，256-65535占3字节。
+ */
+typedef struct {
+    chunk_buf_t out;    // 输出缓冲区，已写入长度和首个错误见out.len、out.err
+} cbor_writer_t;
+
+/**
+ * @brief 初始化写入器
+ *
+ * @param w 写入器
+ * @param buf 输出缓冲区，容量不小于9字节
+ * @param size 缓冲区容量
+ * @param req 绑定的HTTP请求，为NULL时只写入缓冲区
+ */
+void cbor_writer_init(cbor_writer_t *w, uint8_t *buf, size_t size, httpd_req_t *req);
+
+// 不定长的映射/数组，以cbor_end()结束
+void cbor_map_begin(cbor_writer_t *w);
+void cbor_arr_begin(cbor_writer_t *w);
+void cbor_end(cbor_writer_t *w);
+
+/**
+ * @brief 开始一个定长数组，其后必须紧跟count个元素
+ *
+ * @param w 写入器
+ * @param count 元素个数
+ */
+void cbor_arr_begin_n(cbor_writer_t *w, size_t count);
+
+// 写入单个值；映射中的键同样以cbor_str写入
+void cbor_str(cbor_writer_t *w, const char *value);
+void cbor_int(cbor_writer_t *w, int64_t value);
+void cbor_uint(cbor_writer_t *w, uint64_t value);
+void cbor_bool(cbor_writer_t *w, bool value);
+void cbor_null(cbor_writer_t *w);
+
+// 键值对便捷函数
+void cbor_kv_str(cbor_writer_t *w, const char *key, const char *value);
+void cbor_kv_int(cbor_writer_t *w, const char *key, int64_t value);
+void cbor_kv_uint(cbor_writer_t *w, const char *key, uint64_t value);
+void cbor_kv_bool(cbor_writer_t *w, const char *key, bool value);
+
+/**
+ * @brief 结束写入
+ *
+ * 绑定HTTP请求时发送剩余内容及结束块；否则只返回错误状态。
+ *
+ * @param w 写入器
+ * @return esp_err_t 成功返回ESP_OK；缓冲区不足返回ESP_ERR_NO_MEM；发送失败返回相应错误码
+ */
+esp_err_t cbor_writer_finish(cbor_writer_t *w);
+
+#if CONFIG_PERF_BENCHMARKS
+/**
+ * @brief 对比cJSON、json_writer与cbor_writer输出1000个采样的耗时和响应大小
+ */
+void cbor_writer_benchmark(void);
+#endif
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef __CHUNK_BUF_H__
+#define __CHUNK_BUF_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+/**
+ * 分块发送的输出缓冲区
+ *
+ * json_writer、cbor_writer、metrics_writer及跟踪日志下载共用的底层输出：内容写入调用者提供的缓冲区，
+ * 绑定HTTP请求时写满即通过httpd_resp_send_chunk发送；未绑定时超出容量记录错误并停止写入。
+ * 出错后后续写入全部忽略，由finish返回首个错误。
+ */
+typedef struct {
+    httpd_req_t *req;   // 绑定的HTTP请求，可为NULL
+    char *buf;          // 输出缓冲区
+    size_t size;        // 缓冲区容量
+    size_t len;         // 当前已写入长度
+    esp_err_t err;      // 首个错误
+} chunk_buf_t;
+
+/**
+ * @brief 初始化缓冲区
+ *
+ * @param cb 缓冲区
+ * @param buf 输出缓冲区
+ * @param size 缓冲区容量
+ * @param req 绑定的HTTP请求，为NULL时只写入缓冲区
+ */
+void chunk_buf_init(chunk_buf_t *cb, char *buf, size_t size, httpd_req_t *req);
+
+/**
+ * @brief 发送已缓冲的内容
+ *
+ * @param cb 缓冲区
+ * @return bool 成功返回true；未绑定请求（记为ESP_ERR_NO_MEM）或发送失败返回false
+ */
+bool chunk_buf_flush(chunk_buf_t *cb);
+
+/**
+ * @brief 剩余空间不足时的写入路径，由chunk_buf_write调用
+ */
+void chunk_buf_write_slow(chunk_buf_t *cb, const void *data, size_t len);
+
+/**
+ * @brief 写入数据，空间不足时先发送已缓冲的内容
+ *
+ * @param cb 缓冲区
+ * @param data 数据
+ * @param len 长度
+ */
+static inline void chunk_buf_write(chunk_buf_t *cb, const void *data, size_t len)
+{
+    if (cb->err == ESP_OK && cb->size - cb->len >= len) {
+        memcpy(cb->buf + cb->len, data, len);
+        cb->len += len;
+        return;
+    }
+    chunk_buf_write_slow(cb, data, len);
+}
+
+/**
+ * @brief 确保有n个连续字节可写，调用者写入后自行增加len
+ *
+ * @param cb 缓冲区
+ * @param n 所需字节数，不超过缓冲区容量
+ * @return char* 写入位置；出错时返回NULL
+ */
+static inline char *chunk_buf_reserve(chunk_buf_t *cb, size_t n)
+{
+    if (cb->err != ESP_OK) {
+        return NULL;
+    }
+    if (cb->size - cb->len < n && !chunk_buf_flush(cb)) {
+        return NULL;
+    }
+    return cb->buf + cb->len;
+}
+
+/**
+ * @brief 结束写入
+ *
+ * 绑定HTTP请求时发送剩余内容及结束块；否则只返回错误状态。
+ *
+ * @param cb 缓冲区
+ * @return esp_err_t 成功返回ESP_OK；缓冲区不足返回ESP_ERR_NO_MEM；发送失败返回相应错误码
+ */
+esp_err_t chunk_buf_finish(chunk_buf_t *cb);
+
+#endif
@@ -1,21 +1,104 @@
 #ifndef EVENT_HANDLER_H
 #define EVENT_HANDLER_H
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
 #include "esp_event.h"
+#include "sdkconfig.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-#define MAX_EVENT_HANDLERS 10
+// 处理器的注册信息与执行统计
+typedef struct {
+    esp_event_base_t base;        // 注册的事件基础类型
+    int32_t id;                   // 注册的事件ID
+    esp_event_handler_t handler;  // 事件处理函数
+    bool deferred;                // 是否在工作任务中执行
+    uint32_t calls;               // 执行次数
+    uint32_t drops;               // 延迟队列满时丢弃的事件数
+    uint64_t exec_total_us;       // 累计执行耗时
+    uint32_t exec_max_us;         // 最长一次执行耗时
+    uint64_t queue_total_us;      // 累计排队延迟（仅延迟处理器）
+    uint32_t queue_max_us;        // 最长一次排队延迟（仅延迟处理器）
+} event_handler_stats_t;
 
-void event_handler_init(void);
+/**
+ * @brief 初始化事件分发表
+ *
+ * 必须在注册任何处理器之前调用，可在默认事件循环创建之前调用。
+ *
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t event_handler_init(void);
 
-void event_handler_register(esp_event_base_t event_base, int32_t event_id,
-                          esp_event_handler_t event_handler, void* event_handler_arg);
+/**
+ * @brief 注册事件处理器
+ *
+ * 处理器按(event_base, event_id)登记到分发表中，分发时只调用匹配的处理器。
+ * 某个事件基础类型第一次出现时，分发表向默认事件循环注册一次自身，
+ * 因此注册具体event_base时默认事件循环必须已创建。
+ *
+ * event_id为ESP_EVENT_ANY_ID时匹配该基础类型的所有事件；
+ * event_base为ESP_EVENT_ANY_BASE（此时event_id必须为ESP_EVENT_ANY_ID）时
+ * 匹配经分发表转发的所有事件。
+ *
+ * @param event_base 事件基础类型
+ * @param event_id 事件ID
+ * @param event_handler 事件处理函数
+ * @param event_handler_arg 传递给事件处理函数的参数
+ * @return esp_err_t 成功返回ESP_OK；同一组合已注册返回ESP_ERR_INVALID_STATE
+ */
+esp_err_t event_handler_register(esp_event_base_t event_base, int32_t event_id,
+                                 esp_event_handler_t event_handler, void* event_handler_arg);
 
-void event_handler_handle(void* arg, esp_event_base_t event_base,
-                        int32_t event_id, void* event_data);
+/**
+ * @brief 注册在工作任务中执行的事件处理器
+ *
+ * 分发时只把事件数据复制进有界队列后立即返回，处理器在独立的工作任务
+ * （CONFIG_EVENT_HANDLER_WORKER_PRIORITY）中执行，适合会阻塞的操作。
+ * 队列满时丢弃事件并计入drops。事件数据非空时复制data_size字节，
+ * 因此同一处理器匹配的各事件数据长度不应小于data_size。
+ *
+ * @param event_base 事件基础类型
+ * @param event_id 事件ID
+ * @param event_handler 事件处理函数
+ * @param event_handler_arg 传递给事件处理函数的参数
+ * @param data_size 事件数据长度，不超过CONFIG_EVENT_HANDLER_DEFERRED_DATA_MAX
+ * @return esp_err_t 成功返回ESP_OK；data_size过大返回ESP_ERR_INVALID_SIZE
+ */
+esp_err_t event_handler_register_deferred(esp_event_base_t event_base, int32_t event_id,
+                                          esp_event_handler_t event_handler, void* event_handler_arg,
+                                          size_t data_size);
+
+/**
+ * @brief 注销事件处理器
+ *
+ * 参数须与注册时完全一致。可在事件处理函数内调用（包括注销自身）。
+ * 返回后处理器不会再被调用，已排队的延迟事件被丢弃。在处理函数之外调用时，
+ * 若工作任务正在执行该延迟处理器，会阻塞到本次执行返回，之后即可释放event_handler_arg；
+ * 在处理函数内调用时不等待正在执行的调用，此时释放参数须由调用者另行同步。
+ *
+ * @param event_base 事件基础类型
+ * @param event_id 事件ID
+ * @param event_handler 事件处理函数
+ * @param event_handler_arg 注册时的参数
+ * @return esp_err_t 成功返回ESP_OK；未找到返回ESP_ERR_NOT_FOUND
+ */
+esp_err_t event_handler_unregister(esp_event_base_t event_base, int32_t event_id,
+                                   esp_event_handler_t event_handler, void* event_handler_arg);
+
+/**
+ * @brief 读取各处理器的注册信息与执行统计
+ *
+ * @param stats 输出数组
+ * @param max_count 数组长度
+ * @return size_t 已注册的处理器总数，可能大于max_count
+ */
+size_t event_handler_get_stats(event_handler_stats_t *stats, size_t max_count);
 
 #ifdef __cplusplus
 }
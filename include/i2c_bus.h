@@ -0,0 +1,123 @@
+#ifndef __I2C_BUS_H__
+#define __I2C_BUS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "driver/i2c.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// 事务优先级，同一端口上高优先级的事务先执行
+typedef enum {
+    I2C_BUS_PRIO_LOW = 0,   // 后台任务，如周期采样
+    I2C_BUS_PRIO_NORMAL,    // 默认优先级
+    I2C_BUS_PRIO_HIGH,      // 交互请求，如HTTP触发的即时读取
+    I2C_BUS_PRIO_MAX,
+} i2c_bus_prio_t;
+
+typedef struct i2c_bus_txn i2c_bus_txn_t;
+
+/**
+ * @brief 事务完成回调，在总线管理任务中调用，不应阻塞
+ *
+ * @param txn 已完成的事务，回调返回后调用者才可释放或复用
+ * @param result 事务结果
+ * @param arg 用户参数
+ */
+typedef void (*i2c_bus_done_cb_t)(i2c_bus_txn_t *txn, esp_err_t result, void *arg);
+
+/**
+ * I2C事务描述
+ *
+ * 由调用者分配，提交后直到完成回调或通知到达前不得修改或释放。
+ * write_len和read_len均非0时为写-重复起始-读的组合事务，均为0时为地址探测。
+ */
+struct i2c_bus_txn {
+    uint8_t dev_addr;           // 设备地址
+    const uint8_t *write_data;  // 要写入的数据
+    size_t write_len;           // 写入长度
+    uint8_t *read_data;         // 读取缓冲区
+    size_t read_len;            // 读取长度
+    uint32_t timeout_ms;        // 事务超时，0表示使用I2C_DRIVER_TIMEOUT_MS
+    i2c_bus_prio_t prio;        // 优先级
+    i2c_bus_done_cb_t cb;       // 完成回调，可为NULL
+    void *cb_arg;               // 回调参数
+    TaskHandle_t notify_task;   // 完成后通知的任务，可为NULL
+    uint32_t notify_bits;       // 通知值（按位或，eSetBits）
+    esp_err_t result;           // 事务结果，完成后有效
+    int64_t submit_us;          // 提交时间，由总线管理器填写
+};
+
+// 每个设备的事务统计
+typedef struct {
+    uint8_t dev_addr;       // 设备地址
+    uint32_t transactions;  // 事务数
+    uint32_t errors;        // 失败数（含超时）
+    uint32_t timeouts;      // 超时数
+    uint64_t busy_us;       // 总线占用总时长
+    uint32_t max_busy_us;   // 单次最长占用
+    uint64_t wait_us;       // 排队等待总时长
+    uint32_t max_wait_us;   // 单次最长等待
+} i2c_bus_dev_stats_t;
+
+/**
+ * @brief 启动指定端口的总线管理任务
+ *
+ * 端口需已通过i2c_master_init初始化。启动后my_i2c_master_*接口的调用会排队交由管理任务执行。
+ *
+ * @param i2c_num I2C端口号
+ * @return esp_err_t 成功返回ESP_OK；已启动返回ESP_ERR_INVALID_STATE；内存不足返回ESP_ERR_NO_MEM
+ */
+esp_err_t i2c_bus_start(i2c_port_t i2c_num);
+
+/**
+ * @brief 查询指定端口的总线管理任务是否运行
+ *
+ * @param i2c_num I2C端口号
+ * @return bool 运行中返回true
+ */
+bool i2c_bus_is_running(i2c_port_t i2c_num);
+
+/**
+ * @brief 当前任务是否为指定端口的总线管理任务（例如在完成回调中）
+ *
+ * @param i2c_num I2C端口号
+ * @return bool 是返回true
+ */
+bool i2c_bus_in_bus_task(i2c_port_t i2c_num);
+
+/**
+ * @brief 异步提交一个事务
+ *
+ * 完成后依次调用txn->cb并向txn->notify_task发送通知。
+ *
+ * @param i2c_num I2C端口号
+ * @param txn 事务
+ * @param wait 队列满时的最长等待时间
+ * @return esp_err_t 成功返回ESP_OK；队列已满返回ESP_ERR_TIMEOUT；未启动返回ESP_ERR_INVALID_STATE
+ */
+esp_err_t i2c_bus_submit(i2c_port_t i2c_num, i2c_bus_txn_t *txn, TickType_t wait);
+
+/**
+ * @brief 同步执行一个事务，阻塞当前任务直到完成
+ *
+ * 忽略txn中的cb和notify_task。不能在总线管理任务（完成回调）中调用。
+ *
+ * @param i2c_num I2C端口号
+ * @param txn 事务
+ * @return esp_err_t 事务结果
+ */
+esp_err_t i2c_bus_transfer(i2c_port_t i2c_num, i2c_bus_txn_t *txn);
+
+/**
+ * @brief 获取指定端口上各设备的事务统计
+ *
+ * @param i2c_num I2C端口号
+ * @param out 输出数组
+ * @param max 输出数组容量
+ * @return size_t 实际输出的设备数
+ */
+size_t i2c_bus_get_stats(i2c_port_t i2c_num, i2c_bus_dev_stats_t *out, size_t max);
+
+#endif
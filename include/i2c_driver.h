@@ -3,6 +3,21 @@
 
 #include "driver/i2c.h"
 #include "esp_err.h"
+#include "sdkconfig.h"
+#include "metrics.h"
+
+// 单次事务的命令链缓冲区大小，足够容纳写-重复起始-读的组合事务
+#define I2C_DRIVER_LINK_BUF_SIZE I2C_LINK_RECOMMENDED_SIZE(2)
+// 事务超时时间（单位：毫秒）
+#define I2C_DRIVER_TIMEOUT_MS 1000
+
+// 单个端口的事务统计，由my_i2c_master_transfer记录，探测事务不计入
+typedef struct {
+    atomic_uint nacks;          // 设备未应答（ESP_FAIL）
+    atomic_uint timeouts;       // 超时（ESP_ERR_TIMEOUT）
+    atomic_uint errors;         // 其他错误
+    metrics_hist_t latency;     // 事务耗时（含失败的事务）
+} i2c_driver_metrics_t;
 
 /**
  * @brief 初始化I2C控制器
@@ -32,4 +47,62 @@ esp_err_t my_i2c_master_write(i2c_port_t i2c_num, uint8_t dev_addr, const uint8_
  */
 esp_err_t my_i2c_master_read(i2c_port_t i2c_num, uint8_t dev_addr, uint8_t *data, size_t data_len);
 
-#endif
\ No newline at end of file
+/**
+ * @brief 直接在当前任务中执行一次I2C事务，不经过总线管理器，失败时不输出日志
+ * 
+ * 一般由总线管理任务调用；应用代码应使用下面的my_i2c_master_*接口。
+ * write_len和read_len均为0时只发送地址（探测）。
+ * 
+ * @param dev_addr I2C设备地址
+ * @param write_data 要写入的数据
+ * @param write_len 写入长度，0表示不写
+ * @param read_data 读取到的数据存储地址
+ * @param read_len 读取长度，0表示不读
+ * @param timeout_ms 超时时间，单位：毫秒
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t my_i2c_master_transfer(i2c_port_t i2c_num, uint8_t dev_addr,
+                                 const uint8_t *write_data, size_t write_len,
+                                 uint8_t *read_data, size_t read_len, uint32_t timeout_ms);
+
+/**
+ * @brief 先写后读的组合事务，中间使用重复起始条件，不释放总线
+ * 
+ * @param dev_addr I2C设备地址
+ * @param write_data 要写入的数据（通常为命令或寄存器地址）
+ * @param write_len 写入长度
+ * @param read_data 读取到的数据存储地址
+ * @param read_len 读取长度
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t my_i2c_master_write_read(i2c_port_t i2c_num, uint8_t dev_addr,
+                                   const uint8_t *write_data, size_t write_len,
+                                   uint8_t *read_data, size_t read_len);
+
+/**
+ * @brief 探测总线上指定地址是否有设备应答，失败时不输出日志
+ * 
+ * @param dev_addr I2C设备地址
+ * @param timeout_ms 超时时间，单位：毫秒
+ * @return esp_err_t 设备应答返回ESP_OK，否则返回相应错误码
+ */
+esp_err_t my_i2c_master_probe(i2c_port_t i2c_num, uint8_t dev_addr, uint32_t timeout_ms);
+
+/**
+ * @brief 获取端口的事务统计，统计以原子计数器记录，可随时读取
+ * 
+ * @param i2c_num I2C端口号
+ * @return const i2c_driver_metrics_t* 端口号无效时返回NULL
+ */
+const i2c_driver_metrics_t *i2c_driver_get_metrics(i2c_port_t i2c_num);
+
+#if CONFIG_PERF_BENCHMARKS
+/**
+ * @brief 对比堆分配命令链与栈上命令链的事务耗时和堆操作次数
+ * 
+ * @param dev_addr 用于测试的设备地址，需在总线上
+ */
+void i2c_driver_benchmark(i2c_port_t i2c_num, uint8_t dev_addr);
+#endif
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef __I2C_REGISTRY_H__
+#define __I2C_REGISTRY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "driver/i2c.h"
+#include "esp_err.h"
+
+// 7位地址的有效扫描范围
+#define I2C_REGISTRY_ADDR_MIN 0x01
+#define I2C_REGISTRY_ADDR_MAX 0x7E
+
+/**
+ * @brief 发现总线上的设备并建立设备登记表
+ *
+ * 各端口并行扫描。每个端口先探测NVS中保存的上次设备列表，全部应答时直接采用；
+ * 否则（或force_full为true、无缓存时）以短超时探测全部地址，并在结果变化时写回NVS。
+ * NVS未初始化时跳过缓存，只做完整扫描。
+ *
+ * @param ports 已初始化的I2C端口
+ * @param port_count 端口数
+ * @param force_full 是否忽略缓存强制完整扫描
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t i2c_registry_discover(const i2c_port_t *ports, size_t port_count, bool force_full);
+
+/**
+ * @brief 指定端口是否已完成发现
+ *
+ * @param i2c_num I2C端口号
+ * @return bool 已完成返回true
+ */
+bool i2c_registry_scanned(i2c_port_t i2c_num);
+
+/**
+ * @brief 查询指定端口上的地址是否有设备
+ *
+ * @param i2c_num I2C端口号
+ * @param dev_addr 设备地址
+ * @return bool 有设备返回true；未扫描的端口返回false
+ */
+bool i2c_registry_has(i2c_port_t i2c_num, uint8_t dev_addr);
+
+/**
+ * @brief 在所有已扫描端口中查找设备
+ *
+ * @param dev_addr 设备地址
+ * @param i2c_num 输出找到设备的端口，可为NULL
+ * @return esp_err_t 找到返回ESP_OK，否则返回ESP_ERR_NOT_FOUND
+ */
+esp_err_t i2c_registry_find(uint8_t dev_addr, i2c_port_t *i2c_num);
+
+/**
+ * @brief 列出指定端口上的设备地址
+ *
+ * @param i2c_num I2C端口号
+ * @param out 输出数组，按地址升序
+ * @param max 输出数组容量
+ * @return size_t 设备总数（可能大于max）
+ */
+size_t i2c_registry_list(i2c_port_t i2c_num, uint8_t *out, size_t max);
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef __I2C_SIM_H__
+#define __I2C_SIM_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "driver/i2c.h"
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#if CONFIG_I2C_SIM
+
+// 可注入的故障
+typedef enum {
+    I2C_SIM_FAULT_NONE = 0,
+    I2C_SIM_FAULT_NACK,         // 设备不应答，事务返回ESP_FAIL
+    I2C_SIM_FAULT_TIMEOUT,      // 总线超时，事务返回ESP_ERR_TIMEOUT
+    I2C_SIM_FAULT_BUSY_FRAME,   // 读取的测量帧忙标志置位（无效帧）
+} i2c_sim_fault_t;
+
+// 模拟总线统计
+typedef struct {
+    uint32_t transactions;  // 事务数
+    uint32_t nacks;         // 无设备或注入的NACK数
+    uint32_t conversions;   // 触发的测量次数
+} i2c_sim_stats_t;
+
+/**
+ * @brief 在模拟总线上添加一个AHT10模型
+ *
+ * 模型上电时未校准，收到初始化命令后置位校准位；收到测量命令后忙标志保持
+ * CONFIG_I2C_SIM_CONVERSION_MS毫秒，期间读取的帧忙标志置位。
+ *
+ * @param i2c_num I2C端口号
+ * @param dev_addr 设备地址
+ * @return esp_err_t 成功返回ESP_OK；设备数已满返回ESP_ERR_NO_MEM
+ */
+esp_err_t i2c_sim_add_aht10(i2c_port_t i2c_num, uint8_t dev_addr);
+
+/**
+ * @brief 设置AHT10模型的测量值，每次测量在此基础上加入少量抖动
+ *
+ * @param i2c_num I2C端口号
+ * @param dev_addr 设备地址
+ * @param temp_centi 温度，单位：0.01℃
+ * @param hum_centi 湿度，单位：0.01%
+ * @return esp_err_t 成功返回ESP_OK；设备不存在返回ESP_ERR_NOT_FOUND
+ */
+esp_err_t i2c_sim_aht10_set(i2c_port_t i2c_num, uint8_t dev_addr, int16_t temp_centi, uint16_t hum_centi);
+
+/**
+ * @brief 设置测量转换时间，基准测试可设为0以测量纯软件开销
+ *
+ * @param conversion_us 转换时间，单位：微秒
+ */
+void i2c_sim_set_conversion_us(uint32_t conversion_us);
+
+/**
+ * @brief 对指定设备注入故障，作用于接下来的count次事务
+ *
+ * @param i2c_num I2C端口号
+ * @param dev_addr 设备地址
+ * @param fault 故障类型
+ * @param count 影响的事务数
+ * @return esp_err_t 成功返回ESP_OK；设备不存在返回ESP_ERR_NOT_FOUND
+ */
+esp_err_t i2c_sim_inject(i2c_port_t i2c_num, uint8_t dev_addr, i2c_sim_fault_t fault, uint32_t count);
+
+/**
+ * @brief 在模拟总线上执行一次事务，语义与my_i2c_master_transfer相同
+ */
+esp_err_t i2c_sim_transfer(i2c_port_t i2c_num, uint8_t dev_addr,
+                           const uint8_t *write_data, size_t write_len,
+                           uint8_t *read_data, size_t read_len);
+
+/**
+ * @brief 获取模拟总线统计
+ *
+ * @param stats 输出统计
+ */
+void i2c_sim_get_stats(i2c_sim_stats_t *stats);
+
+#if CONFIG_PERF_BENCHMARKS
+/**
+ * @brief 在模拟总线上测量驱动栈的读取吞吐量、延迟分位数和堆操作次数，并验证故障路径
+ *
+ * @param i2c_num 已添加AHT10模型的端口
+ * @param dev_addr AHT10模型地址
+ * @return uint32_t 未通过的故障路径检查数，0表示全部通过
+ */
+uint32_t i2c_sim_benchmark(i2c_port_t i2c_num, uint8_t dev_addr);
+#endif
+
+#endif
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef __JSON_OBJ_PARSER_H__
+#define __JSON_OBJ_PARSER_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+// 单个对象的最大字段数
+#define JSON_OBJ_PARSER_MAX_FIELDS 32
+// 键名最大长度，更长的键视为未知键
+#define JSON_OBJ_PARSER_KEY_MAX 16
+
+/**
+ * 整数字段描述
+ *
+ * 解析结果写入target结构体中offset处的int32_t成员。
+ * 值可以是JSON整数，也可以是内容为整数的字符串（兼容表单输入）。
+ */
+typedef struct {
+    const char *name;   // 键名
+    int32_t min;        // 允许的最小值
+    int32_t max;        // 允许的最大值
+    bool required;      // 是否必须出现
+    size_t offset;      // 在目标结构体中的偏移（offsetof）
+} json_int_field_t;
+
+/**
+ * 扁平JSON对象的增量解析器
+ *
+ * 按字节驱动的状态机，可在数据分段到达时逐段输入，不分配内存、不构建树。
+ * 未知键的值（包括嵌套对象和数组）按JSON的记号规则校验后跳过：字符串的转义、
+ * 数字的格式、true/false/null字面量及括号配对均须合法，嵌套深度不超过32层。
+ * 成员不应直接修改。
+ */
+typedef struct {
+    const json_int_field_t *fields; // 字段表
+    size_t field_count;             // 字段数
+    void *target;                   // 目标结构体
+    uint8_t state;                  // 当前状态
+    uint8_t resume;                 // 跳过字符串、数字或字面量后返回的状态
+    uint8_t lit_pos;                // 字面量已匹配的字符数，或\u转义后已读的十六进制位数
+    bool quoted;                    // 当前数值是否带引号
+    bool negative;                  // 当前数值是否为负
+    bool has_digits;                // 当前数值是否已有数字
+    int field;                      // 当前键对应的字段序号，-1为未知键
+    uint32_t depth;                 // 跳过嵌套值时的深度
+    uint32_t nest;                  // 跳过嵌套值时各层的括号类型，最低位为最内层，1为对象
+    const char *literal;            // 正在跳过的字面量
+    int64_t value;                  // 当前数值
+    uint32_t seen;                  // 已出现字段的位图
+    size_t key_len;                 // 当前键长度
+    char key[JSON_OBJ_PARSER_KEY_MAX + 1]; // 当前键
+    esp_err_t err;                  // 首个错误
+} json_obj_parser_t;
+
+/**
+ * @brief 初始化解析器
+ *
+ * @param p 解析器
+ * @param fields 字段表
+ * @param field_count 字段数，不超过JSON_OBJ_PARSER_MAX_FIELDS
+ * @param target 目标结构体
+ */
+void json_obj_parser_init(json_obj_parser_t *p, const json_int_field_t *fields,
+                          size_t field_count, void *target);
+
+/**
+ * @brief 输入一段数据
+ *
+ * @param p 解析器
+ * @param data 数据
+ * @param len 数据长度
+ * @return esp_err_t 成功返回ESP_OK；语法错误返回ESP_ERR_INVALID_ARG；
+ *         数值越界或嵌套过深返回ESP_ERR_INVALID_SIZE
+ */
+esp_err_t json_obj_parser_feed(json_obj_parser_t *p, const char *data, size_t len);
+
+/**
+ * @brief 结束解析并检查完整性
+ *
+ * @param p 解析器
+ * @return esp_err_t 成功返回ESP_OK；对象不完整返回ESP_ERR_INVALID_STATE；
+ *         缺少必需字段返回ESP_ERR_NOT_FOUND；其余同json_obj_parser_feed
+ */
+esp_err_t json_obj_parser_finish(json_obj_parser_t *p);
+
+#endif
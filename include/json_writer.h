@@ -0,0 +1,88 @@
+#ifndef __JSON_WRITER_H__
+#define __JSON_WRITER_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+#include "chunk_buf.h"
+
+/**
+ * 流式JSON写入器
+ *
+ * 直接格式化到调用者提供的缓冲区，不进行任何堆分配。
+ * 绑定HTTP请求时，缓冲区写满即通过httpd_resp_send_chunk发送；
+ * 未绑定时，超出缓冲区容量将记录错误并停止写入。
+ * 已写入长度和首个错误见out.len、out.err。
+ */
+typedef struct {
+    chunk_buf_t out;    // 输出缓冲区
+    bool need_comma;    // 下一个元素前是否需要逗号
+} json_writer_t;
+
+/**
+ * @brief 初始化写入器
+ *
+ * @param w 写入器
+ * @param buf 输出缓冲区
+ * @param size 缓冲区容量
+ * @param req 绑定的HTTP请求，为NULL时只写入缓冲区
+ */
+void json_writer_init(json_writer_t *w, char *buf, size_t size, httpd_req_t *req);
+
+// 对象/数组的开始与结束
+void json_obj_begin(json_writer_t *w);
+void json_obj_end(json_writer_t *w);
+void json_arr_begin(json_writer_t *w);
+void json_arr_end(json_writer_t *w);
+
+/**
+ * @brief 写入对象键，其后必须紧跟一个值
+ *
+ * @param w 写入器
+ * @param key 键名，按原样输出，不做转义
+ */
+void json_key(json_writer_t *w, const char *key);
+
+// 写入单个值；json_str会对引号、反斜杠和控制字符转义
+void json_str(json_writer_t *w, const char *value);
+void json_int(json_writer_t *w, int64_t value);
+void json_uint(json_writer_t *w, uint64_t value);
+void json_bool(json_writer_t *w, bool value);
+void json_null(json_writer_t *w);
+
+/**
+ * @brief 写入定点格式的浮点数，不经过printf浮点格式化
+ *
+ * @param w 写入器
+ * @param value 数值，NaN/Inf输出为null
+ * @param decimals 小数位数（0-6）
+ */
+void json_float(json_writer_t *w, double value, int decimals);
+
+// 键值对便捷函数
+void json_kv_str(json_writer_t *w, const char *key, const char *value);
+void json_kv_int(json_writer_t *w, const char *key, int64_t value);
+void json_kv_uint(json_writer_t *w, const char *key, uint64_t value);
+void json_kv_bool(json_writer_t *w, const char *key, bool value);
+void json_kv_float(json_writer_t *w, const char *key, double value, int decimals);
+
+/**
+ * @brief 结束写入
+ *
+ * 绑定HTTP请求时发送剩余内容及结束块；否则只返回错误状态。
+ *
+ * @param w 写入器
+ * @return esp_err_t 成功返回ESP_OK；缓冲区不足返回ESP_ERR_NO_MEM；发送失败返回相应错误码
+ */
+esp_err_t json_writer_finish(json_writer_t *w);
+
+#if CONFIG_PERF_BENCHMARKS
+/**
+ * @brief 对比cJSON与流式写入器生成温度响应的耗时和堆操作次数
+ */
+void json_writer_benchmark(void);
+#endif
+
+#endif
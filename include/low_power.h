@@ -0,0 +1,62 @@
+#ifndef __LOW_POWER_H__
+#define __LOW_POWER_H__
+
+#include <stdint.h>
+#include "driver/i2c.h"
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#if CONFIG_LOW_POWER_MODE
+
+/**
+ * @brief 建立网络连接的回调，上传批量数据前调用
+ *
+ * @return esp_err_t 已获得IP返回ESP_OK，失败返回相应错误码
+ */
+typedef esp_err_t (*low_power_connect_t)(void);
+
+// 低功耗模式统计（保存在RTC内存中，跨深度睡眠累计）
+typedef struct {
+    uint32_t wakes;                 // 唤醒次数
+    uint32_t samples;               // 成功采样次数
+    uint32_t errors;                // 采样失败次数
+    uint32_t buffered;              // 缓冲区中待上传的采样数
+    uint32_t uploaded;              // 已上传的采样数
+    uint32_t dropped;               // 缓冲区满被覆盖的采样数
+    uint32_t flushes;               // 成功上传次数
+    uint32_t flush_failures;        // 上传失败次数
+    uint64_t active_us;             // 累计CPU运行时间（不含WiFi）
+    uint64_t light_sleep_us;        // 累计等待转换时的浅睡眠时间
+    uint64_t wifi_us;               // 累计WiFi连接与上传时间
+    uint64_t deep_sleep_us;         // 累计深度睡眠时间
+    uint32_t avg_current_ua;        // 按各状态电流估算的平均电流
+    uint32_t energy_per_sample_uj;  // 每个成功采样平均消耗的能量
+} low_power_stats_t;
+
+/**
+ * @brief 执行一次低功耗唤醒周期，不返回
+ *
+ * 读取AHT10并追加到RTC慢速内存中的缓冲区，不启动WiFi即进入深度睡眠。
+ * 缓冲区累计CONFIG_LOW_POWER_BATCH_SIZE个采样、温湿度变化超过阈值或缓冲区已满时，
+ * 调用connect连接网络，把整批数据POST到CONFIG_LOW_POWER_UPLOAD_URL后关闭WiFi。
+ * 上传失败时数据保留，下一批时重试；缓冲区满后覆盖最旧的采样。
+ *
+ * @param i2c_num 已初始化的I2C端口
+ * @param dev_addr AHT10地址
+ * @param connect 建立网络连接的回调
+ */
+void low_power_run(i2c_port_t i2c_num, uint8_t dev_addr, low_power_connect_t connect) __attribute__((noreturn));
+
+/**
+ * @brief 读取低功耗模式统计
+ *
+ * 平均电流和能量由各状态的累计时间乘以CONFIG_LOW_POWER_*_UA估算，
+ * 不含二级引导程序的运行时间。
+ *
+ * @param stats 输出统计
+ */
+void low_power_get_stats(low_power_stats_t *stats);
+
+#endif
+
+#endif
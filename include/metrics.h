@@ -0,0 +1,98 @@
+#ifndef __METRICS_H__
+#define __METRICS_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+#include "chunk_buf.h"
+
+// 直方图桶数，最后一个桶为+Inf；上限见metrics.c中的s_bucket_us
+#define METRICS_HIST_BUCKETS 12
+
+/**
+ * 延迟直方图
+ *
+ * 桶计数和累计耗时都是32位原子加法，不加锁。累计耗时以微秒计，约71分钟后回绕，
+ * Prometheus按计数器重置处理，rate()不受影响。可在任意任务中调用，全零即为空直方图。
+ * 读取时各字段不保证同一时刻一致，对Prometheus抓取没有影响。
+ */
+typedef struct {
+    atomic_uint sum_us;                         // 累计耗时，单位：微秒，回绕视为重置
+    atomic_uint buckets[METRICS_HIST_BUCKETS];  // 各桶计数（非累积）
+} metrics_hist_t;
+
+/**
+ * Prometheus文本格式写入器
+ *
+ * 与json_writer共用chunk_buf，缓冲区写满即通过httpd_resp_send_chunk发送，不进行堆分配。
+ */
+typedef struct {
+    chunk_buf_t out;    // 输出缓冲区，必须绑定HTTP请求
+} metrics_writer_t;
+
+/**
+ * @brief 记录一次耗时
+ *
+ * @param hist 直方图
+ * @param value_us 耗时，单位：微秒
+ */
+void metrics_hist_observe(metrics_hist_t *hist, uint32_t value_us);
+
+/**
+ * @brief 初始化写入器
+ *
+ * @param w 写入器
+ * @param buf 输出缓冲区
+ * @param size 缓冲区容量
+ * @param req 绑定的HTTP请求
+ */
+void metrics_writer_init(metrics_writer_t *w, char *buf, size_t size, httpd_req_t *req);
+
+/**
+ * @brief 写入指标的HELP和TYPE行，每个指标名只写一次
+ *
+ * @param w 写入器
+ * @param name 指标名
+ * @param type "counter"、"gauge"或"histogram"
+ * @param help 说明
+ */
+void metrics_header(metrics_writer_t *w, const char *name, const char *type, const char *help);
+
+/**
+ * @brief 写入一个样本
+ *
+ * @param w 写入器
+ * @param name 指标名
+ * @param labels 标签，如"uri=\"/x\""，按原样输出，可为NULL
+ * @param value 值
+ */
+void metrics_sample(metrics_writer_t *w, const char *name, const char *labels, uint64_t value);
+
+/**
+ * @brief 写入一个直方图的_bucket、_sum和_count样本，单位换算为秒
+ *
+ * @param w 写入器
+ * @param name 指标名（不含后缀）
+ * @param labels 标签，按原样输出，可为NULL
+ * @param hist 直方图
+ */
+void metrics_hist(metrics_writer_t *w, const char *name, const char *labels, const metrics_hist_t *hist);
+
+/**
+ * @brief 写入堆、PSRAM余量和各任务栈的剩余高水位
+ *
+ * @param w 写入器
+ */
+void metrics_write_runtime(metrics_writer_t *w);
+
+/**
+ * @brief 发送剩余内容并结束分块响应
+ *
+ * @param w 写入器
+ * @return esp_err_t 写入过程中的首个错误
+ */
+esp_err_t metrics_writer_finish(metrics_writer_t *w);
+
+#endif
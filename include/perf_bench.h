@@ -0,0 +1,37 @@
+#ifndef __PERF_BENCH_H__
+#define __PERF_BENCH_H__
+
+#include <stdint.h>
+#include "sdkconfig.h"
+
+#if CONFIG_PERF_BENCHMARKS
+
+// 一次基准测量
+typedef struct {
+    const char *name;       // 测量名称
+    int64_t start_us;       // 开始时间
+    uint32_t start_allocs;  // 开始时的累计分配次数
+    uint32_t start_frees;   // 开始时的累计释放次数
+} perf_bench_t;
+
+/**
+ * @brief 开始一次测量
+ *
+ * @param bench 测量上下文
+ * @param name 测量名称，用于日志输出
+ */
+void perf_bench_begin(perf_bench_t *bench, const char *name);
+
+/**
+ * @brief 结束测量并输出每次迭代的平均耗时和堆操作次数
+ *
+ * 堆操作计数依赖CONFIG_HEAP_USE_HOOKS，未开启时只输出耗时。
+ *
+ * @param bench 测量上下文
+ * @param iterations 迭代次数
+ */
+void perf_bench_end(perf_bench_t *bench, uint32_t iterations);
+
+#endif
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef __SAMPLE_LOG_H__
+#define __SAMPLE_LOG_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "aht10.h"
+
+/**
+ * 温湿度采样的持久化日志
+ *
+ * 只追加写入独立数据分区，分区划分为若干段（CONFIG_SAMPLE_LOG_SEGMENT_SIZE），
+ * 按段循环使用，写满后擦除最旧的段，各扇区擦除次数均匀。擦除在最新段将满时
+ * 分摊到之后的各次追加中，每次最多一个扇区。
+ * 记录先在RAM中攒满一页（256字节，41条）再一次写入，每条6字节，
+ * 时间以相对页起始时间的差值编码。段头和页头构成稀疏时间索引，
+ * 按时间定位只需两次二分查找；启动时只读取各段段头和最新段的末尾。
+ */
+
+// 一条日志记录
+typedef struct {
+    uint32_t timestamp;     // 日志时间，单位：秒，跨重启单调递增
+    int16_t temp_centi;     // 温度，单位：0.01℃
+    uint16_t hum_centi;     // 湿度，单位：0.01%
+} sample_log_point_t;
+
+// 查询迭代器，成员不应直接修改
+typedef struct {
+    uint32_t from;          // 起始时间（含）
+    uint32_t to;            // 结束时间（含）
+    uint32_t seg_seq;       // 当前段序号
+    uint16_t page;          // 当前页
+    uint8_t rec;            // 页内下一条记录
+    bool started;           // 是否已定位起点
+    bool done;              // 是否已结束
+} sample_log_iter_t;
+
+// 日志统计
+typedef struct {
+    uint32_t segments;      // 分区中的段数
+    uint32_t used_segments; // 含有数据的段数
+    uint32_t capacity;      // 可保存的记录数
+    uint32_t pending;       // RAM中尚未写入flash的记录数
+    uint32_t pages_written; // 本次启动写入的页数
+    uint32_t erases;        // 本次启动擦除的段数
+    uint32_t crc_errors;    // 读取时校验失败而跳过的页数
+    uint32_t oldest_ts;     // 最早记录的时间，无记录时为0
+    uint32_t newest_ts;     // 最新记录的时间，无记录时为0
+    uint32_t recover_us;    // 启动时恢复写入位置的耗时
+} sample_log_stats_t;
+
+/**
+ * @brief 打开日志分区并恢复写入位置
+ *
+ * 读取各段段头找到最新的段，再在该段内二分查找第一个空页，不扫描整个分区。
+ * 注册关机回调，esp_restart()前写入RAM中的记录。
+ *
+ * @return esp_err_t 成功返回ESP_OK；找不到分区返回ESP_ERR_NOT_FOUND
+ */
+esp_err_t sample_log_init(void);
+
+/**
+ * @brief 获取日志时间
+ *
+ * 系统时间已同步（晚于2020年）时使用UNIX时间，否则从上次记录的时间接续计时，
+ * 保证跨重启单调递增。
+ *
+ * @return uint32_t 日志时间，单位：秒
+ */
+uint32_t sample_log_now(void);
+
+/**
+ * @brief 追加一条采样，攒满一页后写入flash
+ *
+ * @param value 定点温湿度
+ * @return esp_err_t 成功返回ESP_OK；未初始化返回ESP_ERR_INVALID_STATE；flash错误返回相应错误码
+ */
+esp_err_t sample_log_append(const aht10_fixed_t *value);
+
+/**
+ * @brief 立即写入RAM中不足一页的记录
+ *
+ * 该页剩余空间不再使用，频繁调用会降低存储效率，一般只在关机或睡眠前调用。
+ *
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t sample_log_flush(void);
+
+/**
+ * @brief 初始化查询迭代器
+ *
+ * @param iter 迭代器
+ * @param from 起始时间（含）
+ * @param to 结束时间（含）
+ */
+void sample_log_iter_init(sample_log_iter_t *iter, uint32_t from, uint32_t to);
+
+/**
+ * @brief 按时间顺序取出下一批记录，包含RAM中尚未写入的记录
+ *
+ * 每次调用只在读取期间持有锁。查询过程中被擦除的段会被跳过。
+ *
+ * @param iter 迭代器
+ * @param out 输出缓冲区
+ * @param max_points 输出缓冲区容量
+ * @return size_t 实际取出的记录数，0表示结束
+ */
+size_t sample_log_iter_next(sample_log_iter_t *iter, sample_log_point_t *out, size_t max_points);
+
+/**
+ * @brief 读取日志统计
+ *
+ * @param stats 输出统计
+ */
+void sample_log_get_stats(sample_log_stats_t *stats);
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef __SAMPLE_STORE_H__
+#define __SAMPLE_STORE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "aht10.h"
+
+// 汇总桶长度（单位：秒）
+#define SAMPLE_STORE_MINUTE_PERIOD 60
+#define SAMPLE_STORE_HOUR_PERIOD 3600
+
+// 数据分辨率
+typedef enum {
+    SAMPLE_RES_RAW = 0,  // 原始采样
+    SAMPLE_RES_MINUTE,   // 1分钟汇总
+    SAMPLE_RES_HOUR,     // 1小时汇总
+    SAMPLE_RES_MAX,
+} sample_res_t;
+
+// 查询结果数据点，原始采样时min/max/mean相同且count为1；温度单位0.01℃，湿度单位0.01%
+typedef struct {
+    uint32_t timestamp; // 采样时间或汇总桶起始时间，单位：秒（自启动起）
+    uint32_t count;     // 桶内采样数
+    int16_t temp_min;   // 温度最小值
+    int16_t temp_max;   // 温度最大值
+    int16_t temp_mean;  // 温度平均值（四舍五入）
+    uint16_t hum_min;   // 湿度最小值
+    uint16_t hum_max;   // 湿度最大值
+    uint16_t hum_mean;  // 湿度平均值（四舍五入）
+} sample_point_t;
+
+// 带序号的原始采样，用于增量同步
+typedef struct {
+    uint32_t seq;           // 采样序号，与sensor_snapshot中的序号一致
+    uint32_t timestamp;     // 采样时间，单位：秒（自启动起）
+    aht10_fixed_t value;    // 定点温湿度
+} sample_seq_point_t;
+
+// 原始采样的序号范围
+typedef struct {
+    uint32_t boot_id;       // 本次启动的随机标识，重启后序号从1重新开始
+    uint32_t oldest;        // 仍保存的最早采样序号，无采样时为0
+    uint32_t newest;        // 最新采样序号，无采样时为0
+} sample_seq_range_t;
+
+// 查询迭代器，成员不应直接修改
+typedef struct {
+    sample_res_t res;  // 查询分辨率
+    uint32_t from;     // 起始时间（含）
+    uint32_t to;       // 结束时间（含）
+    uint32_t next;     // 下一条记录的绝对序号（原始分辨率下为块序号）
+    uint16_t sub;      // 原始分辨率下当前块内已读取的采样数
+    bool started;      // 是否已定位起点
+    bool done;         // 是否已结束（含未完成的当前桶）
+} sample_store_iter_t;
+
+/**
+ * @brief 初始化采样存储，在PSRAM中分配固定大小的环形缓冲区
+ *
+ * @return esp_err_t 成功返回ESP_OK；PSRAM不可用时返回ESP_ERR_NO_MEM
+ */
+esp_err_t sample_store_init(void);
+
+/**
+ * @brief 获取存储使用的当前时间
+ *
+ * @return uint32_t 自启动起的秒数
+ */
+uint32_t sample_store_now(void);
+
+/**
+ * @brief 追加一个采样，并以O(1)更新分钟和小时汇总
+ *
+ * @param timestamp 采样时间，单位：秒，应单调不减
+ * @param seq 采样序号，从1开始严格递增，一般为sensor_snapshot_publish()的返回值
+ * @param value 定点温湿度
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t sample_store_add(uint32_t timestamp, uint32_t seq, const aht10_fixed_t *value);
+
+/**
+ * @brief 初始化查询迭代器
+ *
+ * @param iter 迭代器
+ * @param res 查询分辨率
+ * @param from 起始时间（含）
+ * @param to 结束时间（含）
+ */
+void sample_store_iter_init(sample_store_iter_t *iter, sample_res_t res, uint32_t from, uint32_t to);
+
+/**
+ * @brief 按时间顺序取出下一批数据点
+ *
+ * 每次调用只在复制期间持有锁，便于调用者在两次调用之间发送数据。
+ * 汇总分辨率下，最后会附带尚未结束的当前桶。
+ *
+ * @param iter 迭代器
+ * @param out 输出缓冲区
+ * @param max_points 输出缓冲区容量
+ * @return size_t 实际取出的数据点数，0表示结束
+ */
+size_t sample_store_iter_next(sample_store_iter_t *iter, sample_point_t *out, size_t max_points);
+
+/**
+ * @brief 读取原始采样的序号范围
+ *
+ * @param range 输出序号范围
+ */
+void sample_store_seq_range(sample_seq_range_t *range);
+
+/**
+ * @brief 按序号顺序取出序号大于after_seq的原始采样
+ *
+ * 每次调用按块首序号二分定位，调用者以上次取得的最后一个序号继续即可分批读取。
+ *
+ * @param after_seq 已取得的最新序号，0表示从最早的采样开始
+ * @param out 输出缓冲区
+ * @param max_points 输出缓冲区容量
+ * @return size_t 实际取出的采样数，0表示没有更新的采样
+ */
+size_t sample_store_since(uint32_t after_seq, sample_seq_point_t *out, size_t max_points);
+
+/**
+ * @brief 分辨率名称（"raw"、"1m"、"1h"）
+ *
+ * @param res 分辨率
+ * @return const char* 名称字符串
+ */
+const char *sample_store_res_name(sample_res_t res);
+
+/**
+ * @brief 按名称解析分辨率
+ *
+ * @param name 名称字符串
+ * @param res 输出分辨率
+ * @return esp_err_t 成功返回ESP_OK，未知名称返回ESP_ERR_INVALID_ARG
+ */
+esp_err_t sample_store_res_from_name(const char *name, sample_res_t *res);
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef __SAMPLER_H__
+#define __SAMPLER_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "driver/i2c.h"
+#include "esp_err.h"
+#include "aht10.h"
+
+/**
+ * 传感器驱动操作
+ *
+ * 测量分为触发和读取两个阶段，调度器在两者之间不阻塞，
+ * 因此多个传感器的转换时间可以相互重叠。
+ */
+typedef struct {
+    const char *name;           // 驱动名称
+    uint32_t conversion_ms;     // 触发后到首次读取的等待时间
+    uint32_t poll_ms;           // 未就绪时的重试间隔
+    uint32_t timeout_ms;        // 触发后超过该时间仍未就绪则判定超时
+    esp_err_t (*init)(i2c_port_t i2c_num, uint8_t dev_addr);
+    esp_err_t (*trigger)(i2c_port_t i2c_num, uint8_t dev_addr);
+    // 输出定点温湿度，未就绪时返回ESP_ERR_NOT_FINISHED
+    esp_err_t (*collect)(i2c_port_t i2c_num, uint8_t dev_addr, aht10_fixed_t *value);
+} sampler_driver_t;
+
+// AHT10驱动
+extern const sampler_driver_t sampler_driver_aht10;
+
+// 传感器实例配置
+typedef struct {
+    const sampler_driver_t *driver; // 驱动
+    i2c_port_t i2c_num;             // I2C端口号
+    uint8_t dev_addr;               // 设备地址
+    uint32_t period_ms;             // 采样周期
+} sampler_sensor_t;
+
+// 传感器实例统计
+typedef struct {
+    uint32_t samples;       // 成功采样次数
+    uint32_t errors;        // 失败次数（含超时）
+    uint32_t overruns;      // 因上次测量未完成而推迟的周期数
+    uint32_t last_latency_us; // 最近一次从触发到取得结果的时长
+} sampler_stats_t;
+
+/**
+ * @brief 采样结果回调，在调度任务中调用，不应长时间阻塞
+ *
+ * @param index 传感器序号（sampler_add的返回顺序）
+ * @param sensor 传感器配置
+ * @param result 采样结果，ESP_OK时value有效
+ * @param value 定点温湿度，仅在回调期间有效
+ * @param arg 用户参数
+ */
+typedef void (*sampler_cb_t)(size_t index, const sampler_sensor_t *sensor, esp_err_t result,
+                             const aht10_fixed_t *value, void *arg);
+
+/**
+ * @brief 添加一个传感器实例，并调用驱动的init
+ *
+ * 须在sampler_start之前调用。
+ *
+ * @param sensor 传感器配置
+ * @param index 输出传感器序号，可为NULL
+ * @return esp_err_t 成功返回ESP_OK；已满返回ESP_ERR_NO_MEM；已启动返回ESP_ERR_INVALID_STATE；
+ *         其余为驱动init的错误码
+ */
+esp_err_t sampler_add(const sampler_sensor_t *sensor, size_t *index);
+
+/**
+ * @brief 启动调度任务
+ *
+ * 任务运行在CONFIG_SAMPLER_TASK_CORE指定的核心上。
+ *
+ * @param cb 采样结果回调
+ * @param arg 回调参数
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t sampler_start(sampler_cb_t cb, void *arg);
+
+/**
+ * @brief 已添加的传感器数量
+ *
+ * @return size_t 传感器数量
+ */
+size_t sampler_count(void);
+
+/**
+ * @brief 获取传感器实例统计
+ *
+ * @param index 传感器序号
+ * @param stats 输出统计
+ * @return esp_err_t 成功返回ESP_OK；序号无效返回ESP_ERR_INVALID_ARG
+ */
+esp_err_t sampler_get_stats(size_t index, sampler_stats_t *stats);
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef __SENSOR_SNAPSHOT_H__
+#define __SENSOR_SNAPSHOT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "aht10.h"
+
+// 最新一次采样
+typedef struct {
+    aht10_fixed_t value;   // 定点温湿度
+    int64_t timestamp_us;  // 发布时间，esp_timer_get_time()
+    uint32_t seq;          // 采样序号，每次成功读取加一，从1开始，0表示尚无有效采样；与时序存储中的序号一致
+    bool valid;            // 最近一次读取是否成功，失败时value保留上次的有效值
+} sensor_reading_t;
+
+/**
+ * @brief 发布通知回调
+ *
+ * 在采样任务上下文中、快照更新完成后调用，回调内不应阻塞。
+ *
+ * @param arg 注册时传入的参数
+ */
+typedef void (*sensor_snapshot_listener_t)(void *arg);
+
+/**
+ * 基于seqlock的最新采样快照
+ *
+ * 仅允许一个写者（采样任务）；读者不加锁、不阻塞写者，
+ * 与写入重叠时重新拷贝，直到读到一致的快照。写入只有几次存储且每个采样周期一次，
+ * 重试极少发生，因此读取耗时与读者数量和轮询频率无关。
+ */
+typedef struct {
+    atomic_uint lock;          // seqlock计数，奇数表示写入进行中
+    sensor_reading_t reading;  // 快照内容
+    sensor_snapshot_listener_t listener; // 发布通知回调
+    void *listener_arg;        // 回调参数
+} sensor_snapshot_t;
+
+// AHT10最新采样快照，由采样任务发布，HTTP处理程序读取
+extern sensor_snapshot_t g_sensor_snapshot;
+
+/**
+ * @brief 发布一次采样
+ *
+ * 读取成功时序号加一，失败时保留上一个有效采样的序号。
+ *
+ * @param snap 快照
+ * @param value 定点温湿度，为NULL时保留上次数据
+ * @param valid 本次读取是否成功
+ * @return uint32_t 发布后的采样序号
+ */
+uint32_t sensor_snapshot_publish(sensor_snapshot_t *snap, const aht10_fixed_t *value, bool valid);
+
+/**
+ * @brief 读取最新快照
+ *
+ * @param snap 快照
+ * @param out 输出一致的快照副本
+ * @return bool 已发布过有效采样返回true
+ */
+bool sensor_snapshot_read(sensor_snapshot_t *snap, sensor_reading_t *out);
+
+/**
+ * @brief 设置发布通知回调，每次发布后调用；传入NULL取消
+ *
+ * @param snap 快照
+ * @param listener 回调函数
+ * @param arg 回调参数
+ */
+void sensor_snapshot_set_listener(sensor_snapshot_t *snap, sensor_snapshot_listener_t listener, void *arg);
+
+#endif
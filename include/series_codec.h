@@ -0,0 +1,94 @@
+#ifndef __SERIES_CODEC_H__
+#define __SERIES_CODEC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "aht10.h"
+#include "sdkconfig.h"
+
+/**
+ * 温湿度时序的差分压缩编码
+ *
+ * 时间戳按二阶差分（delta-of-delta）、温湿度按与上一点的差值编码，
+ * 差值经zig-zag映射后以varint输出。第一个点直接输出时间戳和定点值。
+ * 采样周期固定、温湿度缓慢变化时每点通常为3字节（原始记录12字节）。
+ *
+ * 编码流没有长度前缀，也不含点数，由外层记录；解码从流的起点开始。
+ */
+
+// 单个点编码后的最大字节数（时间戳5字节 + 温湿度各3字节）
+#define SERIES_POINT_MAX_BYTES 11
+
+// 一个定点采样
+typedef struct {
+    uint32_t timestamp;     // 时间，单位：秒
+    aht10_fixed_t value;    // 定点温湿度
+} series_point_t;
+
+// 编码器
+typedef struct {
+    uint8_t *buf;           // 输出缓冲区
+    size_t size;            // 缓冲区容量
+    size_t len;             // 已写入字节数，调用者发送后可清零继续编码同一个流
+    uint32_t count;         // 已编码的点数
+    uint32_t prev_ts;       // 上一点的时间
+    int64_t prev_delta;     // 上一点的时间差
+    aht10_fixed_t prev;     // 上一点的温湿度
+} series_encoder_t;
+
+// 解码器
+typedef struct {
+    const uint8_t *buf;     // 编码流
+    size_t len;             // 编码流长度
+    size_t pos;             // 下一个读取位置
+    uint32_t count;         // 已解码的点数
+    uint32_t prev_ts;
+    int64_t prev_delta;
+    aht10_fixed_t prev;
+} series_decoder_t;
+
+/**
+ * @brief 初始化编码器，开始一个新的流
+ *
+ * @param enc 编码器
+ * @param buf 输出缓冲区
+ * @param size 缓冲区容量
+ */
+void series_encoder_init(series_encoder_t *enc, uint8_t *buf, size_t size);
+
+/**
+ * @brief 编码一个点
+ *
+ * @param enc 编码器
+ * @param point 采样
+ * @return bool 缓冲区剩余空间不足时返回false，编码器状态不变
+ */
+bool series_encode(series_encoder_t *enc, const series_point_t *point);
+
+/**
+ * @brief 初始化解码器
+ *
+ * @param dec 解码器
+ * @param buf 编码流
+ * @param len 编码流长度
+ */
+void series_decoder_init(series_decoder_t *dec, const uint8_t *buf, size_t len);
+
+/**
+ * @brief 解码下一个点
+ *
+ * @param dec 解码器
+ * @param point 输出采样
+ * @return bool 流结束或数据截断时返回false；此时pos小于len说明数据无效
+ */
+bool series_decode(series_decoder_t *dec, series_point_t *point);
+
+#if CONFIG_PERF_BENCHMARKS
+/**
+ * @brief 在模拟的温湿度序列上测量压缩率和编解码耗时，并校验往返结果
+ */
+void series_codec_benchmark(void);
+#endif
+
+#endif
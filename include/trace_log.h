@@ -0,0 +1,135 @@
+#ifndef __TRACE_LOG_H__
+#define __TRACE_LOG_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+
+/**
+ * 二进制跟踪日志
+ *
+ * 热路径只记录事件ID、时间戳和最多4个32位参数，写入当前核心的环形缓冲区，
+ * 不格式化、不加锁、不访问UART；格式化推迟到/api/v1/system/log下载时
+ * 在设备上进行，或由tools/tracelog.py在主机上解码二进制转储。
+ *
+ * 格式串只能使用按32位整数传参的转换（%d、%u、%x、%X、%c及宽度修饰），
+ * 浮点数需换算为定点整数记录。
+ */
+
+// 事件ID与格式串，新增事件追加在末尾，已发布的ID不要改变顺序
+#define TRACE_LOG_EVENTS(X) \
+    X(TRACE_I2C_WRITE_FAIL,      "I2C写入失败，端口 %u，地址 0x%02X，错误代码: %d") \
+    X(TRACE_I2C_READ_FAIL,       "I2C读取失败，端口 %u，地址 0x%02X，错误代码: %d") \
+    X(TRACE_I2C_WRITE_READ_FAIL, "I2C写读失败，端口 %u，地址 0x%02X，错误代码: %d") \
+    X(TRACE_AHT10_TRIGGER_FAIL,  "AHT10发送测量命令失败，端口 %u，地址 0x%02X，错误代码: %d") \
+    X(TRACE_AHT10_READ_FAIL,     "AHT10读取数据失败，端口 %u，地址 0x%02X，错误代码: %d") \
+    X(TRACE_AHT10_TIMEOUT,       "AHT10转换超时，端口 %u") \
+    X(TRACE_AHT10_DATA,          "AHT10数据读取成功，端口 %u，温度 %d，湿度 %u（单位0.01）") \
+    X(TRACE_SAMPLE,              "[%u] 温度 %d，湿度 %u（单位0.01）") \
+    X(TRACE_SAMPLE_FAIL,         "读取传感器 %u（端口 %d，地址 0x%02X）失败，错误代码: %d")
+
+#define TRACE_LOG_ENUM_(id, fmt) id,
+typedef enum {
+    TRACE_LOG_EVENTS(TRACE_LOG_ENUM_)
+    TRACE_LOG_EVENT_MAX
+} trace_log_id_t;
+#undef TRACE_LOG_ENUM_
+
+// 每条记录的参数个数
+#define TRACE_LOG_MAX_ARGS 4
+
+// 一条跟踪记录（32字节），二进制转储按此布局输出
+typedef struct {
+    int64_t timestamp_us;               // esp_timer_get_time()
+    uint16_t id;                        // trace_log_id_t
+    uint8_t core;                       // 写入时所在的核心
+    uint8_t reserved;
+    uint32_t args[TRACE_LOG_MAX_ARGS];  // 参数，未使用的为0
+    uint32_t pad;
+} trace_log_entry_t;
+
+// 按时间顺序合并各核心记录的读取游标
+typedef struct {
+    uint32_t next[portNUM_PROCESSORS];          // 各核心下一个读取的序号
+    uint32_t end[portNUM_PROCESSORS];           // 创建游标时各核心的写入序号
+    trace_log_entry_t pending[portNUM_PROCESSORS]; // 各核心已取出、尚未返回的记录
+    bool has_pending[portNUM_PROCESSORS];
+    uint32_t lost;                              // 读取期间被覆盖的记录数
+} trace_log_iter_t;
+
+/**
+ * @brief 记录一个事件，参数不足4个时补0
+ *
+ * 用法：TRACE_LOG(TRACE_I2C_READ_FAIL, port, addr, ret)
+ */
+#define TRACE_LOG(...) trace_log_write(TRACE_LOG_ARGS_(__VA_ARGS__, 0, 0, 0, 0, 0))
+#define TRACE_LOG_ARGS_(id, a, b, c, d, ...) \
+    (id), (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), (uint32_t)(d)
+
+/**
+ * @brief 为每个核心分配环形缓冲区（CONFIG_TRACE_LOG_PSRAM时位于PSRAM）
+ *
+ * 初始化前的记录被丢弃并计数。重复调用直接返回ESP_OK。
+ *
+ * @return esp_err_t 成功返回ESP_OK；内存不足返回ESP_ERR_NO_MEM
+ */
+esp_err_t trace_log_init(void);
+
+/**
+ * @brief 记录一个事件，一般通过TRACE_LOG宏调用
+ *
+ * 可在任务和中断中调用；函数和缓冲区不在IRAM中，不能用于flash缓存关闭期间运行的中断。
+ *
+ * @param id 事件ID
+ * @param a0 参数0
+ * @param a1 参数1
+ * @param a2 参数2
+ * @param a3 参数3
+ */
+void trace_log_write(trace_log_id_t id, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3);
+
+/**
+ * @brief 创建读取游标，从各核心缓冲区中仍保留的最早记录开始
+ *
+ * @param iter 游标
+ */
+void trace_log_iter_init(trace_log_iter_t *iter);
+
+/**
+ * @brief 按时间顺序取出下一条记录，只返回创建游标之前写入的记录
+ *
+ * @param iter 游标
+ * @param entry 输出记录
+ * @return bool 没有更多记录时返回false
+ */
+bool trace_log_iter_next(trace_log_iter_t *iter, trace_log_entry_t *entry);
+
+/**
+ * @brief 事件的格式串
+ *
+ * @param id 事件ID
+ * @return const char* 格式串，ID无效时返回NULL
+ */
+const char *trace_log_event_format(uint16_t id);
+
+/**
+ * @brief 将记录格式化为一行文本："[秒.微秒] C核心 消息\n"
+ *
+ * @param entry 记录
+ * @param buf 输出缓冲区
+ * @param size 缓冲区容量
+ * @return int 输出长度（不含结束符），与snprintf相同，可能超过size
+ */
+int trace_log_format(const trace_log_entry_t *entry, char *buf, size_t size);
+
+/**
+ * @brief 初始化前被丢弃的记录数
+ *
+ * @return uint32_t 记录数
+ */
+uint32_t trace_log_dropped(void);
+
+#endif
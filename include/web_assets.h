@@ -0,0 +1,77 @@
+#ifndef __WEB_ASSETS_H__
+#define __WEB_ASSETS_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+// 静态资源镜像格式，须与tools/mkwebassets.py保持一致
+#define WEB_ASSETS_MAGIC "WAST"
+#define WEB_ASSETS_VERSION 1
+#define WEB_ASSETS_ETAG_LEN 20
+
+// 镜像头
+typedef struct {
+    char magic[4];         // "WAST"
+    uint16_t version;      // 格式版本
+    uint16_t entry_count;  // 资源条目数
+    uint32_t hash_seed;    // 完美哈希种子（FNV-1a 32位初值）
+    uint16_t slot_count;   // 哈希槽数，2的幂
+    uint16_t reserved;
+    uint32_t image_size;   // 镜像总大小
+} web_asset_image_header_t;
+
+// 镜像内的一段文件内容
+typedef struct {
+    uint32_t offset;                  // 相对镜像起始的偏移
+    uint32_t length;                  // 长度，0表示不存在
+    char etag[WEB_ASSETS_ETAG_LEN];   // 强ETag，NUL结尾
+} web_asset_blob_t;
+
+// 镜像内的资源条目
+typedef struct {
+    uint32_t uri_offset;    // URI字符串偏移
+    uint32_t mime_offset;   // MIME类型字符串偏移
+    web_asset_blob_t plain; // 原始内容
+    web_asset_blob_t gzip;  // gzip内容，可能不存在
+} web_asset_entry_t;
+
+// 查找结果，指针直接指向映射的flash
+typedef struct {
+    const char *uri;
+    const char *mime;
+    const uint8_t *data;      // 原始内容
+    size_t length;
+    const char *etag;
+    const uint8_t *gz_data;   // gzip内容，不存在时为NULL
+    size_t gz_length;
+    const char *gz_etag;
+} web_asset_t;
+
+/**
+ * @brief 内存映射静态资源分区并校验镜像
+ *
+ * @param partition_label 分区标签
+ * @return esp_err_t 成功返回ESP_OK；分区不存在返回ESP_ERR_NOT_FOUND；镜像无效返回ESP_ERR_INVALID_VERSION
+ */
+esp_err_t web_assets_init(const char *partition_label);
+
+/**
+ * @brief 资源镜像是否已映射
+ *
+ * @return bool 已映射返回true
+ */
+bool web_assets_ready(void);
+
+/**
+ * @brief 按URI查找资源，O(1)
+ *
+ * @param uri 请求URI，不含查询字符串
+ * @param uri_len URI长度
+ * @param out 查找结果
+ * @return esp_err_t 成功返回ESP_OK，不存在返回ESP_ERR_NOT_FOUND
+ */
+esp_err_t web_assets_find(const char *uri, size_t uri_len, web_asset_t *out);
+
+#endif
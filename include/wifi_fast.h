@@ -0,0 +1,49 @@
+#ifndef __WIFI_FAST_H__
+#define __WIFI_FAST_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_netif.h"
+
+// 快速连接统计
+typedef struct {
+    bool used_cache;        // 是否使用了缓存的BSSID和信道
+    bool used_static_ip;    // 是否使用了缓存的IP作为静态IP
+    uint32_t attempts;      // 本次连接的关联尝试次数
+    int64_t connect_us;     // 从发起连接到获得IP的耗时，未连接为-1
+    int64_t boot_to_ip_us;  // 从上电到获得IP的耗时，未连接为-1
+} wifi_fast_stats_t;
+
+/**
+ * @brief 初始化快速连接模块
+ *
+ * 注册WiFi和IP事件处理器，须在event_handler_init()和默认事件循环创建之后调用。
+ *
+ * @param sta_netif STA网络接口，用于设置静态IP
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t wifi_fast_init(esp_netif_t *sta_netif);
+
+/**
+ * @brief 用NVS中保存的凭据直接连接AP，阻塞到获得IP或超时
+ *
+ * 有上次连接的缓存时，锁定其BSSID和信道以跳过全信道扫描，并可选用上次的DHCP租约
+ * 作为静态IP（CONFIG_WIFI_FAST_STATIC_IP）。缓存的AP连接失败时改为普通扫描和DHCP重试。
+ * 每次获得IP后更新缓存（内容变化时才写NVS）。
+ * 超时后停止重试并断开，调用者可转入ESPTouch配网。
+ *
+ * @param timeout_ms 超时时间（毫秒）
+ * @return esp_err_t 获得IP返回ESP_OK；没有保存的凭据返回ESP_ERR_NOT_FOUND；
+ *                   连接失败返回ESP_ERR_TIMEOUT
+ */
+esp_err_t wifi_fast_connect(uint32_t timeout_ms);
+
+/**
+ * @brief 读取最近一次快速连接的统计
+ *
+ * @param stats 输出统计
+ */
+void wifi_fast_get_stats(wifi_fast_stats_t *stats);
+
+#endif
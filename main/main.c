@@ -17,49 +17,138 @@
 #include "esp_event.h"
 #include "esp_log.h"
 #include "esp_system.h"
+#include "esp_sleep.h"
 #include "nvs_flash.h"
 #include "esp_netif.h"
 #include "esp_mac.h"
 #include "smartconfig.h"
 #include "event_handler.h" // 包含新的头文件
+#include "wifi_fast.h"
+#include "low_power.h"
+#include "i2c_driver.h"
+#include "aht10.h"
 #include "web_server_handler.h"
+#include "boot_prof.h"
+#include "trace_log.h"
 
 static const char *TAG = "main";
 
+#if CONFIG_LOW_POWER_MODE
+// 低功耗模式下的AHT10接线
+#define LOW_POWER_I2C_NUM I2C_NUM_0
+#define LOW_POWER_I2C_SDA_IO 3
+#define LOW_POWER_I2C_SCL_IO 2
+#endif
+
 // 初始化WiFi
-static void initialise_wifi(void)
+static esp_netif_t *initialise_wifi(void)
 {
     ESP_ERROR_CHECK(esp_netif_init()); // 初始化网络接口
     ESP_ERROR_CHECK(esp_event_loop_create_default()); // 创建默认事件循环
     esp_netif_t *sta_netif = esp_netif_create_default_wifi_sta(); // 创建默认的WiFi STA接口
     assert(sta_netif);
 
-/* Register event handlers */
-    ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &event_handler_handle, NULL));
-    ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &event_handler_handle, NULL));
-    ESP_ERROR_CHECK(esp_event_handler_register(SC_EVENT, ESP_EVENT_ANY_ID, &event_handler_handle, NULL));
+/* 事件处理器通过event_handler_register()登记，分发表按需挂接到默认事件循环 */
 
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT(); // 获取默认的WiFi初始化配置
     ESP_ERROR_CHECK( esp_wifi_init(&cfg) ); // 初始化WiFi
 
     ESP_ERROR_CHECK( esp_wifi_set_mode(WIFI_MODE_STA) ); // 设置WiFi模式为STA
     ESP_ERROR_CHECK( esp_wifi_start() ); // 启动WiFi
+    return sta_netif;
+}
+
+#if CONFIG_LOW_POWER_MODE
+// 冷启动时已初始化的STA接口，定时唤醒时为NULL
+static esp_netif_t *s_sta_netif = NULL;
+
+// 低功耗模式上传前连网，只在攒够一批时调用
+static esp_err_t low_power_connect(void)
+{
+    if (s_sta_netif != NULL) {
+        esp_err_t ret = esp_wifi_start();
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    } else {
+        s_sta_netif = initialise_wifi();
+        esp_err_t ret = wifi_fast_init(s_sta_netif);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    return wifi_fast_connect(CONFIG_WIFI_FAST_CONNECT_TIMEOUT_MS);
 }
 
+// 低功耗模式：初始化I2C后执行一次唤醒周期，随后进入深度睡眠
+static void low_power_main(void)
+{
+    i2c_config_t i2c_config = {
+        .mode = I2C_MODE_MASTER,
+        .sda_io_num = LOW_POWER_I2C_SDA_IO,
+        .scl_io_num = LOW_POWER_I2C_SCL_IO,
+        .sda_pullup_en = GPIO_PULLUP_ENABLE,
+        .scl_pullup_en = GPIO_PULLUP_ENABLE,
+        .master.clk_speed = 400000
+    };
+    ESP_ERROR_CHECK( i2c_master_init(LOW_POWER_I2C_NUM, &i2c_config) );
+    low_power_run(LOW_POWER_I2C_NUM, AHT10_ADDR, low_power_connect);
+}
+#endif
+
 // 应用程序入口
 void app_main(void)
 {
+    boot_prof_start(); // 开始记录启动时间线
+
+    /* 尽早分配跟踪日志，I2C/AHT10的错误只记录到跟踪日志中，初始化前的记录会被丢弃 */
+    if (trace_log_init() != ESP_OK) {
+        ESP_LOGW(TAG, "跟踪日志初始化失败，错误事件将被丢弃");
+    }
 
     ESP_ERROR_CHECK( nvs_flash_init() ); // 初始化NVS
+    boot_prof_mark("nvs_flash_init");
 
     /* Initialize event handler */
-    event_handler_init();
+    ESP_ERROR_CHECK( event_handler_init() );
+    boot_prof_mark("event_handler");
 
-    initialise_wifi(); // 初始化WiFi
+#if CONFIG_LOW_POWER_MODE
+    /* 定时唤醒时不初始化WiFi，只采样后继续深度睡眠 */
+    if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER) {
+        boot_prof_finish();
+        low_power_main();
+    }
+#endif
+
+    esp_netif_t *sta_netif = initialise_wifi(); // 初始化WiFi
+    boot_prof_mark("initialise_wifi");
 
     /* Initialize smartconfig */
     smartconfig_init(); // 初始化smartconfig
-
+    boot_prof_mark("smartconfig");
+
+#if CONFIG_WIFI_FAST_CONNECT
+    /* 有保存的凭据时直接连接，失败才进入ESPTouch配网 */
+    ESP_ERROR_CHECK( wifi_fast_init(sta_netif) );
+    esp_err_t fast_ret = wifi_fast_connect(CONFIG_WIFI_FAST_CONNECT_TIMEOUT_MS);
+    boot_prof_mark("wifi_connect");
+    if (fast_ret == ESP_OK) {
+        boot_prof_finish();
+#if CONFIG_LOW_POWER_MODE
+        /* 冷启动时凭据验证可用，关闭WiFi转入低功耗采样；未配网时留在ESPTouch */
+        ESP_ERROR_CHECK( esp_wifi_stop() );
+        s_sta_netif = sta_netif;
+        low_power_main();
+#endif
+        return;
+    }
+    ESP_LOGI(TAG, "进入ESPTouch配网");
+#else
+    (void)sta_netif;
+#endif
+
+    boot_prof_finish();
     smartconfig_task(NULL); // 启动smartconfig任务
 
 
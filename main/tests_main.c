@@ -1,9 +1,21 @@
-#include <stdio.h>
+#include <stdlib.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
 #include "i2c_driver.h"
+#include "i2c_bus.h"
+#include "i2c_registry.h"
+#include "i2c_sim.h"
+#include "nvs_flash.h"
 #include "aht10.h"
+#include "sampler.h"
+#include "sample_store.h"
+#include "sample_log.h"
+#include "series_codec.h"
+#include "sensor_snapshot.h"
+#include "json_writer.h"
+#include "cbor_writer.h"
+#include "trace_log.h"
 
 // 日志标签
 static const char *TAG = "MAIN";
@@ -15,78 +27,160 @@ static const char *TAG = "MAIN";
 #define I2C_MASTER_FREQ_HZ 400000      /* I2C频率 400kHz */
 
 /**
- * @brief 温湿度读取任务
+ * @brief 采样结果回调，在采样调度任务中调用
  * 
- * @param pvParameters 任务参数
+ * 第一个传感器的数据发布到快照并写入时序存储和持久化日志，供HTTP查询使用。
  */
-static void aht10_task(void *pvParameters) {
-    aht10_data_t data;
-    i2c_port_t i2c_num = I2C_MASTER_NUM;
-    
-    // 初始化AHT10
-    if (aht10_init(i2c_num) != ESP_OK) {
-        ESP_LOGE(TAG, "AHT10初始化失败，退出任务");
-        vTaskDelete(NULL);
+static void on_sample(size_t index, const sampler_sensor_t *sensor, esp_err_t result,
+                      const aht10_fixed_t *value, void *arg) {
+    if (result == ESP_OK) {
+        TRACE_LOG(TRACE_SAMPLE, index, (int32_t)value->temp_centi, value->hum_centi);
+    } else {
+        TRACE_LOG(TRACE_SAMPLE_FAIL, index, sensor->i2c_num, sensor->dev_addr, result);
     }
     
-    while (1) {
-        // 读取温湿度数据
-        if (aht10_read_data(i2c_num, &data) == ESP_OK) {
-            printf("温度: %.2f°C, 湿度: %.2f%%\n", 
-                   data.temperature, data.humidity);
-        } else {
-            ESP_LOGE(TAG, "读取AHT10数据失败");
-        }
-        
-        // 每2秒读取一次
-        vTaskDelay(2000 / portTICK_PERIOD_MS);
+    if (index != 0) {
+        return;
+    }
+    if (result == ESP_OK) {
+        uint32_t seq = sensor_snapshot_publish(&g_sensor_snapshot, value, true);
+        sample_store_add(sample_store_now(), seq, value);
+        sample_log_append(value);
+    } else {
+        sensor_snapshot_publish(&g_sensor_snapshot, NULL, false);
     }
 }
 
-void app_main(void) {
-    ESP_LOGI(TAG, "AHT10温湿度监测程序启动");
-    
-    // 配置I2C参数
+/**
+ * @brief 初始化一个I2C端口
+ * 
+ * @param i2c_num I2C端口号
+ * @param sda_io SDA引脚
+ * @param scl_io SCL引脚
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+static esp_err_t init_i2c_port(i2c_port_t i2c_num, int sda_io, int scl_io) {
     i2c_config_t i2c_config = {
         .mode = I2C_MODE_MASTER,
-        .sda_io_num = I2C_MASTER_SDA_IO,
-        .scl_io_num = I2C_MASTER_SCL_IO,
+        .sda_io_num = sda_io,
+        .scl_io_num = scl_io,
         .sda_pullup_en = GPIO_PULLUP_ENABLE,
         .scl_pullup_en = GPIO_PULLUP_ENABLE,
         .master.clk_speed = I2C_MASTER_FREQ_HZ
     };
+    return i2c_master_init(i2c_num, &i2c_config);
+}
+
+void app_main(void) {
+    ESP_LOGI(TAG, "AHT10温湿度监测程序启动");
+
+    // 采样结果和I2C错误记录到跟踪日志，不在采样任务中格式化输出
+    if (trace_log_init() != ESP_OK) {
+        ESP_LOGW(TAG, "跟踪日志初始化失败，记录将被丢弃");
+    }
+
+    // 初始化NVS，用于缓存I2C设备列表
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        nvs_flash_erase();
+        ret = nvs_flash_init();
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "NVS初始化失败，I2C设备列表不缓存，错误代码: %d", ret);
+    }
+
+#if CONFIG_PERF_BENCHMARKS
+    // 运行微基准测试
+    json_writer_benchmark();
+    cbor_writer_benchmark();
+    aht10_decode_benchmark();
+    series_codec_benchmark();
+#endif
     
     // 初始化I2C
-    esp_err_t ret = i2c_master_init(I2C_MASTER_NUM, &i2c_config);
+    i2c_port_t ports[I2C_NUM_MAX];
+    size_t port_count = 0;
+    ret = init_i2c_port(I2C_MASTER_NUM, I2C_MASTER_SDA_IO, I2C_MASTER_SCL_IO);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "I2C初始化失败，错误代码: %d", ret);
         return;
     }
+    ports[port_count++] = I2C_MASTER_NUM;
+#if CONFIG_SAMPLER_I2C_PORT1
+    ret = init_i2c_port(I2C_NUM_1, CONFIG_SAMPLER_I2C_PORT1_SDA_IO, CONFIG_SAMPLER_I2C_PORT1_SCL_IO);
+    if (ret == ESP_OK) {
+        ports[port_count++] = I2C_NUM_1;
+    } else {
+        ESP_LOGE(TAG, "I2C端口1初始化失败，错误代码: %d", ret);
+    }
+#endif
     
-    // 扫描I2C设备
-    ESP_LOGI(TAG, "扫描I2C总线设备...");
-    uint8_t found_devices = 0;
-    for (uint8_t addr = 0x01; addr < 0x7F; addr++) {
-        i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-        i2c_master_start(cmd);
-        i2c_master_write_byte(cmd, (addr << 1) | I2C_MASTER_WRITE, true);
-        i2c_master_stop(cmd);
-        
-        esp_err_t err = i2c_master_cmd_begin(I2C_MASTER_NUM, cmd, 50 / portTICK_PERIOD_MS);
-        i2c_cmd_link_delete(cmd);
-        
-        if (err == ESP_OK) {
-            ESP_LOGI(TAG, "发现设备: 0x%02X", addr);
-            found_devices++;
+#if CONFIG_I2C_SIM
+    // 模拟总线上放置AHT10模型，无需真实传感器
+    for (size_t i = 0; i < port_count; i++) {
+        i2c_sim_add_aht10(ports[i], AHT10_ADDR);
+    }
+#endif
+
+    // 发现I2C设备，优先验证NVS中缓存的上次结果，多个端口并行扫描
+    ret = i2c_registry_discover(ports, port_count, false);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "I2C设备发现失败，错误代码: %d", ret);
+    }
+
+#if CONFIG_PERF_BENCHMARKS
+    i2c_driver_benchmark(I2C_MASTER_NUM, AHT10_ADDR);
+#endif
+
+    // 启动总线管理任务，此后各任务对该端口的访问排队串行执行
+    for (size_t i = 0; i < port_count; i++) {
+        ret = i2c_bus_start(ports[i]);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "I2C端口 %d 总线管理任务启动失败，错误代码: %d", (int)ports[i], ret);
         }
     }
     
-    if (found_devices == 0) {
-        ESP_LOGW(TAG, "未在I2C总线上发现任何设备，请检查连接");
-    } else {
-        ESP_LOGI(TAG, "共发现 %d 个设备", found_devices);
+    // 初始化PSRAM时序存储
+    if (sample_store_init() != ESP_OK) {
+        ESP_LOGW(TAG, "采样存储初始化失败，历史数据不可用");
+    }
+    // 打开flash采样日志，重启后历史数据仍可查询
+    if (sample_log_init() != ESP_OK) {
+        ESP_LOGW(TAG, "采样日志初始化失败，采样不会持久化");
+    }
+    
+#if CONFIG_PERF_BENCHMARKS && CONFIG_I2C_SIM
+    // 故障路径检查失败说明驱动的错误处理有回归，不再继续运行
+    uint32_t sim_failures = i2c_sim_benchmark(I2C_MASTER_NUM, AHT10_ADDR);
+    if (sim_failures > 0) {
+        ESP_LOGE(TAG, "模拟总线故障路径检查失败 %lu 项", (unsigned long)sim_failures);
+        abort();
+    }
+#endif
+
+    // 登记所有端口上发现的AHT10，由采样调度器统一调度
+    static const uint8_t aht10_addrs[] = { AHT10_ADDR, AHT10_ADDR_ALT };
+    for (size_t i = 0; i < port_count; i++) {
+        for (size_t k = 0; k < sizeof(aht10_addrs); k++) {
+            if (!i2c_registry_has(ports[i], aht10_addrs[k])) {
+                continue;
+            }
+            sampler_sensor_t sensor = {
+                .driver = &sampler_driver_aht10,
+                .i2c_num = ports[i],
+                .dev_addr = aht10_addrs[k],
+                .period_ms = CONFIG_SAMPLER_PERIOD_MS,
+            };
+            ret = sampler_add(&sensor, NULL);
+            if (ret != ESP_OK) {
+                ESP_LOGE(TAG, "AHT10初始化失败（端口 %d，地址 0x%02X），错误代码: %d",
+                         (int)ports[i], aht10_addrs[k], ret);
+            }
+        }
     }
     
-    // 创建AHT10读取任务
-    xTaskCreate(aht10_task, "aht10_task", 2048, NULL, 5, NULL);
+    ret = sampler_start(on_sample, NULL);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "采样调度器启动失败，错误代码: %d", ret);
+    }
 }
@@ -1,9 +1,15 @@
+#include <string.h>
+#include <math.h>
 #include "aht10.h"
 #include "i2c_driver.h"
+#include "i2c_registry.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "esp_timer.h"
 #include "driver/i2c.h"
+#include "perf_bench.h"
+#include "trace_log.h"
 
 // 日志标签
 static const char *TAG = "AHT10";
@@ -15,8 +21,25 @@ static const char *TAG = "AHT10";
  * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
  */
 esp_err_t aht10_init(i2c_port_t i2c_num) {
+    return aht10_init_at(i2c_num, AHT10_ADDR);
+}
+
+/**
+ * @brief 初始化指定地址的AHT10传感器
+ * 
+ * @param i2c_num I2C端口号
+ * @param dev_addr 设备地址（AHT10_ADDR或AHT10_ADDR_ALT）
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t aht10_init_at(i2c_port_t i2c_num, uint8_t dev_addr) {
     esp_err_t ret;
     
+    // 已完成设备发现时直接查表，不再重复探测
+    if (i2c_registry_scanned(i2c_num) && !i2c_registry_has(i2c_num, dev_addr)) {
+        ESP_LOGE(TAG, "I2C端口 %d 上未发现AHT10（0x%02X）", (int)i2c_num, dev_addr);
+        return ESP_ERR_NOT_FOUND;
+    }
+    
     // 上电后等待至少40ms（AHT10要求）
     vTaskDelay(50 / portTICK_PERIOD_MS);
     
@@ -24,7 +47,7 @@ esp_err_t aht10_init(i2c_port_t i2c_num) {
     
     // 首先检查传感器状态
     uint8_t status_data[1] = {0};
-    ret = my_i2c_master_read(i2c_num, AHT10_ADDR, status_data, 1);
+    ret = my_i2c_master_read(i2c_num, dev_addr, status_data, 1);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "读取状态失败，错误代码: %d", ret);
         return ret;
@@ -35,17 +58,9 @@ esp_err_t aht10_init(i2c_port_t i2c_num) {
     if (!(status_data[0] & 0x08)) {
         ESP_LOGI(TAG, "传感器需要初始化");
         
-        // 使用i2c_master_cmd_begin直接发送初始化命令
-        i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-        i2c_master_start(cmd);
-        i2c_master_write_byte(cmd, (AHT10_ADDR << 1) | I2C_MASTER_WRITE, true);
-        i2c_master_write_byte(cmd, 0xE1, true);  // 初始化命令
-        i2c_master_write_byte(cmd, 0x08, true);  // 参数1
-        i2c_master_write_byte(cmd, 0x00, true);  // 参数2
-        i2c_master_stop(cmd);
-        
-        ret = i2c_master_cmd_begin(i2c_num, cmd, 1000 / portTICK_PERIOD_MS);
-        i2c_cmd_link_delete(cmd);
+        // 发送初始化命令及两个参数
+        static const uint8_t init_cmd[3] = {0xE1, 0x08, 0x00};
+        ret = my_i2c_master_write(i2c_num, dev_addr, init_cmd, sizeof(init_cmd));
         
         if (ret != ESP_OK) {
             ESP_LOGE(TAG, "初始化命令发送失败，错误代码: %d", ret);
@@ -60,38 +75,212 @@ esp_err_t aht10_init(i2c_port_t i2c_num) {
     return ESP_OK;
 }
 
+/* 帧中的20位湿度原始值：read_data[1]的8位 + read_data[2]的8位 + read_data[3]的高4位 */
+static inline uint32_t frame_humidity_raw(const uint8_t *frame) {
+    return ((uint32_t)frame[1] << 12) | ((uint32_t)frame[2] << 4) | (frame[3] >> 4);
+}
+
+/* 帧中的20位温度原始值：read_data[3]的低4位 + read_data[4]的8位 + read_data[5]的8位 */
+static inline uint32_t frame_temperature_raw(const uint8_t *frame) {
+    return (((uint32_t)frame[3] & 0x0F) << 16) | ((uint32_t)frame[4] << 8) | frame[5];
+}
+
+/*
+ * 湿度 = raw / 2^20 * 100%，以0.01%为单位即 raw * 10000 / 2^20 = raw * 625 / 2^16。
+ * raw < 2^20，raw * 625 < 2^30，32位乘法不会溢出；加半个单位后移位实现四舍五入。
+ */
+static inline uint16_t humidity_centi(uint32_t raw) {
+    return (uint16_t)((raw * 625 + (1u << 15)) >> 16);
+}
+
+/* 温度 = raw / 2^20 * 200 - 50℃，以0.01℃为单位即 raw * 625 / 2^15 - 5000 */
+static inline int16_t temperature_centi(uint32_t raw) {
+    return (int16_t)((int32_t)((raw * 625 + (1u << 14)) >> 15) - 5000);
+}
+
 /**
- * @brief 从AHT10读取温湿度数据
+ * @brief 以定点数解析6字节测量帧，只使用乘法和移位
  * 
- * @param i2c_num I2C端口号
- * @param data 存储温湿度数据的结构体指针
- * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ * @param frame 原始数据，首字节为状态字节
+ * @param out 输出定点温湿度
+ * @return esp_err_t 成功返回ESP_OK；状态字节忙标志置位（数据无效）返回ESP_ERR_NOT_FINISHED
  */
-esp_err_t aht10_read_data(i2c_port_t i2c_num, aht10_data_t *data) {
-    if (data == NULL) {
+esp_err_t aht10_decode_frame(const uint8_t frame[AHT10_FRAME_LEN], aht10_fixed_t *out) {
+    if (frame == NULL || out == NULL) {
         return ESP_ERR_INVALID_ARG;
     }
+    if (frame[0] & AHT10_STATUS_BUSY) {
+        return ESP_ERR_NOT_FINISHED;
+    }
+    out->temp_centi = temperature_centi(frame_temperature_raw(frame));
+    out->hum_centi = humidity_centi(frame_humidity_raw(frame));
+    return ESP_OK;
+}
+
+/**
+ * @brief 批量解析测量帧，结果按温度、湿度分别写入两个数组
+ * 
+ * @param frames 连续存放的测量帧
+ * @param count 帧数
+ * @param temp_centi 温度输出数组，单位：0.01℃
+ * @param hum_centi 湿度输出数组，单位：0.01%
+ * @return size_t 有效帧数
+ */
+size_t aht10_decode_batch(const uint8_t (*frames)[AHT10_FRAME_LEN], size_t count,
+                          int16_t *temp_centi, uint16_t *hum_centi) {
+    if (frames == NULL || temp_centi == NULL || hum_centi == NULL) {
+        return 0;
+    }
     
-    esp_err_t ret;
+    size_t valid = 0;
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t *frame = frames[i];
+        if (frame[0] & AHT10_STATUS_BUSY) {
+            temp_centi[i] = AHT10_CENTI_INVALID;
+            hum_centi[i] = AHT10_HUM_CENTI_INVALID;
+            continue;
+        }
+        temp_centi[i] = temperature_centi(frame_temperature_raw(frame));
+        hum_centi[i] = humidity_centi(frame_humidity_raw(frame));
+        valid++;
+    }
+    return valid;
+}
+
+/**
+ * @brief 将定点温湿度转换为浮点视图
+ * 
+ * @param fixed 定点温湿度
+ * @param data 输出浮点温湿度
+ */
+void aht10_fixed_to_float(const aht10_fixed_t *fixed, aht10_data_t *data) {
+    data->temperature = fixed->temp_centi / 100.0f;
+    data->humidity = fixed->hum_centi / 100.0f;
+}
+
+/**
+ * @brief 将浮点温湿度四舍五入为定点表示，由定点值换算得到的浮点数可无损还原
+ * 
+ * @param data 浮点温湿度
+ * @param fixed 输出定点温湿度
+ */
+void aht10_float_to_fixed(const aht10_data_t *data, aht10_fixed_t *fixed) {
+    long hum = lroundf(data->humidity * 100.0f);
+    fixed->temp_centi = (int16_t)lroundf(data->temperature * 100.0f);
+    fixed->hum_centi = (uint16_t)(hum < 0 ? 0 : hum);
+}
+
+/**
+ * @brief 触发一次温湿度测量，立即返回
+ * 
+ * @param i2c_num I2C端口号
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t aht10_trigger_measurement(i2c_port_t i2c_num) {
+    return aht10_trigger_measurement_at(i2c_num, AHT10_ADDR);
+}
+
+/**
+ * @brief 触发指定地址的AHT10测量，立即返回
+ * 
+ * @param i2c_num I2C端口号
+ * @param dev_addr 设备地址
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t aht10_trigger_measurement_at(i2c_port_t i2c_num, uint8_t dev_addr) {
     // 测量命令数据 - 触发测量命令
-    uint8_t measure_cmd[3] = {0xAC, 0x33, 0x00};
-    // 存储读取到的原始数据
-    uint8_t read_data[6] = {0};
+    static const uint8_t measure_cmd[3] = {AHT10_CMD_MEASURE, 0x33, 0x00};
+    
+    esp_err_t ret = my_i2c_master_write(i2c_num, dev_addr, measure_cmd, sizeof(measure_cmd));
+    if (ret != ESP_OK) {
+        TRACE_LOG(TRACE_AHT10_TRIGGER_FAIL, i2c_num, dev_addr, ret);
+    }
+    return ret;
+}
+
+/**
+ * @brief 读取状态字节，判断测量是否仍在进行
+ * 
+ * @param i2c_num I2C端口号
+ * @param busy 输出忙标志（状态位7）
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t aht10_is_busy(i2c_port_t i2c_num, bool *busy) {
+    return aht10_is_busy_at(i2c_num, AHT10_ADDR, busy);
+}
+
+/**
+ * @brief 读取指定地址AHT10的状态字节，判断测量是否仍在进行
+ * 
+ * @param i2c_num I2C端口号
+ * @param dev_addr 设备地址
+ * @param busy 输出忙标志（状态位7）
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t aht10_is_busy_at(i2c_port_t i2c_num, uint8_t dev_addr, bool *busy) {
+    if (busy == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
     
-    // 发送测量命令
-    ret = my_i2c_master_write(i2c_num, AHT10_ADDR, measure_cmd, sizeof(measure_cmd));
+    uint8_t status = 0;
+    esp_err_t ret = my_i2c_master_read(i2c_num, dev_addr, &status, 1);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "发送测量命令失败");
         return ret;
     }
+    *busy = (status & AHT10_STATUS_BUSY) != 0;
+    return ESP_OK;
+}
+
+/**
+ * @brief 读取并解析测量结果
+ * 
+ * @param i2c_num I2C端口号
+ * @param data 存储温湿度数据的结构体指针
+ * @return esp_err_t 成功返回ESP_OK；转换未完成返回ESP_ERR_NOT_FINISHED
+ */
+esp_err_t aht10_collect(i2c_port_t i2c_num, aht10_data_t *data) {
+    return aht10_collect_at(i2c_num, AHT10_ADDR, data);
+}
+
+/**
+ * @brief 读取并解析指定地址的AHT10测量结果
+ * 
+ * @param i2c_num I2C端口号
+ * @param dev_addr 设备地址
+ * @param data 存储温湿度数据的结构体指针
+ * @return esp_err_t 成功返回ESP_OK；转换未完成返回ESP_ERR_NOT_FINISHED
+ */
+esp_err_t aht10_collect_at(i2c_port_t i2c_num, uint8_t dev_addr, aht10_data_t *data) {
+    if (data == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
     
-    // 等待测量完成
-    vTaskDelay(100 / portTICK_PERIOD_MS);
+    aht10_fixed_t fixed;
+    esp_err_t ret = aht10_collect_fixed_at(i2c_num, dev_addr, &fixed);
+    if (ret == ESP_OK) {
+        aht10_fixed_to_float(&fixed, data);
+    }
+    return ret;
+}
+
+/**
+ * @brief 读取并以定点数解析指定地址的AHT10测量结果
+ * 
+ * @param i2c_num I2C端口号
+ * @param dev_addr 设备地址
+ * @param fixed 输出定点温湿度
+ * @return esp_err_t 成功返回ESP_OK；转换未完成返回ESP_ERR_NOT_FINISHED
+ */
+esp_err_t aht10_collect_fixed_at(i2c_port_t i2c_num, uint8_t dev_addr, aht10_fixed_t *fixed) {
+    if (fixed == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
     
-    // 读取测量结果
-    ret = my_i2c_master_read(i2c_num, AHT10_ADDR, read_data, sizeof(read_data));
+    // 存储读取到的原始数据
+    uint8_t read_data[AHT10_FRAME_LEN] = {0};
+    esp_err_t ret = my_i2c_master_read(i2c_num, dev_addr, read_data, sizeof(read_data));
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "读取数据失败");
+        TRACE_LOG(TRACE_AHT10_READ_FAIL, i2c_num, dev_addr, ret);
         return ret;
     }
     
@@ -100,32 +289,111 @@ esp_err_t aht10_read_data(i2c_port_t i2c_num, aht10_data_t *data) {
     // AHT10 传感器的响应数据中，第一个字节（read_data[0]）包含了状态信息
     // 其中最高位（第 7 位，从 0 开始计数）是数据就绪标志位
     // 当该位为 0 时，表示测量完成且数据有效；为 1 时，表示数据尚未准备好或无效
-    // 位运算解析：
-    // 0x80 是十六进制数，对应的二进制是 10000000
-    // read_data[0] & 0x80 这一运算会保留read_data[0]的第 7 位，其他位都变为 0
-    // 如果结果为 0（即!(read_data[0] & 0x80)为真），说明第 7 位是 0，数据有效
-    if (!(read_data[0] & 0x80)) {
-        // 计算湿度值
-        // 湿度原始数据为20位：read_data[1]的8位 + read_data[2]的8位 + read_data[3]的高4位
-        uint32_t humidity_raw = ((uint32_t)read_data[1] << 12) | 
-                               ((uint32_t)read_data[2] << 4) | 
-                               ((read_data[3] >> 4) & 0x0F);
-        // 转换为湿度百分比（0-100%）
-        data->humidity = (humidity_raw * 100.0f) / 0x100000;
-        
-        // 计算温度值
-        // 温度原始数据为20位：read_data[3]的低4位 + read_data[4]的8位 + read_data[5]的8位
-        uint32_t temp_raw = (((uint32_t)read_data[3] & 0x0F) << 16) | 
-                           ((uint32_t)read_data[4] << 8) | 
-                           read_data[5];
-        // 转换为温度（-40℃ 至 85℃）
-        data->temperature = (temp_raw * 200.0f) / 0x100000 - 50;
-        
-        ESP_LOGI(TAG, "数据读取成功 - 温度: %.2f°C, 湿度: %.2f%%", 
-                 data->temperature, data->humidity);
-        return ESP_OK;
-    } else {
-        ESP_LOGE(TAG, "数据无效");
-        return ESP_FAIL;
-    }
-};
+    return aht10_decode_frame(read_data, fixed);
+}
+
+/**
+ * @brief 从AHT10读取温湿度数据
+ * 
+ * 触发测量后先等待典型转换时间，再按AHT10_POLL_INTERVAL_MS轮询忙标志，
+ * 数据就绪即返回，而不是固定等待最坏情况的转换时间。
+ * 
+ * @param i2c_num I2C端口号
+ * @param data 存储温湿度数据的结构体指针
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t aht10_read_data(i2c_port_t i2c_num, aht10_data_t *data) {
+    if (data == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    esp_err_t ret = aht10_trigger_measurement(i2c_num);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    int64_t start_us = esp_timer_get_time();
+    
+    // 等待典型转换时间
+    vTaskDelay(pdMS_TO_TICKS(AHT10_MEASURE_TYPICAL_MS));
+    
+    // 轮询直到数据就绪或超时；按实际经过的时间判断超时，
+    // 且每次至少等待1个tick（100Hz时pdMS_TO_TICKS(5)为0）
+    TickType_t poll_ticks = pdMS_TO_TICKS(AHT10_POLL_INTERVAL_MS);
+    aht10_fixed_t fixed;
+    while ((ret = aht10_collect_fixed_at(i2c_num, AHT10_ADDR, &fixed)) == ESP_ERR_NOT_FINISHED) {
+        if (esp_timer_get_time() - start_us >= AHT10_MEASURE_TIMEOUT_MS * 1000LL) {
+            TRACE_LOG(TRACE_AHT10_TIMEOUT, i2c_num);
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(poll_ticks > 0 ? poll_ticks : 1);
+    }
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    // 每次采样都会经过这里，只记录到跟踪日志；浮点输出由定点值换算，只解析一次
+    TRACE_LOG(TRACE_AHT10_DATA, i2c_num, (int32_t)fixed.temp_centi, fixed.hum_centi);
+    aht10_fixed_to_float(&fixed, data);
+    return ESP_OK;
+}
+
+#if CONFIG_PERF_BENCHMARKS
+// 基准测试的帧数和轮数
+#define AHT10_BENCH_FRAMES 256
+#define AHT10_BENCH_ROUNDS 100
+
+/* 原先的浮点解析，仅作为基准测试的对照 */
+static void aht10_parse_frame_float(const uint8_t *frame, aht10_data_t *data) {
+    data->humidity = (frame_humidity_raw(frame) * 100.0f) / 0x100000;
+    data->temperature = (frame_temperature_raw(frame) * 200.0f) / 0x100000 - 50;
+}
+
+/**
+ * @brief 对比浮点逐帧解析与定点批量解析的耗时，并校验两者误差
+ */
+void aht10_decode_benchmark(void) {
+    static uint8_t frames[AHT10_BENCH_FRAMES][AHT10_FRAME_LEN];
+    static aht10_data_t floats[AHT10_BENCH_FRAMES];
+    static int16_t temp_centi[AHT10_BENCH_FRAMES];
+    static uint16_t hum_centi[AHT10_BENCH_FRAMES];
+    perf_bench_t bench;
+    
+    // 用线性同余序列生成覆盖全量程的测量帧
+    uint32_t seed = 0x12345678;
+    for (int i = 0; i < AHT10_BENCH_FRAMES; i++) {
+        frames[i][0] = AHT10_STATUS_CAL;
+        for (int k = 1; k < AHT10_FRAME_LEN; k++) {
+            seed = seed * 1664525u + 1013904223u;
+            frames[i][k] = (uint8_t)(seed >> 24);
+        }
+    }
+    
+    perf_bench_begin(&bench, "AHT10浮点逐帧解析");
+    for (int r = 0; r < AHT10_BENCH_ROUNDS; r++) {
+        for (int i = 0; i < AHT10_BENCH_FRAMES; i++) {
+            aht10_parse_frame_float(frames[i], &floats[i]);
+        }
+    }
+    perf_bench_end(&bench, AHT10_BENCH_ROUNDS * AHT10_BENCH_FRAMES);
+    
+    perf_bench_begin(&bench, "AHT10定点批量解析");
+    for (int r = 0; r < AHT10_BENCH_ROUNDS; r++) {
+        aht10_decode_batch((const uint8_t (*)[AHT10_FRAME_LEN])frames, AHT10_BENCH_FRAMES,
+                           temp_centi, hum_centi);
+    }
+    perf_bench_end(&bench, AHT10_BENCH_ROUNDS * AHT10_BENCH_FRAMES);
+    
+    // 定点结果与浮点结果相差不应超过半个0.01单位（四舍五入）
+    float max_temp_err = 0, max_hum_err = 0;
+    for (int i = 0; i < AHT10_BENCH_FRAMES; i++) {
+        float temp_err = floats[i].temperature * 100.0f - temp_centi[i];
+        float hum_err = floats[i].humidity * 100.0f - hum_centi[i];
+        temp_err = temp_err < 0 ? -temp_err : temp_err;
+        hum_err = hum_err < 0 ? -hum_err : hum_err;
+        if (temp_err > max_temp_err) max_temp_err = temp_err;
+        if (hum_err > max_hum_err) max_hum_err = hum_err;
+    }
+    ESP_LOGI(TAG, "定点解析最大误差: 温度 %.3f, 湿度 %.3f（单位0.01）", max_temp_err, max_hum_err);
+}
+#endif
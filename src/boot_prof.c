@@ -0,0 +1,154 @@
+/**
+ * @file boot_prof.c
+ * @brief 启动阶段计时
+ *
+ * 每个阶段记录esp_timer时间差和空闲堆变化，存放在RTC内存的环形记录中，
+ * 跨软件复位保留，供/api/v1/system/boot查询，用于跟踪启动时间的回退。
+ */
+#include "boot_prof.h"
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+// RTC记录有效标志
+#define BOOT_PROF_MAGIC 0x424F4F54
+
+// 跨复位保留的启动记录
+typedef struct {
+    uint32_t magic;
+    uint32_t boot_count;            // 自上电以来的启动次数
+    uint32_t head;                  // 当前记录的下标
+    uint32_t count;                 // 有效记录数
+    boot_prof_record_t records[CONFIG_BOOT_PROF_HISTORY];
+} boot_prof_rtc_t;
+
+RTC_NOINIT_ATTR static boot_prof_rtc_t s_rtc;
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+// 上一次标记的时间和空闲堆
+static uint32_t s_last_us;
+static uint32_t s_last_heap;
+// 本次启动是否已调用boot_prof_start()
+static bool s_started = false;
+
+/**
+ * @brief 开始记录本次启动，应在app_main开头调用
+ */
+void boot_prof_start(void)
+{
+    uint32_t now_us = (uint32_t)esp_timer_get_time();
+    uint32_t heap = esp_get_free_heap_size();
+    esp_reset_reason_t reason = esp_reset_reason();
+
+    portENTER_CRITICAL(&s_lock);
+    // RTC_NOINIT内存在上电后内容随机；校验失败或上电复位时清空
+    if (s_rtc.magic != BOOT_PROF_MAGIC || reason == ESP_RST_POWERON ||
+        s_rtc.head >= CONFIG_BOOT_PROF_HISTORY || s_rtc.count > CONFIG_BOOT_PROF_HISTORY) {
+        memset(&s_rtc, 0, sizeof(s_rtc));
+        s_rtc.magic = BOOT_PROF_MAGIC;
+        s_rtc.head = CONFIG_BOOT_PROF_HISTORY - 1;
+    }
+    s_rtc.boot_count++;
+    s_rtc.head = (s_rtc.head + 1) % CONFIG_BOOT_PROF_HISTORY;
+    if (s_rtc.count < CONFIG_BOOT_PROF_HISTORY) {
+        s_rtc.count++;
+    }
+
+    boot_prof_record_t *record = &s_rtc.records[s_rtc.head];
+    memset(record, 0, sizeof(*record));
+    record->boot_count = s_rtc.boot_count;
+    record->reset_reason = (uint8_t)reason;
+    record->app_start_us = now_us;
+    record->total_us = now_us;
+    record->free_heap_start = heap;
+    record->free_heap_end = heap;
+    s_last_us = now_us;
+    s_last_heap = heap;
+    s_started = true;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+/**
+ * @brief 结束一个阶段，阶段从上一次标记（或boot_prof_start）开始
+ *
+ * @param name 阶段名称，超长部分截断
+ */
+void boot_prof_mark(const char *name)
+{
+    uint32_t now_us = (uint32_t)esp_timer_get_time();
+    uint32_t heap = esp_get_free_heap_size();
+
+    portENTER_CRITICAL(&s_lock);
+    if (s_started) {
+        boot_prof_record_t *record = &s_rtc.records[s_rtc.head];
+        if (record->stage_count < CONFIG_BOOT_PROF_MAX_STAGES) {
+            boot_prof_stage_t *stage = &record->stages[record->stage_count++];
+            strlcpy(stage->name, name, sizeof(stage->name));
+            stage->start_us = s_last_us;
+            stage->duration_us = now_us - s_last_us;
+            stage->heap_delta = (int32_t)(heap - s_last_heap);
+        }
+        record->total_us = now_us;
+        record->free_heap_end = heap;
+        s_last_us = now_us;
+        s_last_heap = heap;
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+/**
+ * @brief 标记启动完成
+ */
+void boot_prof_finish(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    if (s_started) {
+        s_rtc.records[s_rtc.head].complete = true;
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+/**
+ * @brief 读取一条保存的启动记录
+ *
+ * @param index 0为本次启动，1为上一次，依此类推
+ * @param record 输出记录
+ * @return bool 记录存在返回true
+ */
+bool boot_prof_get(size_t index, boot_prof_record_t *record)
+{
+    bool found = false;
+    portENTER_CRITICAL(&s_lock);
+    if (s_started && index < s_rtc.count) {
+        size_t slot = (s_rtc.head + CONFIG_BOOT_PROF_HISTORY - index) % CONFIG_BOOT_PROF_HISTORY;
+        *record = s_rtc.records[slot];
+        found = true;
+    }
+    portEXIT_CRITICAL(&s_lock);
+    return found;
+}
+
+/**
+ * @brief 复位原因的名称
+ *
+ * @param reason 复位原因（esp_reset_reason_t）
+ * @return const char* 名称，如"poweron"、"panic"
+ */
+const char *boot_prof_reset_reason_name(uint8_t reason)
+{
+    switch ((esp_reset_reason_t)reason) {
+    case ESP_RST_POWERON:   return "poweron";
+    case ESP_RST_EXT:       return "external";
+    case ESP_RST_SW:        return "software";
+    case ESP_RST_PANIC:     return "panic";
+    case ESP_RST_INT_WDT:   return "int_wdt";
+    case ESP_RST_TASK_WDT:  return "task_wdt";
+    case ESP_RST_WDT:       return "wdt";
+    case ESP_RST_DEEPSLEEP: return "deepsleep";
+    case ESP_RST_BROWNOUT:  return "brownout";
+    case ESP_RST_SDIO:      return "sdio";
+    default:                return "unknown";
+    }
+}
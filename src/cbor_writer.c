@@ -0,0 +1,262 @@
+/**
+ * @file cbor_writer.c
+ * @brief 无堆分配的流式CBOR写入器实现
+ */
+#include <string.h>
+#include "sdkconfig.h"
+#include "cbor_writer.h"
+
+// CBOR主类型
+#define CBOR_UINT   (0 << 5)
+#define CBOR_NEGINT (1 << 5)
+#define CBOR_TEXT   (3 << 5)
+#define CBOR_ARRAY  (4 << 5)
+#define CBOR_MAP    (5 << 5)
+#define CBOR_SIMPLE (7 << 5)
+
+// 附加信息：不定长、结束标记及简单值
+#define CBOR_INDEFINITE 31
+#define CBOR_BREAK      0xFF
+#define CBOR_FALSE      (CBOR_SIMPLE | 20)
+#define CBOR_TRUE       (CBOR_SIMPLE | 21)
+#define CBOR_NULL       (CBOR_SIMPLE | 22)
+
+// 类型头的最大长度（1字节类型 + 8字节参数）
+#define CBOR_HEAD_MAX 9
+
+/* 写入类型头，参数按大端以最短形式编码 */
+static void cbor_head(cbor_writer_t *w, uint8_t major, uint64_t value)
+{
+    uint8_t *p = (uint8_t *)chunk_buf_reserve(&w->out, CBOR_HEAD_MAX);
+    if (p == NULL) {
+        return;
+    }
+    size_t n;
+    if (value < 24) {
+        p[0] = major | (uint8_t)value;
+        n = 1;
+    } else if (value <= 0xFF) {
+        p[0] = major | 24;
+        p[1] = (uint8_t)value;
+        n = 2;
+    } else if (value <= 0xFFFF) {
+        p[0] = major | 25;
+        p[1] = (uint8_t)(value >> 8);
+        p[2] = (uint8_t)value;
+        n = 3;
+    } else if (value <= 0xFFFFFFFF) {
+        p[0] = major | 26;
+        p[1] = (uint8_t)(value >> 24);
+        p[2] = (uint8_t)(value >> 16);
+        p[3] = (uint8_t)(value >> 8);
+        p[4] = (uint8_t)value;
+        n = 5;
+    } else {
+        p[0] = major | 27;
+        for (int i = 0; i < 8; i++) {
+            p[1 + i] = (uint8_t)(value >> (56 - 8 * i));
+        }
+        n = 9;
+    }
+    w->out.len += n;
+}
+
+static inline void cbor_byte(cbor_writer_t *w, uint8_t byte)
+{
+    uint8_t *p = (uint8_t *)chunk_buf_reserve(&w->out, 1);
+    if (p != NULL) {
+        *p = byte;
+        w->out.len++;
+    }
+}
+
+void cbor_writer_init(cbor_writer_t *w, uint8_t *buf, size_t size, httpd_req_t *req)
+{
+    chunk_buf_init(&w->out, (char *)buf, size, req);
+    if (size < CBOR_HEAD_MAX) {
+        w->out.err = ESP_ERR_INVALID_ARG;
+    }
+}
+
+void cbor_map_begin(cbor_writer_t *w)
+{
+    cbor_byte(w, CBOR_MAP | CBOR_INDEFINITE);
+}
+
+void cbor_arr_begin(cbor_writer_t *w)
+{
+    cbor_byte(w, CBOR_ARRAY | CBOR_INDEFINITE);
+}
+
+void cbor_end(cbor_writer_t *w)
+{
+    cbor_byte(w, CBOR_BREAK);
+}
+
+void cbor_arr_begin_n(cbor_writer_t *w, size_t count)
+{
+    cbor_head(w, CBOR_ARRAY, count);
+}
+
+void cbor_str(cbor_writer_t *w, const char *value)
+{
+    size_t len = strlen(value);
+    cbor_head(w, CBOR_TEXT, len);
+    chunk_buf_write(&w->out, value, len);
+}
+
+void cbor_uint(cbor_writer_t *w, uint64_t value)
+{
+    cbor_head(w, CBOR_UINT, value);
+}
+
+void cbor_int(cbor_writer_t *w, int64_t value)
+{
+    if (value < 0) {
+        /* 负数编码为-1-n */
+        cbor_head(w, CBOR_NEGINT, (uint64_t)(-1 - value));
+    } else {
+        cbor_head(w, CBOR_UINT, (uint64_t)value);
+    }
+}
+
+void cbor_bool(cbor_writer_t *w, bool value)
+{
+    cbor_byte(w, value ? CBOR_TRUE : CBOR_FALSE);
+}
+
+void cbor_null(cbor_writer_t *w)
+{
+    cbor_byte(w, CBOR_NULL);
+}
+
+void cbor_kv_str(cbor_writer_t *w, const char *key, const char *value)
+{
+    cbor_str(w, key);
+    cbor_str(w, value);
+}
+
+void cbor_kv_int(cbor_writer_t *w, const char *key, int64_t value)
+{
+    cbor_str(w, key);
+    cbor_int(w, value);
+}
+
+void cbor_kv_uint(cbor_writer_t *w, const char *key, uint64_t value)
+{
+    cbor_str(w, key);
+    cbor_uint(w, value);
+}
+
+void cbor_kv_bool(cbor_writer_t *w, const char *key, bool value)
+{
+    cbor_str(w, key);
+    cbor_bool(w, value);
+}
+
+esp_err_t cbor_writer_finish(cbor_writer_t *w)
+{
+    return chunk_buf_finish(&w->out);
+}
+
+#if CONFIG_PERF_BENCHMARKS
+#include <stdlib.h>
+#include "cJSON.h"
+#include "esp_log.h"
+#include "json_writer.h"
+#include "perf_bench.h"
+
+// 每轮输出的采样数与轮数
+#define CBOR_BENCH_SAMPLES 1000
+#define CBOR_BENCH_ROUNDS 10
+// 容纳1000个采样的JSON输出
+#define CBOR_BENCH_BUFSIZE (48 * 1024)
+
+static const char *TAG = "CBOR_WRITER";
+
+/* 与/api/v1/temp/since的响应内容一致，温湿度在JSON中为两位小数，在CBOR中为0.01单位的整数 */
+static void bench_sample(uint32_t i, uint32_t *ts, int32_t *temp_centi, int32_t *hum_centi)
+{
+    *ts = 7200 + 2 * i;
+    *temp_centi = 2350 + (int32_t)(i * 7 % 23) - 11;
+    *hum_centi = 4820 + (int32_t)(i * 13 % 41) - 20;
+}
+
+/**
+ * @brief 对比cJSON、json_writer与cbor_writer输出1000个采样的耗时和响应大小
+ */
+void cbor_writer_benchmark(void)
+{
+    static uint8_t buf[CBOR_BENCH_BUFSIZE];
+    perf_bench_t bench;
+    uint32_t ts;
+    int32_t temp, hum;
+    size_t cjson_len = 0, json_len = 0, cbor_len = 0;
+
+    perf_bench_begin(&bench, "cJSON 1000采样");
+    for (int r = 0; r < CBOR_BENCH_ROUNDS; r++) {
+        cJSON *root = cJSON_CreateObject();
+        cJSON *samples = cJSON_AddArrayToObject(root, "samples");
+        for (uint32_t i = 0; i < CBOR_BENCH_SAMPLES; i++) {
+            bench_sample(i, &ts, &temp, &hum);
+            cJSON *sample = cJSON_CreateArray();
+            cJSON_AddItemToArray(sample, cJSON_CreateNumber(i + 1));
+            cJSON_AddItemToArray(sample, cJSON_CreateNumber(ts));
+            cJSON_AddItemToArray(sample, cJSON_CreateNumber(temp / 100.0));
+            cJSON_AddItemToArray(sample, cJSON_CreateNumber(hum / 100.0));
+            cJSON_AddItemToArray(samples, sample);
+        }
+        char *out = cJSON_PrintUnformatted(root);
+        cjson_len = out ? strlen(out) : 0;
+        free(out);
+        cJSON_Delete(root);
+    }
+    perf_bench_end(&bench, CBOR_BENCH_ROUNDS);
+
+    perf_bench_begin(&bench, "json_writer 1000采样");
+    for (int r = 0; r < CBOR_BENCH_ROUNDS; r++) {
+        json_writer_t w;
+        json_writer_init(&w, (char *)buf, sizeof(buf), NULL);
+        json_obj_begin(&w);
+        json_key(&w, "samples");
+        json_arr_begin(&w);
+        for (uint32_t i = 0; i < CBOR_BENCH_SAMPLES; i++) {
+            bench_sample(i, &ts, &temp, &hum);
+            json_arr_begin(&w);
+            json_uint(&w, i + 1);
+            json_uint(&w, ts);
+            json_float(&w, temp / 100.0f, 2);
+            json_float(&w, hum / 100.0f, 2);
+            json_arr_end(&w);
+        }
+        json_arr_end(&w);
+        json_obj_end(&w);
+        json_len = w.out.err == ESP_OK ? w.out.len : 0;
+    }
+    perf_bench_end(&bench, CBOR_BENCH_ROUNDS);
+
+    perf_bench_begin(&bench, "cbor_writer 1000采样");
+    for (int r = 0; r < CBOR_BENCH_ROUNDS; r++) {
+        cbor_writer_t w;
+        cbor_writer_init(&w, buf, sizeof(buf), NULL);
+        cbor_map_begin(&w);
+        cbor_str(&w, "samples");
+        cbor_arr_begin(&w);
+        for (uint32_t i = 0; i < CBOR_BENCH_SAMPLES; i++) {
+            bench_sample(i, &ts, &temp, &hum);
+            cbor_arr_begin_n(&w, 4);
+            cbor_uint(&w, i + 1);
+            cbor_uint(&w, ts);
+            cbor_int(&w, temp);
+            cbor_uint(&w, hum);
+        }
+        cbor_end(&w);
+        cbor_end(&w);
+        cbor_len = w.out.err == ESP_OK ? w.out.len : 0;
+    }
+    perf_bench_end(&bench, CBOR_BENCH_ROUNDS);
+
+    ESP_LOGI(TAG, "1000采样响应大小: cJSON %u字节, json_writer %u字节, CBOR %u字节",
+             (unsigned)cjson_len, (unsigned)json_len, (unsigned)cbor_len);
+}
+#endif
@@ -0,0 +1,58 @@
+/**
+ * @file chunk_buf.c
+ * @brief 分块发送的输出缓冲区实现
+ */
+#include "chunk_buf.h"
+
+void chunk_buf_init(chunk_buf_t *cb, char *buf, size_t size, httpd_req_t *req)
+{
+    cb->req = req;
+    cb->buf = buf;
+    cb->size = size;
+    cb->len = 0;
+    cb->err = (buf == NULL || size == 0) ? ESP_ERR_INVALID_ARG : ESP_OK;
+}
+
+bool chunk_buf_flush(chunk_buf_t *cb)
+{
+    if (cb->req == NULL) {
+        cb->err = ESP_ERR_NO_MEM;
+        return false;
+    }
+    esp_err_t ret = httpd_resp_send_chunk(cb->req, cb->buf, cb->len);
+    if (ret != ESP_OK) {
+        cb->err = ret;
+        return false;
+    }
+    cb->len = 0;
+    return true;
+}
+
+void chunk_buf_write_slow(chunk_buf_t *cb, const void *data, size_t len)
+{
+    const char *src = data;
+    while (cb->err == ESP_OK && len > 0) {
+        if (cb->len == cb->size && !chunk_buf_flush(cb)) {
+            return;
+        }
+        size_t n = cb->size - cb->len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(cb->buf + cb->len, src, n);
+        cb->len += n;
+        src += n;
+        len -= n;
+    }
+}
+
+esp_err_t chunk_buf_finish(chunk_buf_t *cb)
+{
+    if (cb->err != ESP_OK || cb->req == NULL) {
+        return cb->err;
+    }
+    if (cb->len > 0 && !chunk_buf_flush(cb)) {
+        return cb->err;
+    }
+    return httpd_resp_send_chunk(cb->req, NULL, 0);
+}
@@ -3,7 +3,7 @@
  * @brief HTTP RESTful API服务器主程序
  * 
  * 该文件实现了基于ESP-IDF的RESTful API服务器示例，包括网络初始化、
- * mDNS服务配置、文件系统挂载（支持半主机、SD卡和SPIFFS）以及REST服务器启动。
+ * mDNS服务配置、文件系统挂载（支持半主机、SD卡、SPIFFS和内存映射资源镜像）以及REST服务器启动。
  */
 /* HTTP Restful API Server Example
 
@@ -27,6 +27,9 @@
 #include "lwip/apps/netbiosns.h"
 #include "esp_mac.h"
 #include "protocol_examples_common.h"
+#include "web_assets.h"
+#include "boot_prof.h"
+#include "trace_log.h"
 #if CONFIG_EXAMPLE_WEB_DEPLOY_SD
 #include "driver/sdmmc_host.h"
 #endif
@@ -64,6 +67,24 @@ static void initialise_mdns(void)
                                      sizeof(serviceTxtData) / sizeof(serviceTxtData[0])));  // 添加mDNS服务
 }
 
+#if CONFIG_WEB_ASSET_IMAGE
+/**
+ * @brief 映射静态资源镜像分区
+ * 
+ * 资源直接从内存映射的flash发送，无需挂载文件系统
+ * @return ESP_OK表示成功，其他值表示失败
+ */
+esp_err_t init_fs(void)
+{
+    esp_err_t ret = web_assets_init(CONFIG_WEB_ASSET_PARTITION_LABEL);  // 映射资源分区
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to map web asset image (%s)", esp_err_to_name(ret));
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+#endif
+
 #if CONFIG_EXAMPLE_WEB_DEPLOY_SEMIHOST
 /**
  * @brief 初始化半主机文件系统
@@ -168,14 +189,24 @@ esp_err_t init_fs(void)
  */
 void app_main(void)
 {
+    boot_prof_start();  // 开始记录启动时间线
+    trace_log_init();  // 初始化跟踪日志，失败时记录被丢弃
     ESP_ERROR_CHECK(nvs_flash_init());  // 初始化NVS
+    boot_prof_mark("nvs_flash_init");
     ESP_ERROR_CHECK(esp_netif_init());  // 初始化网络接口
+    boot_prof_mark("esp_netif_init");
     ESP_ERROR_CHECK(esp_event_loop_create_default());  // 创建默认事件循环
+    boot_prof_mark("event_loop");
     initialise_mdns();  // 初始化mDNS
     netbiosns_init();  // 初始化NetBIOS
     netbiosns_set_name(CONFIG_EXAMPLE_MDNS_HOST_NAME);  // 设置NetBIOS名称
+    boot_prof_mark("mdns_netbios");
 
     ESP_ERROR_CHECK(example_connect());  // 连接到网络
+    boot_prof_mark("example_connect");
     ESP_ERROR_CHECK(init_fs());  // 初始化文件系统
+    boot_prof_mark("init_fs");
     ESP_ERROR_CHECK(start_rest_server(CONFIG_EXAMPLE_WEB_MOUNT_POINT));  // 启动HTTP服务器
+    boot_prof_mark("start_rest_srv");
+    boot_prof_finish();
 }
@@ -1,81 +1,608 @@
 /**
  * @file event_handler.c
  * @brief 事件处理器模块实现
- * 
- * 该模块提供事件处理器的注册、初始化和事件分发功能，
- * 支持最多注册MAX_EVENT_HANDLERS个事件处理函数。
+ *
+ * 该模块维护一张按(event_base, event_id)索引的分发表：
+ * 每个事件基础类型一个表项，表项内按事件ID直接索引处理器链表，
+ * 另有一条匹配所有ID的链表；ESP_EVENT_ANY_BASE的处理器单独一条链表。
+ * 分发时只遍历匹配的链表，开销与匹配的处理器数量成正比，
+ * 处理器数量不设上限。
+ *
+ * 耗时较长的处理器可登记为延迟执行：分发时只把事件数据复制进有界队列，
+ * 由独立的工作任务调用，避免阻塞默认事件循环。每个处理器记录执行耗时，
+ * 延迟处理器另记排队延迟和队列满时丢弃的事件数。
  */
 #include "event_handler.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "freertos/task.h"
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
-#include "esp_mac.h"
-#include "sdkconfig.h"
-#include "esp_event.h"
-#include "esp_wifi.h"
-#include "esp_smartconfig.h"
-
-#define MAX_EVENT_HANDLERS 10
 
 static const char *TAG = "event_handler";
 
-/** 已注册的事件处理器数组 */
-static esp_event_handler_t event_handlers[MAX_EVENT_HANDLERS];      
-/** 当前已注册的事件处理器数量 */
-static int handler_count = 0;
+/** 已注册的处理器 */
+typedef struct handler_node {
+    esp_event_handler_t handler;   // 事件处理函数
+    void *arg;                     // 注册时的参数
+    bool deferred;                 // 是否在工作任务中执行
+    size_t data_size;              // 延迟执行时复制的事件数据长度
+    uint32_t pending;              // 已入队但未执行完的事件数，大于0时不能释放
+    bool removed;                  // 已注销，待分发结束且无排队事件后释放
+    event_handler_stats_t stats;   // 注册信息与执行统计
+    struct handler_node *next;
+} handler_node_t;
+
+/** 工作任务队列中的一个事件 */
+typedef struct {
+    handler_node_t *node;          // 目标处理器
+    esp_event_base_t base;         // 事件基础类型
+    int32_t id;                    // 事件ID
+    int64_t post_us;               // 入队时间戳
+    bool has_data;                 // 事件数据是否非空
+    uint8_t data[CONFIG_EVENT_HANDLER_DEFERRED_DATA_MAX]; // 事件数据副本
+} deferred_event_t;
+
+/** 一个事件基础类型的分发表项 */
+typedef struct base_entry {
+    esp_event_base_t base;         // 事件基础类型
+    bool hooked;                   // 是否已向默认事件循环注册
+    handler_node_t **by_id;        // 按事件ID直接索引的处理器链表
+    int32_t id_count;              // by_id数组长度
+    handler_node_t *any_id;        // 匹配该基础类型所有事件的处理器
+    struct base_entry *next;
+} base_entry_t;
+
+/** 分发表锁（递归锁，允许处理器在分发过程中注册和注销） */
+static SemaphoreHandle_t s_lock = NULL;
+/** 各事件基础类型的表项 */
+static base_entry_t *s_bases = NULL;
+/** 匹配所有事件基础类型的处理器 */
+static handler_node_t *s_any_base = NULL;
+/** 当前分发嵌套深度 */
+static int s_dispatch_depth = 0;
+/** 是否有待释放的已注销处理器 */
+static bool s_sweep_pending = false;
+/** 延迟执行队列，第一次登记延迟处理器时创建 */
+static QueueHandle_t s_worker_queue = NULL;
+/** 延迟执行工作任务 */
+static TaskHandle_t s_worker_task = NULL;
+/** 工作任务正在执行的处理器，仅在持有分发表锁时读写 */
+static handler_node_t *s_executing = NULL;
+/** 等待s_executing执行完的注销调用数 */
+static int s_exec_waiters = 0;
+/** 工作任务执行完一个处理器后按等待数释放 */
+static SemaphoreHandle_t s_exec_done = NULL;
 
 /**
- * @brief 初始化事件处理器模块
- * 
- * 重置事件处理器数组和计数器，将所有处理器指针设为NULL
+ * @brief 查找事件基础类型对应的表项
+ *
+ * @param event_base 事件基础类型
+ * @return base_entry_t* 表项，不存在返回NULL
  */
-void event_handler_init(void)
+static base_entry_t *find_base(esp_event_base_t event_base)
 {
-    /* Initialize event handlers array */
-    for (int i = 0; i < MAX_EVENT_HANDLERS; i++) {
-        event_handlers[i] = NULL;
+    for (base_entry_t *entry = s_bases; entry != NULL; entry = entry->next) {
+        if (entry->base == event_base) {
+            return entry;
+        }
     }
-    handler_count = 0;
+    return NULL;
 }
 
 /**
- * @brief 注册新的事件处理器
- * 
+ * @brief 查找注册组合对应的链表头
+ *
  * @param event_base 事件基础类型
- * @param event_id 要处理的事件ID
- * @param event_handler 事件处理函数指针
- * @param event_handler_arg 传递给事件处理函数的参数
- * 
- * @note 如果已达到最大处理器数量，将记录错误日志
+ * @param event_id 事件ID
+ * @param create 表项或ID槽不存在时是否创建
+ * @return handler_node_t** 链表头指针，不存在或内存不足返回NULL
  */
-void event_handler_register(esp_event_base_t event_base, int32_t event_id,
-                          esp_event_handler_t event_handler, void* event_handler_arg)
+static handler_node_t **find_list(esp_event_base_t event_base, int32_t event_id, bool create)
 {
-    if (handler_count < MAX_EVENT_HANDLERS) {
-        event_handlers[handler_count++] = event_handler;
-        ESP_ERROR_CHECK(esp_event_handler_register(event_base, event_id, event_handler, event_handler_arg));
+    if (event_base == ESP_EVENT_ANY_BASE) {
+        return &s_any_base;
+    }
+
+    base_entry_t *entry = find_base(event_base);
+    if (entry == NULL) {
+        if (!create) {
+            return NULL;
+        }
+        entry = calloc(1, sizeof(*entry));
+        if (entry == NULL) {
+            return NULL;
+        }
+        entry->base = event_base;
+        entry->next = s_bases;
+        s_bases = entry;
+    }
+
+    if (event_id == ESP_EVENT_ANY_ID) {
+        return &entry->any_id;
+    }
+    if (event_id >= entry->id_count) {
+        if (!create) {
+            return NULL;
+        }
+        handler_node_t **by_id = realloc(entry->by_id, (event_id + 1) * sizeof(*by_id));
+        if (by_id == NULL) {
+            return NULL;
+        }
+        memset(&by_id[entry->id_count], 0, (event_id + 1 - entry->id_count) * sizeof(*by_id));
+        entry->by_id = by_id;
+        entry->id_count = event_id + 1;
+    }
+    return &entry->by_id[event_id];
+}
+
+/**
+ * @brief 累计一次执行的耗时
+ *
+ * @param node 处理器
+ * @param exec_us 执行耗时（微秒）
+ */
+static void record_exec(handler_node_t *node, int64_t exec_us)
+{
+    node->stats.calls++;
+    node->stats.exec_total_us += exec_us;
+    if (exec_us > node->stats.exec_max_us) {
+        node->stats.exec_max_us = (uint32_t)exec_us;
+    }
+}
+
+/**
+ * @brief 把事件复制进延迟执行队列，队列满时丢弃并计数
+ *
+ * @param node 延迟处理器
+ * @param event_base 事件基础类型
+ * @param event_id 事件ID
+ * @param event_data 事件数据指针
+ */
+static void defer_event(handler_node_t *node, esp_event_base_t event_base,
+                        int32_t event_id, void *event_data)
+{
+    deferred_event_t item = {
+        .node = node,
+        .base = event_base,
+        .id = event_id,
+        .post_us = esp_timer_get_time(),
+        .has_data = event_data != NULL,
+    };
+    if (event_data != NULL) {
+        memcpy(item.data, event_data, node->data_size);
+    }
+    // 不阻塞默认事件循环
+    if (xQueueSend(s_worker_queue, &item, 0) == pdTRUE) {
+        node->pending++;
     } else {
-        ESP_LOGE(TAG, "Cannot register more event handlers, maximum reached");
+        node->stats.drops++;
+        ESP_LOGW(TAG, "Deferred queue full, dropped %s:%" PRId32, event_base, event_id);
     }
 }
 
 /**
- * @brief 处理事件并分发给所有注册的处理器
- * 
- * @param arg 事件参数
+ * @brief 调用链表中的所有处理器
+ *
+ * @param node 链表头
  * @param event_base 事件基础类型
  * @param event_id 事件ID
  * @param event_data 事件数据指针
- * 
- * 遍历所有已注册的事件处理器并调用它们
+ *
+ * 延迟处理器只入队；直接执行的处理器超过CONFIG_EVENT_HANDLER_SLOW_US时打印警告。
+ */
+static void call_list(handler_node_t *node, esp_event_base_t event_base,
+                      int32_t event_id, void *event_data)
+{
+    for (; node != NULL; node = node->next) {
+        if (node->removed) {
+            continue;
+        }
+        if (node->deferred) {
+            defer_event(node, event_base, event_id, event_data);
+            continue;
+        }
+        int64_t start_us = esp_timer_get_time();
+        node->handler(node->arg, event_base, event_id, event_data);
+        int64_t exec_us = esp_timer_get_time() - start_us;
+        record_exec(node, exec_us);
+        if (exec_us > CONFIG_EVENT_HANDLER_SLOW_US) {
+            ESP_LOGW(TAG, "Handler %p for %s:%" PRId32 " blocked the event loop for %" PRId64 " us",
+                     node->handler, event_base, event_id, exec_us);
+        }
+    }
+}
+
+/**
+ * @brief 从链表中释放已注销且没有排队事件的处理器
+ *
+ * @param head 链表头指针
+ * @return bool 是否仍有已注销但暂不能释放的处理器
+ */
+static bool sweep_list(handler_node_t **head)
+{
+    bool left = false;
+    while (*head != NULL) {
+        handler_node_t *node = *head;
+        if (node->removed && node->pending == 0) {
+            *head = node->next;
+            free(node);
+        } else {
+            left |= node->removed;
+            head = &node->next;
+        }
+    }
+    return left;
+}
+
+/**
+ * @brief 释放已注销的处理器
+ */
+static void sweep_removed(void)
+{
+    bool left = sweep_list(&s_any_base);
+    for (base_entry_t *entry = s_bases; entry != NULL; entry = entry->next) {
+        left |= sweep_list(&entry->any_id);
+        for (int32_t id = 0; id < entry->id_count; id++) {
+            left |= sweep_list(&entry->by_id[id]);
+        }
+    }
+    s_sweep_pending = left;
+}
+
+/**
+ * @brief 默认事件循环的回调，按分发表把事件转给匹配的处理器
+ *
+ * @param arg 事件参数（未使用）
+ * @param event_base 事件基础类型
+ * @param event_id 事件ID
+ * @param event_data 事件数据指针
+ *
+ * 依次调用：精确匹配ID的处理器、匹配该基础类型所有ID的处理器、匹配所有基础类型的处理器。
+ */
+static void event_handler_dispatch(void* arg, esp_event_base_t event_base,
+                                   int32_t event_id, void* event_data)
+{
+    xSemaphoreTakeRecursive(s_lock, portMAX_DELAY);
+    s_dispatch_depth++;
+
+    base_entry_t *entry = find_base(event_base);
+    if (entry != NULL) {
+        if (event_id >= 0 && event_id < entry->id_count) {
+            call_list(entry->by_id[event_id], event_base, event_id, event_data);
+        }
+        call_list(entry->any_id, event_base, event_id, event_data);
+    }
+    call_list(s_any_base, event_base, event_id, event_data);
+
+    if (--s_dispatch_depth == 0 && s_sweep_pending) {
+        sweep_removed();
+    }
+    xSemaphoreGiveRecursive(s_lock);
+}
+
+/**
+ * @brief 延迟执行工作任务，依次执行队列中的事件
+ *
+ * 执行处理器时不持有分发表锁，默认事件循环可继续分发；
+ * 排队计数保证处理器在执行完之前不会被释放。是否已注销的检查与s_executing的设置
+ * 在同一次持锁内完成，注销方据此等待正在执行的调用结束。
+ *
+ * @param arg 未使用
+ */
+static void event_handler_worker(void *arg)
+{
+    deferred_event_t item;
+
+    while (1) {
+        if (xQueueReceive(s_worker_queue, &item, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        handler_node_t *node = item.node;
+
+        xSemaphoreTakeRecursive(s_lock, portMAX_DELAY);
+        bool removed = node->removed;
+        if (!removed) {
+            s_executing = node;
+        }
+        xSemaphoreGiveRecursive(s_lock);
+
+        int64_t start_us = esp_timer_get_time();
+        if (!removed) {
+            node->handler(node->arg, item.base, item.id, item.has_data ? item.data : NULL);
+        }
+        int64_t end_us = esp_timer_get_time();
+
+        xSemaphoreTakeRecursive(s_lock, portMAX_DELAY);
+        s_executing = NULL;
+        for (; s_exec_waiters > 0; s_exec_waiters--) {
+            xSemaphoreGive(s_exec_done);
+        }
+        if (!removed) {
+            int64_t queue_us = start_us - item.post_us;
+            node->stats.queue_total_us += queue_us;
+            if (queue_us > node->stats.queue_max_us) {
+                node->stats.queue_max_us = (uint32_t)queue_us;
+            }
+            record_exec(node, end_us - start_us);
+        }
+        node->pending--;
+        if (node->removed && node->pending == 0) {
+            s_sweep_pending = true;
+        }
+        if (s_dispatch_depth == 0 && s_sweep_pending) {
+            sweep_removed();
+        }
+        xSemaphoreGiveRecursive(s_lock);
+    }
+}
+
+/**
+ * @brief 创建延迟执行队列和工作任务，调用时须持有分发表锁
+ *
+ * @return esp_err_t 成功返回ESP_OK，失败返回ESP_ERR_NO_MEM
  */
-void event_handler_handle(void* arg, esp_event_base_t event_base,
-                        int32_t event_id, void* event_data)
+static esp_err_t start_worker(void)
 {
-    /* Call all registered event handlers */
-    for (int i = 0; i < handler_count; i++) {
-        if (event_handlers[i] != NULL) {
-            event_handlers[i](arg, event_base, event_id, event_data);
+    if (s_worker_queue != NULL) {
+        return ESP_OK;
+    }
+    if (s_exec_done == NULL) {
+        // 计数上限覆盖所有可能同时等待的任务
+        s_exec_done = xSemaphoreCreateCounting(CONFIG_EVENT_HANDLER_QUEUE_LEN, 0);
+        if (s_exec_done == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    QueueHandle_t queue = xQueueCreate(CONFIG_EVENT_HANDLER_QUEUE_LEN, sizeof(deferred_event_t));
+    if (queue == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_worker_queue = queue;
+    if (xTaskCreate(event_handler_worker, "event_worker", CONFIG_EVENT_HANDLER_WORKER_STACK_SIZE,
+                    NULL, CONFIG_EVENT_HANDLER_WORKER_PRIORITY, &s_worker_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create deferred event worker");
+        s_worker_queue = NULL;
+        vQueueDelete(queue);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 初始化事件分发表
+ *
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t event_handler_init(void)
+{
+    if (s_lock != NULL) {
+        return ESP_OK;
+    }
+    s_lock = xSemaphoreCreateRecursiveMutex();
+    if (s_lock == NULL) {
+        ESP_LOGE(TAG, "Failed to create dispatch table lock");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 把处理器登记到分发表
+ *
+ * @param event_base 事件基础类型
+ * @param event_id 事件ID
+ * @param event_handler 事件处理函数
+ * @param event_handler_arg 传递给事件处理函数的参数
+ * @param deferred 是否在工作任务中执行
+ * @param data_size 延迟执行时复制的事件数据长度
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+static esp_err_t register_node(esp_event_base_t event_base, int32_t event_id,
+                               esp_event_handler_t event_handler, void* event_handler_arg,
+                               bool deferred, size_t data_size)
+{
+    if (event_handler == NULL || event_id < ESP_EVENT_ANY_ID ||
+        (event_base == ESP_EVENT_ANY_BASE && event_id != ESP_EVENT_ANY_ID)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // 新的事件基础类型先挂接到默认事件循环。esp_event调用处理器时持有循环自身的锁，
+    // 因此不能在持有分发表锁时注册；重复注册同一回调只会更新参数，并发挂接无害。
+    if (event_base != ESP_EVENT_ANY_BASE) {
+        xSemaphoreTakeRecursive(s_lock, portMAX_DELAY);
+        base_entry_t *entry = find_base(event_base);
+        bool hooked = entry != NULL && entry->hooked;
+        xSemaphoreGiveRecursive(s_lock);
+        if (!hooked) {
+            esp_err_t ret = esp_event_handler_register(event_base, ESP_EVENT_ANY_ID,
+                                                       &event_handler_dispatch, NULL);
+            if (ret != ESP_OK) {
+                ESP_LOGE(TAG, "Failed to hook %s into the default event loop: %d", event_base, ret);
+                return ret;
+            }
+        }
+    }
+
+    handler_node_t *node = calloc(1, sizeof(*node));
+    if (node == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    node->handler = event_handler;
+    node->arg = event_handler_arg;
+    node->deferred = deferred;
+    node->data_size = data_size;
+    node->stats.base = event_base;
+    node->stats.id = event_id;
+    node->stats.handler = event_handler;
+    node->stats.deferred = deferred;
+
+    xSemaphoreTakeRecursive(s_lock, portMAX_DELAY);
+    esp_err_t ret = deferred ? start_worker() : ESP_OK;
+    handler_node_t **head = ret == ESP_OK ? find_list(event_base, event_id, true) : NULL;
+    if (ret == ESP_OK && head == NULL) {
+        ret = ESP_ERR_NO_MEM;
+    }
+    if (head != NULL) {
+        // 追加到链表尾，保持注册顺序
+        for (; *head != NULL; head = &(*head)->next) {
+            if (!(*head)->removed && (*head)->handler == event_handler &&
+                (*head)->arg == event_handler_arg) {
+                ret = ESP_ERR_INVALID_STATE;
+                break;
+            }
+        }
+        if (ret == ESP_OK) {
+            *head = node;
+        }
+    }
+    if (event_base != ESP_EVENT_ANY_BASE) {
+        base_entry_t *entry = find_base(event_base);
+        if (entry != NULL) {
+            entry->hooked = true;
+        }
+    }
+    xSemaphoreGiveRecursive(s_lock);
+
+    if (ret != ESP_OK) {
+        free(node);
+    }
+    return ret;
+}
+
+/**
+ * @brief 注册事件处理器
+ *
+ * @param event_base 事件基础类型
+ * @param event_id 事件ID
+ * @param event_handler 事件处理函数
+ * @param event_handler_arg 传递给事件处理函数的参数
+ * @return esp_err_t 成功返回ESP_OK；同一组合已注册返回ESP_ERR_INVALID_STATE
+ */
+esp_err_t event_handler_register(esp_event_base_t event_base, int32_t event_id,
+                                 esp_event_handler_t event_handler, void* event_handler_arg)
+{
+    return register_node(event_base, event_id, event_handler, event_handler_arg, false, 0);
+}
+
+/**
+ * @brief 注册在工作任务中执行的事件处理器
+ *
+ * @param event_base 事件基础类型
+ * @param event_id 事件ID
+ * @param event_handler 事件处理函数
+ * @param event_handler_arg 传递给事件处理函数的参数
+ * @param data_size 事件数据长度，事件数据非空时复制该长度
+ * @return esp_err_t 成功返回ESP_OK；data_size超过CONFIG_EVENT_HANDLER_DEFERRED_DATA_MAX返回ESP_ERR_INVALID_SIZE
+ */
+esp_err_t event_handler_register_deferred(esp_event_base_t event_base, int32_t event_id,
+                                          esp_event_handler_t event_handler, void* event_handler_arg,
+                                          size_t data_size)
+{
+    if (data_size > CONFIG_EVENT_HANDLER_DEFERRED_DATA_MAX) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return register_node(event_base, event_id, event_handler, event_handler_arg, true, data_size);
+}
+
+/**
+ * @brief 注销事件处理器
+ *
+ * @param event_base 事件基础类型
+ * @param event_id 事件ID
+ * @param event_handler 事件处理函数
+ * @param event_handler_arg 注册时的参数
+ * @return esp_err_t 成功返回ESP_OK；未找到返回ESP_ERR_NOT_FOUND
+ *
+ * 分发过程中注销或仍有排队事件的处理器先做标记，分发结束且排队事件执行完后再释放，
+ * 避免破坏正在遍历的链表；已排队但尚未执行的事件被丢弃。
+ * 在处理函数之外调用时，若工作任务正在执行该处理器，释放分发表锁并等待其返回；
+ * 在处理函数内调用时等待可能造成死锁，因此不等待。
+ */
+esp_err_t event_handler_unregister(esp_event_base_t event_base, int32_t event_id,
+                                   esp_event_handler_t event_handler, void* event_handler_arg)
+{
+    if (s_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    bool wait = false;
+    xSemaphoreTakeRecursive(s_lock, portMAX_DELAY);
+    handler_node_t **head = find_list(event_base, event_id, false);
+    for (; head != NULL && *head != NULL; head = &(*head)->next) {
+        handler_node_t *node = *head;
+        if (node->removed || node->handler != event_handler || node->arg != event_handler_arg) {
+            continue;
+        }
+        // 分发中持有的锁无法在此释放，工作任务内注销自身也不能等待自己
+        wait = node == s_executing && s_dispatch_depth == 0 &&
+               xTaskGetCurrentTaskHandle() != s_worker_task;
+        if (s_dispatch_depth > 0 || node->pending > 0) {
+            node->removed = true;
+            s_sweep_pending = true;
+        } else {
+            *head = node->next;
+            free(node);
+        }
+        ret = ESP_OK;
+        if (wait) {
+            // 执行中的调用持有pending，节点此时只做了标记，指针比较有效
+            while (s_executing == node) {
+                s_exec_waiters++;
+                xSemaphoreGiveRecursive(s_lock);
+                xSemaphoreTake(s_exec_done, portMAX_DELAY);
+                xSemaphoreTakeRecursive(s_lock, portMAX_DELAY);
+            }
+        }
+        break;
+    }
+    xSemaphoreGiveRecursive(s_lock);
+    return ret;
+}
+
+/**
+ * @brief 读取各处理器的注册信息与执行统计
+ *
+ * @param stats 输出数组
+ * @param max_count 数组长度
+ * @return size_t 已注册的处理器总数，可能大于max_count
+ */
+size_t event_handler_get_stats(event_handler_stats_t *stats, size_t max_count)
+{
+    if (s_lock == NULL) {
+        return 0;
+    }
+
+    size_t count = 0;
+    xSemaphoreTakeRecursive(s_lock, portMAX_DELAY);
+    for (base_entry_t *entry = s_bases; entry != NULL; entry = entry->next) {
+        for (int32_t id = 0; id < entry->id_count; id++) {
+            for (handler_node_t *node = entry->by_id[id]; node != NULL; node = node->next) {
+                if (!node->removed && count++ < max_count) {
+                    stats[count - 1] = node->stats;
+                }
+            }
+        }
+        for (handler_node_t *node = entry->any_id; node != NULL; node = node->next) {
+            if (!node->removed && count++ < max_count) {
+                stats[count - 1] = node->stats;
+            }
+        }
+    }
+    for (handler_node_t *node = s_any_base; node != NULL; node = node->next) {
+        if (!node->removed && count++ < max_count) {
+            stats[count - 1] = node->stats;
         }
     }
+    xSemaphoreGiveRecursive(s_lock);
+    return count;
 }
@@ -0,0 +1,288 @@
+/**
+ * @file i2c_bus.c
+ * @brief I2C总线管理器
+ *
+ * 每个端口一个管理任务，按优先级从各自的队列中取出事务并串行执行，
+ * 完成后通过回调或任务通知返回结果。调用者不再阻塞在i2c_master_cmd_begin中，
+ * 多个驱动和任务共享同一总线时也不会交错或相互等待超时。
+ * 管理任务以较高优先级运行，低优先级任务提交的事务不会阻塞高优先级任务（避免优先级反转）。
+ */
+#include <stdio.h>
+#include <string.h>
+#include "i2c_bus.h"
+#include "i2c_driver.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "sdkconfig.h"
+
+// 日志标签
+static const char *TAG = "I2C_BUS";
+
+/** 单个端口的总线管理器 */
+typedef struct {
+    TaskHandle_t task;                          // 管理任务
+    QueueHandle_t queues[I2C_BUS_PRIO_MAX];     // 各优先级的事务队列（元素为事务指针）
+    SemaphoreHandle_t pending;                  // 待执行事务计数
+    portMUX_TYPE stats_lock;                    // 统计数据锁
+    size_t stats_count;                         // 已登记的设备数
+    i2c_bus_dev_stats_t stats[CONFIG_I2C_BUS_MAX_DEVICES];
+} i2c_bus_t;
+
+static i2c_bus_t s_buses[I2C_NUM_MAX];
+
+static inline i2c_bus_t *bus_get(i2c_port_t i2c_num)
+{
+    return (i2c_num >= 0 && i2c_num < I2C_NUM_MAX) ? &s_buses[i2c_num] : NULL;
+}
+
+/* 更新设备统计，设备数超过上限时忽略新设备 */
+static void bus_account(i2c_bus_t *bus, uint8_t dev_addr, esp_err_t result,
+                        uint32_t busy_us, uint32_t wait_us)
+{
+    portENTER_CRITICAL(&bus->stats_lock);
+    i2c_bus_dev_stats_t *st = NULL;
+    for (size_t i = 0; i < bus->stats_count; i++) {
+        if (bus->stats[i].dev_addr == dev_addr) {
+            st = &bus->stats[i];
+            break;
+        }
+    }
+    if (st == NULL && bus->stats_count < CONFIG_I2C_BUS_MAX_DEVICES) {
+        st = &bus->stats[bus->stats_count++];
+        memset(st, 0, sizeof(*st));
+        st->dev_addr = dev_addr;
+    }
+    if (st != NULL) {
+        st->transactions++;
+        if (result != ESP_OK) {
+            st->errors++;
+        }
+        if (result == ESP_ERR_TIMEOUT) {
+            st->timeouts++;
+        }
+        st->busy_us += busy_us;
+        if (busy_us > st->max_busy_us) {
+            st->max_busy_us = busy_us;
+        }
+        st->wait_us += wait_us;
+        if (wait_us > st->max_wait_us) {
+            st->max_wait_us = wait_us;
+        }
+    }
+    portEXIT_CRITICAL(&bus->stats_lock);
+}
+
+/* 取出优先级最高的待执行事务 */
+static i2c_bus_txn_t *bus_next(i2c_bus_t *bus)
+{
+    i2c_bus_txn_t *txn = NULL;
+    for (int prio = I2C_BUS_PRIO_MAX - 1; prio >= 0; prio--) {
+        if (xQueueReceive(bus->queues[prio], &txn, 0) == pdTRUE) {
+            return txn;
+        }
+    }
+    return NULL;
+}
+
+static void i2c_bus_task(void *arg)
+{
+    i2c_port_t i2c_num = (i2c_port_t)(intptr_t)arg;
+    i2c_bus_t *bus = &s_buses[i2c_num];
+
+    while (1) {
+        // 每个已提交的事务对应一次计数
+        xSemaphoreTake(bus->pending, portMAX_DELAY);
+        i2c_bus_txn_t *txn = bus_next(bus);
+        if (txn == NULL) {
+            continue;
+        }
+
+        int64_t start_us = esp_timer_get_time();
+        esp_err_t result = my_i2c_master_transfer(i2c_num, txn->dev_addr,
+                                                  txn->write_data, txn->write_len,
+                                                  txn->read_data, txn->read_len,
+                                                  txn->timeout_ms ? txn->timeout_ms : I2C_DRIVER_TIMEOUT_MS);
+        int64_t end_us = esp_timer_get_time();
+        bus_account(bus, txn->dev_addr, result,
+                    (uint32_t)(end_us - start_us), (uint32_t)(start_us - txn->submit_us));
+
+        // 回调返回后事务可能已被释放，先取出通知参数
+        TaskHandle_t notify_task = txn->notify_task;
+        uint32_t notify_bits = txn->notify_bits;
+        txn->result = result;
+        if (txn->cb != NULL) {
+            txn->cb(txn, result, txn->cb_arg);
+        }
+        if (notify_task != NULL) {
+            xTaskNotify(notify_task, notify_bits, eSetBits);
+        }
+    }
+}
+
+/**
+ * @brief 启动指定端口的总线管理任务
+ *
+ * @param i2c_num I2C端口号
+ * @return esp_err_t 成功返回ESP_OK；已启动返回ESP_ERR_INVALID_STATE；内存不足返回ESP_ERR_NO_MEM
+ */
+esp_err_t i2c_bus_start(i2c_port_t i2c_num)
+{
+    i2c_bus_t *bus = bus_get(i2c_num);
+    if (bus == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (bus->task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    memset(bus, 0, sizeof(*bus));
+    bus->stats_lock = (portMUX_TYPE)portMUX_INITIALIZER_UNLOCKED;
+    bus->pending = xSemaphoreCreateCounting(I2C_BUS_PRIO_MAX * CONFIG_I2C_BUS_QUEUE_LEN, 0);
+    if (bus->pending == NULL) {
+        goto err;
+    }
+    for (int prio = 0; prio < I2C_BUS_PRIO_MAX; prio++) {
+        bus->queues[prio] = xQueueCreate(CONFIG_I2C_BUS_QUEUE_LEN, sizeof(i2c_bus_txn_t *));
+        if (bus->queues[prio] == NULL) {
+            goto err;
+        }
+    }
+
+    char name[configMAX_TASK_NAME_LEN];
+    snprintf(name, sizeof(name), "i2c_bus%d", (int)i2c_num);
+    if (xTaskCreate(i2c_bus_task, name, CONFIG_I2C_BUS_TASK_STACK_SIZE, (void *)(intptr_t)i2c_num,
+                    CONFIG_I2C_BUS_TASK_PRIORITY, &bus->task) != pdPASS) {
+        bus->task = NULL;
+        goto err;
+    }
+
+    ESP_LOGI(TAG, "I2C端口 %d 总线管理任务已启动", (int)i2c_num);
+    return ESP_OK;
+
+err:
+    for (int prio = 0; prio < I2C_BUS_PRIO_MAX; prio++) {
+        if (bus->queues[prio] != NULL) {
+            vQueueDelete(bus->queues[prio]);
+            bus->queues[prio] = NULL;
+        }
+    }
+    if (bus->pending != NULL) {
+        vSemaphoreDelete(bus->pending);
+        bus->pending = NULL;
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+/**
+ * @brief 查询指定端口的总线管理任务是否运行
+ *
+ * @param i2c_num I2C端口号
+ * @return bool 运行中返回true
+ */
+bool i2c_bus_is_running(i2c_port_t i2c_num)
+{
+    i2c_bus_t *bus = bus_get(i2c_num);
+    return bus != NULL && bus->task != NULL;
+}
+
+/**
+ * @brief 当前任务是否为指定端口的总线管理任务
+ *
+ * @param i2c_num I2C端口号
+ * @return bool 是返回true
+ */
+bool i2c_bus_in_bus_task(i2c_port_t i2c_num)
+{
+    i2c_bus_t *bus = bus_get(i2c_num);
+    return bus != NULL && bus->task != NULL && bus->task == xTaskGetCurrentTaskHandle();
+}
+
+/**
+ * @brief 异步提交一个事务
+ *
+ * @param i2c_num I2C端口号
+ * @param txn 事务
+ * @param wait 队列满时的最长等待时间
+ * @return esp_err_t 成功返回ESP_OK；队列已满返回ESP_ERR_TIMEOUT；未启动返回ESP_ERR_INVALID_STATE
+ */
+esp_err_t i2c_bus_submit(i2c_port_t i2c_num, i2c_bus_txn_t *txn, TickType_t wait)
+{
+    if (txn == NULL || txn->prio >= I2C_BUS_PRIO_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!i2c_bus_is_running(i2c_num)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    i2c_bus_t *bus = &s_buses[i2c_num];
+    txn->result = ESP_ERR_NOT_FINISHED;
+    txn->submit_us = esp_timer_get_time();
+    if (xQueueSend(bus->queues[txn->prio], &txn, wait) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    xSemaphoreGive(bus->pending);
+    return ESP_OK;
+}
+
+/* 同步事务的完成回调，唤醒等待的任务 */
+static void transfer_done(i2c_bus_txn_t *txn, esp_err_t result, void *arg)
+{
+    xSemaphoreGive((SemaphoreHandle_t)arg);
+}
+
+/**
+ * @brief 同步执行一个事务，阻塞当前任务直到完成
+ *
+ * @param i2c_num I2C端口号
+ * @param txn 事务
+ * @return esp_err_t 事务结果
+ */
+esp_err_t i2c_bus_transfer(i2c_port_t i2c_num, i2c_bus_txn_t *txn)
+{
+    if (txn == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (i2c_bus_in_bus_task(i2c_num)) {
+        // 在管理任务中等待自己会死锁
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // 信号量放在栈上，不使用堆
+    StaticSemaphore_t done_buf;
+    SemaphoreHandle_t done = xSemaphoreCreateBinaryStatic(&done_buf);
+    txn->cb = transfer_done;
+    txn->cb_arg = done;
+    txn->notify_task = NULL;
+
+    esp_err_t ret = i2c_bus_submit(i2c_num, txn, portMAX_DELAY);
+    if (ret == ESP_OK) {
+        xSemaphoreTake(done, portMAX_DELAY);
+        ret = txn->result;
+    }
+    vSemaphoreDelete(done);
+    return ret;
+}
+
+/**
+ * @brief 获取指定端口上各设备的事务统计
+ *
+ * @param i2c_num I2C端口号
+ * @param out 输出数组
+ * @param max 输出数组容量
+ * @return size_t 实际输出的设备数
+ */
+size_t i2c_bus_get_stats(i2c_port_t i2c_num, i2c_bus_dev_stats_t *out, size_t max)
+{
+    i2c_bus_t *bus = bus_get(i2c_num);
+    if (bus == NULL || out == NULL || bus->task == NULL) {
+        return 0;
+    }
+
+    portENTER_CRITICAL(&bus->stats_lock);
+    size_t n = bus->stats_count < max ? bus->stats_count : max;
+    memcpy(out, bus->stats, n * sizeof(*out));
+    portEXIT_CRITICAL(&bus->stats_lock);
+    return n;
+}
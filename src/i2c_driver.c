@@ -1,11 +1,19 @@
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 
 #include "i2c_driver.h"
+#include "i2c_bus.h"
+#include "i2c_sim.h"
+#include "perf_bench.h"
+#include "trace_log.h"
 
 // 日志标签
 static const char *TAG = "I2C_DRIVER";
 
+// 各端口的事务统计
+static i2c_driver_metrics_t s_metrics[I2C_NUM_MAX];
+
 /**
  * @brief 初始化I2C控制器
  * 
@@ -18,6 +26,12 @@ esp_err_t i2c_master_init(i2c_port_t i2c_num, i2c_config_t *config) {
         return ESP_ERR_INVALID_ARG;
     }
     
+#if CONFIG_I2C_SIM
+    // 模拟总线不使用I2C外设
+    ESP_LOGW(TAG, "I2C端口 %lu 使用模拟总线（CONFIG_I2C_SIM）", (unsigned long)i2c_num);
+    return ESP_OK;
+#endif
+    
     // 配置I2C参数
     i2c_config_t i2c_conf = {
         .mode             = I2C_MODE_MASTER,      // 设置I2C工作模式为主机模式
@@ -50,6 +64,107 @@ esp_err_t i2c_master_init(i2c_port_t i2c_num, i2c_config_t *config) {
     return ESP_OK;
 }
 
+/* 在当前任务中执行一次事务，命令链建立在栈上 */
+static esp_err_t i2c_transfer_once(i2c_port_t i2c_num, uint8_t dev_addr,
+                                   const uint8_t *write_data, size_t write_len,
+                                   uint8_t *read_data, size_t read_len, uint32_t timeout_ms) {
+#if CONFIG_I2C_SIM
+    // 模拟总线：由设备模型应答，不访问硬件
+    return i2c_sim_transfer(i2c_num, dev_addr, write_data, write_len, read_data, read_len);
+#endif
+    
+    // 在栈上创建I2C命令链，不使用堆
+    uint8_t link_buf[I2C_DRIVER_LINK_BUF_SIZE];
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(link_buf, sizeof(link_buf));
+    if (cmd == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    // 写阶段，探测时只发送地址和写位
+    if (write_len != 0 || read_len == 0) {
+        i2c_master_start(cmd);
+        i2c_master_write_byte(cmd, (dev_addr << 1) | I2C_MASTER_WRITE, true);
+        if (write_len != 0) {
+            i2c_master_write(cmd, write_data, write_len, true);
+        }
+    }
+    // 读阶段，写阶段之后即为重复起始条件；最后1个字节发送NACK
+    if (read_len != 0) {
+        i2c_master_start(cmd);
+        i2c_master_write_byte(cmd, (dev_addr << 1) | I2C_MASTER_READ, true);
+        i2c_master_read(cmd, read_data, read_len, I2C_MASTER_LAST_NACK);
+    }
+    i2c_master_stop(cmd);
+    
+    // 执行I2C命令，超时至少1个tick，否则短超时在低tick频率下会被截断为0
+    TickType_t ticks = pdMS_TO_TICKS(timeout_ms);
+    esp_err_t ret = i2c_master_cmd_begin(i2c_num, cmd, ticks > 0 ? ticks : 1);
+    
+    // 释放命令链
+    i2c_cmd_link_delete_static(cmd);
+    return ret;
+}
+
+/**
+ * @brief 直接在当前任务中执行一次I2C事务，不经过总线管理器
+ * 
+ * 命令链建立在栈上，不使用堆。write_len和read_len均为0时只发送地址（探测）。
+ * 非探测事务的耗时和结果记入端口统计。
+ * 
+ * @param i2c_num I2C端口号
+ * @param dev_addr 设备地址
+ * @param write_data 要写入的数据
+ * @param write_len 写入长度，0表示不写
+ * @param read_data 存储读取数据的缓冲区
+ * @param read_len 读取长度，0表示不读
+ * @param timeout_ms 超时时间，单位：毫秒
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t my_i2c_master_transfer(i2c_port_t i2c_num, uint8_t dev_addr,
+                                 const uint8_t *write_data, size_t write_len,
+                                 uint8_t *read_data, size_t read_len, uint32_t timeout_ms) {
+    if ((write_len != 0 && write_data == NULL) || (read_len != 0 && read_data == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // 探测在扫描时大量失败属于正常情况，不计入统计
+    if ((write_len == 0 && read_len == 0) || i2c_num < 0 || i2c_num >= I2C_NUM_MAX) {
+        return i2c_transfer_once(i2c_num, dev_addr, write_data, write_len, read_data, read_len, timeout_ms);
+    }
+    
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t ret = i2c_transfer_once(i2c_num, dev_addr, write_data, write_len, read_data, read_len, timeout_ms);
+    i2c_driver_metrics_t *m = &s_metrics[i2c_num];
+    metrics_hist_observe(&m->latency, (uint32_t)(esp_timer_get_time() - start_us));
+    if (ret == ESP_FAIL) {
+        atomic_fetch_add_explicit(&m->nacks, 1, memory_order_relaxed);
+    } else if (ret == ESP_ERR_TIMEOUT) {
+        atomic_fetch_add_explicit(&m->timeouts, 1, memory_order_relaxed);
+    } else if (ret != ESP_OK) {
+        atomic_fetch_add_explicit(&m->errors, 1, memory_order_relaxed);
+    }
+    return ret;
+}
+
+/* 执行一次事务：总线管理器运行时排队交给管理任务，否则直接执行 */
+static esp_err_t i2c_execute(i2c_port_t i2c_num, uint8_t dev_addr,
+                             const uint8_t *write_data, size_t write_len,
+                             uint8_t *read_data, size_t read_len, uint32_t timeout_ms) {
+    if (i2c_bus_is_running(i2c_num) && !i2c_bus_in_bus_task(i2c_num)) {
+        i2c_bus_txn_t txn = {
+            .dev_addr = dev_addr,
+            .write_data = write_data,
+            .write_len = write_len,
+            .read_data = read_data,
+            .read_len = read_len,
+            .timeout_ms = timeout_ms,
+            .prio = I2C_BUS_PRIO_NORMAL,
+        };
+        return i2c_bus_transfer(i2c_num, &txn);
+    }
+    return my_i2c_master_transfer(i2c_num, dev_addr, write_data, write_len,
+                                  read_data, read_len, timeout_ms);
+}
+
 /**
  * @brief I2C写入数据
  * 
@@ -59,31 +174,17 @@ esp_err_t i2c_master_init(i2c_port_t i2c_num, i2c_config_t *config) {
  * @param data_len 数据长度
  * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
  */
- esp_err_t my_i2c_master_write(i2c_port_t i2c_num, uint8_t dev_addr, 
-                          const uint8_t *data, size_t data_len) {
+esp_err_t my_i2c_master_write(i2c_port_t i2c_num, uint8_t dev_addr,
+                              const uint8_t *data, size_t data_len) {
     // 检查输入参数是否合法，若数据指针为空或数据长度为0，
     // 则认为输入参数无效，返回参数错误码
     if (data == NULL || data_len == 0) {
         return ESP_ERR_INVALID_ARG;
     }
     
-    // 创建I2C命令链
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    i2c_master_start(cmd);
-    // 发送设备地址和写位
-    i2c_master_write_byte(cmd, (dev_addr << 1) | I2C_MASTER_WRITE, true);
-    // 发送数据
-    i2c_master_write(cmd, data, data_len, true);
-    i2c_master_stop(cmd);
-    
-    // 执行I2C命令
-    esp_err_t ret = i2c_master_cmd_begin(i2c_num, cmd, 1000 / portTICK_PERIOD_MS);
-    
-    // 删除命令链
-    i2c_cmd_link_delete(cmd);
-    
+    esp_err_t ret = i2c_execute(i2c_num, dev_addr, data, data_len, NULL, 0, I2C_DRIVER_TIMEOUT_MS);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "I2C写入失败，设备地址: 0x%02X, 错误代码: %d", dev_addr, ret);
+        TRACE_LOG(TRACE_I2C_WRITE_FAIL, i2c_num, dev_addr, ret);
     }
     
     return ret;
@@ -98,37 +199,127 @@ esp_err_t i2c_master_init(i2c_port_t i2c_num, i2c_config_t *config) {
  * @param data_len 要读取的数据长度
  * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
  */
-esp_err_t my_i2c_master_read(i2c_port_t i2c_num, uint8_t dev_addr, 
-                         uint8_t *data, size_t data_len) {
+esp_err_t my_i2c_master_read(i2c_port_t i2c_num, uint8_t dev_addr,
+                             uint8_t *data, size_t data_len) {
     if (data == NULL || data_len == 0) {
         return ESP_ERR_INVALID_ARG;
     }
     
-    // 创建I2C命令链
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    i2c_master_start(cmd);
-    // 发送设备地址和读位
-    i2c_master_write_byte(cmd, (dev_addr << 1) | I2C_MASTER_READ, true);
+    esp_err_t ret = i2c_execute(i2c_num, dev_addr, NULL, 0, data, data_len, I2C_DRIVER_TIMEOUT_MS);
+    if (ret != ESP_OK) {
+        TRACE_LOG(TRACE_I2C_READ_FAIL, i2c_num, dev_addr, ret);
+    }
     
-    // 读取数据
-    if (data_len > 1) {
-        // 读取前data_len-1个字节，发送ACK
-        i2c_master_read(cmd, data, data_len - 1, I2C_MASTER_ACK);
+    return ret;
+}
+
+/**
+ * @brief 先写后读的组合事务，中间使用重复起始条件，不释放总线
+ * 
+ * @param i2c_num I2C端口号
+ * @param dev_addr 设备地址
+ * @param write_data 要写入的数据（通常为命令或寄存器地址）
+ * @param write_len 写入长度
+ * @param read_data 存储读取数据的缓冲区
+ * @param read_len 读取长度
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t my_i2c_master_write_read(i2c_port_t i2c_num, uint8_t dev_addr,
+                                   const uint8_t *write_data, size_t write_len,
+                                   uint8_t *read_data, size_t read_len) {
+    if (write_data == NULL || write_len == 0 || read_data == NULL || read_len == 0) {
+        return ESP_ERR_INVALID_ARG;
     }
-    // 读取最后1个字节，发送NACK
-    i2c_master_read_byte(cmd, &data[data_len - 1], I2C_MASTER_NACK);
     
-    i2c_master_stop(cmd);
+    esp_err_t ret = i2c_execute(i2c_num, dev_addr, write_data, write_len,
+                                read_data, read_len, I2C_DRIVER_TIMEOUT_MS);
+    if (ret != ESP_OK) {
+        TRACE_LOG(TRACE_I2C_WRITE_READ_FAIL, i2c_num, dev_addr, ret);
+    }
+    
+    return ret;
+}
+
+/**
+ * @brief 探测总线上指定地址是否有设备应答
+ * 
+ * 只发送地址和写位，失败时不输出日志，适合用于总线扫描。
+ * 
+ * @param i2c_num I2C端口号
+ * @param dev_addr 设备地址
+ * @param timeout_ms 超时时间，单位：毫秒
+ * @return esp_err_t 设备应答返回ESP_OK，否则返回相应错误码
+ */
+esp_err_t my_i2c_master_probe(i2c_port_t i2c_num, uint8_t dev_addr, uint32_t timeout_ms) {
+    return i2c_execute(i2c_num, dev_addr, NULL, 0, NULL, 0, timeout_ms);
+}
+
+/**
+ * @brief 获取端口的事务统计，统计以原子计数器记录，可随时读取
+ * 
+ * @param i2c_num I2C端口号
+ * @return const i2c_driver_metrics_t* 端口号无效时返回NULL
+ */
+const i2c_driver_metrics_t *i2c_driver_get_metrics(i2c_port_t i2c_num) {
+    if (i2c_num < 0 || i2c_num >= I2C_NUM_MAX) {
+        return NULL;
+    }
+    return &s_metrics[i2c_num];
+}
+
+#if CONFIG_PERF_BENCHMARKS
+// 每项测量的迭代次数
+#define I2C_BENCH_ITERATIONS 200
+
+/**
+ * @brief 对比堆分配命令链与栈上命令链的事务耗时和堆操作次数
+ * 
+ * @param i2c_num I2C端口号，需已初始化
+ * @param dev_addr 用于测试的设备地址，需在总线上
+ */
+void i2c_driver_benchmark(i2c_port_t i2c_num, uint8_t dev_addr) {
+    perf_bench_t bench;
+    uint8_t data[6];
+    const uint8_t status_cmd = 0x71;
+    
+#if !CONFIG_I2C_SIM
+    // 直接使用驱动的命令链，模拟总线下无法执行
+    perf_bench_begin(&bench, "I2C读6字节（i2c_cmd_link_create）");
+    for (int i = 0; i < I2C_BENCH_ITERATIONS; i++) {
+        i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+        i2c_master_start(cmd);
+        i2c_master_write_byte(cmd, (dev_addr << 1) | I2C_MASTER_READ, true);
+        i2c_master_read(cmd, data, sizeof(data), I2C_MASTER_LAST_NACK);
+        i2c_master_stop(cmd);
+        i2c_master_cmd_begin(i2c_num, cmd, pdMS_TO_TICKS(I2C_DRIVER_TIMEOUT_MS));
+        i2c_cmd_link_delete(cmd);
+    }
+    perf_bench_end(&bench, I2C_BENCH_ITERATIONS);
+#endif
     
-    // 执行I2C命令
-    esp_err_t ret = i2c_master_cmd_begin(i2c_num, cmd, 1000 / portTICK_PERIOD_MS);
+    perf_bench_begin(&bench, "I2C读6字节（my_i2c_master_read）");
+    for (int i = 0; i < I2C_BENCH_ITERATIONS; i++) {
+        my_i2c_master_read(i2c_num, dev_addr, data, sizeof(data));
+    }
+    perf_bench_end(&bench, I2C_BENCH_ITERATIONS);
     
-    // 删除命令链
-    i2c_cmd_link_delete(cmd);
+    perf_bench_begin(&bench, "I2C写1字节+读1字节（分两次事务）");
+    for (int i = 0; i < I2C_BENCH_ITERATIONS; i++) {
+        my_i2c_master_write(i2c_num, dev_addr, &status_cmd, 1);
+        my_i2c_master_read(i2c_num, dev_addr, data, 1);
+    }
+    perf_bench_end(&bench, I2C_BENCH_ITERATIONS);
     
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "I2C读取失败，设备地址: 0x%02X, 错误代码: %d", dev_addr, ret);
+    perf_bench_begin(&bench, "I2C写1字节+读1字节（my_i2c_master_write_read）");
+    for (int i = 0; i < I2C_BENCH_ITERATIONS; i++) {
+        my_i2c_master_write_read(i2c_num, dev_addr, &status_cmd, 1, data, 1);
     }
+    perf_bench_end(&bench, I2C_BENCH_ITERATIONS);
     
-    return ret;
+    perf_bench_begin(&bench, "I2C总线扫描（my_i2c_master_probe）");
+    for (uint8_t addr = 0x01; addr < 0x7F; addr++) {
+        my_i2c_master_probe(i2c_num, addr, 50);
+    }
+    perf_bench_end(&bench, 0x7E);
 }
+#endif
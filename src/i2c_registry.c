@@ -0,0 +1,279 @@
+/**
+ * @file i2c_registry.c
+ * @brief I2C设备发现与设备登记表
+ *
+ * 每个端口用128位位图记录应答的地址。发现时先验证NVS中的上次结果，
+ * 只有缓存缺失或与实际不符时才扫描全部地址；多个端口由各自的任务并行扫描。
+ */
+#include <stdio.h>
+#include <string.h>
+#include "i2c_registry.h"
+#include "i2c_driver.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "sdkconfig.h"
+
+// 日志标签
+static const char *TAG = "I2C_REGISTRY";
+
+// NVS命名空间
+#define REGISTRY_NVS_NAMESPACE "i2c_reg"
+// 并行扫描任务的栈大小
+#define REGISTRY_SCAN_STACK_SIZE 3072
+
+/** 地址位图 */
+typedef struct {
+    uint32_t bits[4];
+} addr_set_t;
+
+/** 单个端口的扫描任务 */
+typedef struct {
+    i2c_port_t port;
+    bool force_full;
+    bool cache_hit;         // 缓存中的设备全部应答
+    addr_set_t found;       // 扫描结果
+    SemaphoreHandle_t done; // 并行扫描完成信号
+} scan_job_t;
+
+static addr_set_t s_present[I2C_NUM_MAX];
+static bool s_scanned[I2C_NUM_MAX];
+
+static inline bool set_has(const addr_set_t *set, uint8_t addr)
+{
+    return set->bits[addr >> 5] & (1u << (addr & 31));
+}
+
+static inline void set_add(addr_set_t *set, uint8_t addr)
+{
+    set->bits[addr >> 5] |= 1u << (addr & 31);
+}
+
+static inline bool set_empty(const addr_set_t *set)
+{
+    return (set->bits[0] | set->bits[1] | set->bits[2] | set->bits[3]) == 0;
+}
+
+static inline bool port_valid(i2c_port_t i2c_num)
+{
+    return i2c_num >= 0 && i2c_num < I2C_NUM_MAX;
+}
+
+static bool probe(i2c_port_t port, uint8_t addr)
+{
+    return my_i2c_master_probe(port, addr, CONFIG_I2C_REGISTRY_PROBE_TIMEOUT_MS) == ESP_OK;
+}
+
+/* 读取缓存的设备列表，不存在时返回空集合 */
+static void cache_load(i2c_port_t port, addr_set_t *set)
+{
+    memset(set, 0, sizeof(*set));
+    nvs_handle_t handle;
+    if (nvs_open(REGISTRY_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return;
+    }
+    char key[8];
+    snprintf(key, sizeof(key), "port%d", (int)port);
+    size_t len = sizeof(set->bits);
+    if (nvs_get_blob(handle, key, set->bits, &len) != ESP_OK || len != sizeof(set->bits)) {
+        memset(set, 0, sizeof(*set));
+    }
+    nvs_close(handle);
+}
+
+static void cache_store(i2c_port_t port, const addr_set_t *set)
+{
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(REGISTRY_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "无法打开NVS，设备列表未缓存，错误代码: %d", ret);
+        return;
+    }
+    char key[8];
+    snprintf(key, sizeof(key), "port%d", (int)port);
+    ret = nvs_set_blob(handle, key, set->bits, sizeof(set->bits));
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "保存设备列表失败，错误代码: %d", ret);
+    }
+    nvs_close(handle);
+}
+
+/* 扫描一个端口：先验证缓存，不符时扫描全部地址 */
+static void scan_port(scan_job_t *job)
+{
+    addr_set_t cached;
+    cache_load(job->port, &cached);
+    memset(&job->found, 0, sizeof(job->found));
+    job->cache_hit = false;
+
+    if (!job->force_full && !set_empty(&cached)) {
+        job->cache_hit = true;
+        for (uint8_t addr = I2C_REGISTRY_ADDR_MIN; addr <= I2C_REGISTRY_ADDR_MAX; addr++) {
+            if (set_has(&cached, addr) && !probe(job->port, addr)) {
+                job->cache_hit = false;
+                break;
+            }
+        }
+        if (job->cache_hit) {
+            job->found = cached;
+            return;
+        }
+    }
+
+    for (uint8_t addr = I2C_REGISTRY_ADDR_MIN; addr <= I2C_REGISTRY_ADDR_MAX; addr++) {
+        if (probe(job->port, addr)) {
+            set_add(&job->found, addr);
+        }
+    }
+    if (memcmp(&job->found, &cached, sizeof(cached)) != 0) {
+        cache_store(job->port, &job->found);
+    }
+}
+
+static void scan_task(void *arg)
+{
+    scan_job_t *job = arg;
+    scan_port(job);
+    xSemaphoreGive(job->done);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 发现总线上的设备并建立设备登记表
+ *
+ * @param ports 已初始化的I2C端口
+ * @param port_count 端口数
+ * @param force_full 是否忽略缓存强制完整扫描
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t i2c_registry_discover(const i2c_port_t *ports, size_t port_count, bool force_full)
+{
+    if (ports == NULL || port_count == 0 || port_count > I2C_NUM_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < port_count; i++) {
+        if (!port_valid(ports[i])) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    scan_job_t jobs[I2C_NUM_MAX];
+    StaticSemaphore_t done_buf;
+    SemaphoreHandle_t done = xSemaphoreCreateCountingStatic(I2C_NUM_MAX, 0, &done_buf);
+
+    // 第一个端口在当前任务中扫描，其余端口各起一个任务并行扫描
+    size_t spawned = 0;
+    for (size_t i = 0; i < port_count; i++) {
+        jobs[i].port = ports[i];
+        jobs[i].force_full = force_full;
+        jobs[i].done = done;
+    }
+    for (size_t i = 1; i < port_count; i++) {
+        char name[configMAX_TASK_NAME_LEN];
+        snprintf(name, sizeof(name), "i2c_scan%d", (int)ports[i]);
+        if (xTaskCreate(scan_task, name, REGISTRY_SCAN_STACK_SIZE, &jobs[i],
+                        uxTaskPriorityGet(NULL), NULL) == pdPASS) {
+            spawned++;
+        } else {
+            // 无法创建任务时退化为串行扫描
+            scan_port(&jobs[i]);
+            xSemaphoreGive(done);
+            spawned++;
+        }
+    }
+    scan_port(&jobs[0]);
+    for (size_t i = 0; i < spawned; i++) {
+        xSemaphoreTake(done, portMAX_DELAY);
+    }
+    vSemaphoreDelete(done);
+
+    for (size_t i = 0; i < port_count; i++) {
+        s_present[jobs[i].port] = jobs[i].found;
+        s_scanned[jobs[i].port] = true;
+
+        uint8_t addrs[I2C_REGISTRY_ADDR_MAX];
+        size_t n = i2c_registry_list(jobs[i].port, addrs, sizeof(addrs));
+        ESP_LOGI(TAG, "I2C端口 %d 发现 %u 个设备（%s）", (int)jobs[i].port, (unsigned)n,
+                 jobs[i].cache_hit ? "缓存命中" : "完整扫描");
+        for (size_t k = 0; k < n; k++) {
+            ESP_LOGI(TAG, "  设备: 0x%02X", addrs[k]);
+        }
+    }
+    ESP_LOGI(TAG, "设备发现耗时 %lld us", (long long)(esp_timer_get_time() - start_us));
+    return ESP_OK;
+}
+
+/**
+ * @brief 指定端口是否已完成发现
+ *
+ * @param i2c_num I2C端口号
+ * @return bool 已完成返回true
+ */
+bool i2c_registry_scanned(i2c_port_t i2c_num)
+{
+    return port_valid(i2c_num) && s_scanned[i2c_num];
+}
+
+/**
+ * @brief 查询指定端口上的地址是否有设备
+ *
+ * @param i2c_num I2C端口号
+ * @param dev_addr 设备地址
+ * @return bool 有设备返回true；未扫描的端口返回false
+ */
+bool i2c_registry_has(i2c_port_t i2c_num, uint8_t dev_addr)
+{
+    return i2c_registry_scanned(i2c_num) && dev_addr < 0x80 && set_has(&s_present[i2c_num], dev_addr);
+}
+
+/**
+ * @brief 在所有已扫描端口中查找设备
+ *
+ * @param dev_addr 设备地址
+ * @param i2c_num 输出找到设备的端口，可为NULL
+ * @return esp_err_t 找到返回ESP_OK，否则返回ESP_ERR_NOT_FOUND
+ */
+esp_err_t i2c_registry_find(uint8_t dev_addr, i2c_port_t *i2c_num)
+{
+    for (int port = 0; port < I2C_NUM_MAX; port++) {
+        if (i2c_registry_has(port, dev_addr)) {
+            if (i2c_num != NULL) {
+                *i2c_num = port;
+            }
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+/**
+ * @brief 列出指定端口上的设备地址
+ *
+ * @param i2c_num I2C端口号
+ * @param out 输出数组，按地址升序
+ * @param max 输出数组容量
+ * @return size_t 设备总数（可能大于max）
+ */
+size_t i2c_registry_list(i2c_port_t i2c_num, uint8_t *out, size_t max)
+{
+    if (!i2c_registry_scanned(i2c_num)) {
+        return 0;
+    }
+    size_t n = 0;
+    for (uint8_t addr = I2C_REGISTRY_ADDR_MIN; addr <= I2C_REGISTRY_ADDR_MAX; addr++) {
+        if (set_has(&s_present[i2c_num], addr)) {
+            if (out != NULL && n < max) {
+                out[n] = addr;
+            }
+            n++;
+        }
+    }
+    return n;
+}
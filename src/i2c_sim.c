@@ -0,0 +1,364 @@
+/**
+ * @file i2c_sim.c
+ * @brief 模拟I2C总线与AHT10模型
+ *
+ * 开启CONFIG_I2C_SIM后，my_i2c_master_transfer不再访问硬件，而是由本模块按设备模型应答，
+ * 因此驱动、总线管理器、采样调度器和HTTP接口在没有传感器的开发板上也能运行和测量。
+ * 模型不依赖I2C外设，只使用esp_timer计时。
+ */
+#include "i2c_sim.h"
+
+#if CONFIG_I2C_SIM
+
+#include <stdlib.h>
+#include <string.h>
+#include "aht10.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "perf_bench.h"
+#include "i2c_driver.h"
+
+// 日志标签
+static const char *TAG = "I2C_SIM";
+
+// 模拟设备数上限
+#define I2C_SIM_MAX_DEVICES 4
+
+/** AHT10模型 */
+typedef struct {
+    bool used;
+    i2c_port_t port;
+    uint8_t addr;
+    bool calibrated;            // 校准位
+    int64_t busy_until_us;      // 转换结束时间
+    int16_t temp_centi;         // 设定温度
+    uint16_t hum_centi;         // 设定湿度
+    uint8_t frame[AHT10_FRAME_LEN]; // 最近一次转换的测量帧
+    uint32_t noise;             // 抖动用线性同余状态
+    i2c_sim_fault_t fault;      // 注入的故障
+    uint32_t fault_count;       // 剩余故障次数
+} sim_aht10_t;
+
+static sim_aht10_t s_devices[I2C_SIM_MAX_DEVICES];
+static uint32_t s_conversion_us = CONFIG_I2C_SIM_CONVERSION_MS * 1000;
+static i2c_sim_stats_t s_stats;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static sim_aht10_t *sim_find(i2c_port_t port, uint8_t addr)
+{
+    for (int i = 0; i < I2C_SIM_MAX_DEVICES; i++) {
+        if (s_devices[i].used && s_devices[i].port == port && s_devices[i].addr == addr) {
+            return &s_devices[i];
+        }
+    }
+    return NULL;
+}
+
+/* 按设定值加抖动生成一帧，编码为AHT10的20位原始值 */
+static void sim_convert(sim_aht10_t *dev)
+{
+    dev->noise = dev->noise * 1664525u + 1013904223u;
+    int32_t temp = dev->temp_centi + (int32_t)((dev->noise >> 24) % 11) - 5;
+    int32_t hum = dev->hum_centi + (int32_t)((dev->noise >> 16) % 11) - 5;
+    if (temp < -5000) temp = -5000;
+    if (temp > 14999) temp = 14999;
+    if (hum < 0) hum = 0;
+    if (hum > 9999) hum = 9999;
+
+    // 与aht10_decode_frame互逆：raw = 值 * 2^20 / 量程
+    uint32_t temp_raw = (uint32_t)(((uint64_t)(temp + 5000) << 20) / 20000);
+    uint32_t hum_raw = (uint32_t)(((uint64_t)hum << 20) / 10000);
+    dev->frame[1] = hum_raw >> 12;
+    dev->frame[2] = hum_raw >> 4;
+    dev->frame[3] = ((hum_raw & 0x0F) << 4) | ((temp_raw >> 16) & 0x0F);
+    dev->frame[4] = temp_raw >> 8;
+    dev->frame[5] = temp_raw;
+}
+
+/* 消耗一次注入的故障，返回当前事务应表现的故障 */
+static i2c_sim_fault_t sim_take_fault(sim_aht10_t *dev, bool reading)
+{
+    if (dev->fault_count == 0) {
+        return I2C_SIM_FAULT_NONE;
+    }
+    if (dev->fault == I2C_SIM_FAULT_BUSY_FRAME && !reading) {
+        return I2C_SIM_FAULT_NONE;
+    }
+    dev->fault_count--;
+    return dev->fault;
+}
+
+/**
+ * @brief 在模拟总线上添加一个AHT10模型
+ *
+ * @param i2c_num I2C端口号
+ * @param dev_addr 设备地址
+ * @return esp_err_t 成功返回ESP_OK；设备数已满返回ESP_ERR_NO_MEM
+ */
+esp_err_t i2c_sim_add_aht10(i2c_port_t i2c_num, uint8_t dev_addr)
+{
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    portENTER_CRITICAL(&s_lock);
+    if (sim_find(i2c_num, dev_addr) != NULL) {
+        ret = ESP_ERR_INVALID_STATE;
+    } else {
+        for (int i = 0; i < I2C_SIM_MAX_DEVICES; i++) {
+            if (!s_devices[i].used) {
+                sim_aht10_t *dev = &s_devices[i];
+                memset(dev, 0, sizeof(*dev));
+                dev->used = true;
+                dev->port = i2c_num;
+                dev->addr = dev_addr;
+                dev->temp_centi = 2350;
+                dev->hum_centi = 4500;
+                dev->noise = 0x9E3779B9u ^ ((uint32_t)i2c_num << 8) ^ dev_addr;
+                sim_convert(dev);
+                ret = ESP_OK;
+                break;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "模拟AHT10: 端口 %d，地址 0x%02X", (int)i2c_num, dev_addr);
+    }
+    return ret;
+}
+
+/**
+ * @brief 设置AHT10模型的测量值
+ *
+ * @param i2c_num I2C端口号
+ * @param dev_addr 设备地址
+ * @param temp_centi 温度，单位：0.01℃
+ * @param hum_centi 湿度，单位：0.01%
+ * @return esp_err_t 成功返回ESP_OK；设备不存在返回ESP_ERR_NOT_FOUND
+ */
+esp_err_t i2c_sim_aht10_set(i2c_port_t i2c_num, uint8_t dev_addr, int16_t temp_centi, uint16_t hum_centi)
+{
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    portENTER_CRITICAL(&s_lock);
+    sim_aht10_t *dev = sim_find(i2c_num, dev_addr);
+    if (dev != NULL) {
+        dev->temp_centi = temp_centi;
+        dev->hum_centi = hum_centi;
+        ret = ESP_OK;
+    }
+    portEXIT_CRITICAL(&s_lock);
+    return ret;
+}
+
+/**
+ * @brief 设置测量转换时间
+ *
+ * @param conversion_us 转换时间，单位：微秒
+ */
+void i2c_sim_set_conversion_us(uint32_t conversion_us)
+{
+    s_conversion_us = conversion_us;
+}
+
+/**
+ * @brief 对指定设备注入故障
+ *
+ * @param i2c_num I2C端口号
+ * @param dev_addr 设备地址
+ * @param fault 故障类型
+ * @param count 影响的事务数
+ * @return esp_err_t 成功返回ESP_OK；设备不存在返回ESP_ERR_NOT_FOUND
+ */
+esp_err_t i2c_sim_inject(i2c_port_t i2c_num, uint8_t dev_addr, i2c_sim_fault_t fault, uint32_t count)
+{
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    portENTER_CRITICAL(&s_lock);
+    sim_aht10_t *dev = sim_find(i2c_num, dev_addr);
+    if (dev != NULL) {
+        dev->fault = fault;
+        dev->fault_count = fault == I2C_SIM_FAULT_NONE ? 0 : count;
+        ret = ESP_OK;
+    }
+    portEXIT_CRITICAL(&s_lock);
+    return ret;
+}
+
+/**
+ * @brief 在模拟总线上执行一次事务
+ *
+ * 写入首字节按AHT10命令解释：0xE1初始化（置位校准位）、0xAC触发测量、0xBA软复位。
+ * 读取返回状态字节及最近一次转换的测量帧。
+ *
+ * @return esp_err_t 成功返回ESP_OK；无设备或注入NACK返回ESP_FAIL；注入超时返回ESP_ERR_TIMEOUT
+ */
+esp_err_t i2c_sim_transfer(i2c_port_t i2c_num, uint8_t dev_addr,
+                           const uint8_t *write_data, size_t write_len,
+                           uint8_t *read_data, size_t read_len)
+{
+    int64_t now_us = esp_timer_get_time();
+    esp_err_t ret = ESP_OK;
+
+    portENTER_CRITICAL(&s_lock);
+    s_stats.transactions++;
+    sim_aht10_t *dev = sim_find(i2c_num, dev_addr);
+    i2c_sim_fault_t fault = dev != NULL ? sim_take_fault(dev, read_len != 0) : I2C_SIM_FAULT_NONE;
+
+    if (dev == NULL || fault == I2C_SIM_FAULT_NACK) {
+        s_stats.nacks++;
+        ret = ESP_FAIL;
+    } else if (fault == I2C_SIM_FAULT_TIMEOUT) {
+        ret = ESP_ERR_TIMEOUT;
+    } else {
+        if (write_len != 0) {
+            switch (write_data[0]) {
+            case AHT10_CMD_INIT:
+                dev->calibrated = true;
+                break;
+            case AHT10_CMD_MEASURE:
+                dev->busy_until_us = now_us + s_conversion_us;
+                sim_convert(dev);
+                s_stats.conversions++;
+                break;
+            case AHT10_CMD_RESET:
+                dev->calibrated = false;
+                dev->busy_until_us = 0;
+                break;
+            default:
+                break;
+            }
+        }
+        if (read_len != 0) {
+            bool busy = now_us < dev->busy_until_us || fault == I2C_SIM_FAULT_BUSY_FRAME;
+            dev->frame[0] = (busy ? AHT10_STATUS_BUSY : 0) | (dev->calibrated ? AHT10_STATUS_CAL : 0);
+            for (size_t i = 0; i < read_len; i++) {
+                read_data[i] = i < AHT10_FRAME_LEN ? dev->frame[i] : 0xFF;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&s_lock);
+    return ret;
+}
+
+/**
+ * @brief 获取模拟总线统计
+ *
+ * @param stats 输出统计
+ */
+void i2c_sim_get_stats(i2c_sim_stats_t *stats)
+{
+    portENTER_CRITICAL(&s_lock);
+    *stats = s_stats;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+#if CONFIG_PERF_BENCHMARKS
+// 每轮测量的读取次数
+#define SIM_BENCH_READS 1000
+
+static uint32_t s_latency_us[SIM_BENCH_READS];
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+/* 输出吞吐量和延迟分位数 */
+static void report_latency(const char *name, int64_t elapsed_us, uint32_t errors)
+{
+    qsort(s_latency_us, SIM_BENCH_READS, sizeof(s_latency_us[0]), cmp_u32);
+    ESP_LOGI(TAG, "%s: %.0f 次读取/秒, p50 %lu us, p90 %lu us, p99 %lu us, 最大 %lu us, 失败 %lu",
+             name, SIM_BENCH_READS * 1e6 / (elapsed_us > 0 ? elapsed_us : 1),
+             (unsigned long)s_latency_us[SIM_BENCH_READS / 2],
+             (unsigned long)s_latency_us[SIM_BENCH_READS * 9 / 10],
+             (unsigned long)s_latency_us[SIM_BENCH_READS * 99 / 100],
+             (unsigned long)s_latency_us[SIM_BENCH_READS - 1], (unsigned long)errors);
+}
+
+/* 检查一条故障路径的返回值，不符时计入failures */
+static void expect(const char *what, esp_err_t got, esp_err_t want, uint32_t *failures)
+{
+    if (got == want) {
+        ESP_LOGI(TAG, "故障路径 %s: 通过", what);
+    } else {
+        ESP_LOGE(TAG, "故障路径 %s: 失败，期望 %d，实际 %d", what, want, got);
+        (*failures)++;
+    }
+}
+
+/**
+ * @brief 在模拟总线上测量驱动栈的读取吞吐量、延迟分位数和堆操作次数，并验证故障路径
+ *
+ * @param i2c_num 已添加AHT10模型的端口
+ * @param dev_addr AHT10模型地址
+ * @return uint32_t 未通过的故障路径检查数，0表示全部通过
+ */
+uint32_t i2c_sim_benchmark(i2c_port_t i2c_num, uint8_t dev_addr)
+{
+    static const uint8_t measure_cmd[3] = {AHT10_CMD_MEASURE, 0x33, 0x00};
+    perf_bench_t bench;
+    aht10_fixed_t fixed;
+    uint8_t frame[AHT10_FRAME_LEN];
+    uint32_t errors = 0;
+    uint32_t failures = 0;
+
+    // 转换时间设为0，只测量软件开销
+    i2c_sim_set_conversion_us(0);
+
+    perf_bench_begin(&bench, "模拟AHT10读取（my_i2c_master_transfer）");
+    int64_t start_us = esp_timer_get_time();
+    for (int i = 0; i < SIM_BENCH_READS; i++) {
+        int64_t t0 = esp_timer_get_time();
+        esp_err_t ret = my_i2c_master_transfer(i2c_num, dev_addr, measure_cmd, sizeof(measure_cmd),
+                                               NULL, 0, I2C_DRIVER_TIMEOUT_MS);
+        if (ret == ESP_OK) {
+            ret = my_i2c_master_transfer(i2c_num, dev_addr, NULL, 0, frame, sizeof(frame),
+                                         I2C_DRIVER_TIMEOUT_MS);
+        }
+        if (ret == ESP_OK) {
+            ret = aht10_decode_frame(frame, &fixed);
+        }
+        errors += ret != ESP_OK;
+        s_latency_us[i] = (uint32_t)(esp_timer_get_time() - t0);
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    perf_bench_end(&bench, SIM_BENCH_READS);
+    report_latency("直接事务", elapsed_us, errors);
+
+    errors = 0;
+    perf_bench_begin(&bench, "模拟AHT10读取（aht10驱动，经总线管理器）");
+    start_us = esp_timer_get_time();
+    for (int i = 0; i < SIM_BENCH_READS; i++) {
+        int64_t t0 = esp_timer_get_time();
+        esp_err_t ret = aht10_trigger_measurement_at(i2c_num, dev_addr);
+        if (ret == ESP_OK) {
+            ret = aht10_collect_fixed_at(i2c_num, dev_addr, &fixed);
+        }
+        errors += ret != ESP_OK;
+        s_latency_us[i] = (uint32_t)(esp_timer_get_time() - t0);
+    }
+    elapsed_us = esp_timer_get_time() - start_us;
+    perf_bench_end(&bench, SIM_BENCH_READS);
+    report_latency("驱动栈", elapsed_us, errors);
+
+    // 故障注入
+    i2c_sim_inject(i2c_num, dev_addr, I2C_SIM_FAULT_NACK, 1);
+    expect("NACK", aht10_trigger_measurement_at(i2c_num, dev_addr), ESP_FAIL, &failures);
+    i2c_sim_inject(i2c_num, dev_addr, I2C_SIM_FAULT_TIMEOUT, 1);
+    expect("超时", aht10_collect_fixed_at(i2c_num, dev_addr, &fixed), ESP_ERR_TIMEOUT, &failures);
+    i2c_sim_inject(i2c_num, dev_addr, I2C_SIM_FAULT_BUSY_FRAME, 1);
+    expect("无效帧", aht10_collect_fixed_at(i2c_num, dev_addr, &fixed), ESP_ERR_NOT_FINISHED, &failures);
+    expect("恢复", aht10_collect_fixed_at(i2c_num, dev_addr, &fixed), ESP_OK, &failures);
+    expect("无设备", my_i2c_master_probe(i2c_num, 0x77, 10), ESP_FAIL, &failures);
+
+    // 转换期间读取应得到忙标志
+    i2c_sim_set_conversion_us(CONFIG_I2C_SIM_CONVERSION_MS * 1000);
+    aht10_trigger_measurement_at(i2c_num, dev_addr);
+    expect("转换中", aht10_collect_fixed_at(i2c_num, dev_addr, &fixed),
+           CONFIG_I2C_SIM_CONVERSION_MS > 0 ? ESP_ERR_NOT_FINISHED : ESP_OK, &failures);
+    return failures;
+}
+#endif
+
+#endif
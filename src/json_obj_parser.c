@@ -0,0 +1,366 @@
+/**
+ * @file json_obj_parser.c
+ * @brief 扁平JSON对象增量解析器实现
+ */
+#include <string.h>
+#include "json_obj_parser.h"
+
+/** 解析状态 */
+enum {
+    ST_OBJ_START,       // 等待'{'
+    ST_KEY_OR_END,      // '{'之后，等待键或'}'
+    ST_KEY,             // ','之后，等待键
+    ST_IN_KEY,          // 键字符串内
+    ST_IN_KEY_ESC,      // 键字符串内的转义字符
+    ST_COLON,           // 等待':'
+    ST_VALUE,           // 等待值
+    ST_NUMBER,          // 已知字段的整数值
+    ST_AFTER_VALUE,     // 等待','或'}'
+    ST_SKIP_STRING,     // 跳过字符串
+    ST_SKIP_STRING_ESC, // 跳过字符串内的转义字符
+    ST_SKIP_STRING_HEX, // 跳过\u转义后的4位十六进制数
+    ST_SKIP_NESTED,     // 跳过嵌套对象或数组
+    ST_SKIP_LITERAL,    // 跳过true/false/null
+    ST_SKIP_NUM_MINUS,  // 跳过数字：'-'之后
+    ST_SKIP_NUM_ZERO,   // 跳过数字：整数部分为0
+    ST_SKIP_NUM_INT,    // 跳过数字：整数部分
+    ST_SKIP_NUM_DOT,    // 跳过数字：'.'之后
+    ST_SKIP_NUM_FRAC,   // 跳过数字：小数部分
+    ST_SKIP_NUM_EXP_MARK, // 跳过数字：'e'/'E'之后
+    ST_SKIP_NUM_EXP_SIGN, // 跳过数字：指数符号之后
+    ST_SKIP_NUM_EXP,    // 跳过数字：指数部分
+    ST_DONE,            // 对象已结束
+};
+
+/** 跳过嵌套值时的最大深度，受json_obj_parser_t.nest位数限制 */
+#define SKIP_MAX_DEPTH 32
+
+static inline bool is_ws(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static inline bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static inline bool is_hex(char c)
+{
+    return is_digit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+static esp_err_t parser_fail(json_obj_parser_t *p, esp_err_t err)
+{
+    p->err = err;
+    return err;
+}
+
+/* 键读取完毕，查找对应字段 */
+static void lookup_key(json_obj_parser_t *p)
+{
+    p->field = -1;
+    if (p->key_len > JSON_OBJ_PARSER_KEY_MAX) {
+        return;
+    }
+    p->key[p->key_len] = '\0';
+    for (size_t i = 0; i < p->field_count; i++) {
+        if (strcmp(p->fields[i].name, p->key) == 0) {
+            p->field = (int)i;
+            return;
+        }
+    }
+}
+
+/* 按JSON语法开始跳过一个数字或字面量，结束后回到resume状态；c不能作为其开头时返回false */
+static bool skip_scalar_begin(json_obj_parser_t *p, char c, uint8_t resume)
+{
+    p->resume = resume;
+    if (c == '-') {
+        p->state = ST_SKIP_NUM_MINUS;
+    } else if (c == '0') {
+        p->state = ST_SKIP_NUM_ZERO;
+    } else if (is_digit(c)) {
+        p->state = ST_SKIP_NUM_INT;
+    } else if (c == 't' || c == 'f' || c == 'n') {
+        p->literal = (c == 't') ? "true" : (c == 'f') ? "false" : "null";
+        p->lit_pos = 1;
+        p->state = ST_SKIP_LITERAL;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/* 当前数值结束，检查范围并写入目标结构体 */
+static esp_err_t store_number(json_obj_parser_t *p)
+{
+    if (!p->has_digits) {
+        return parser_fail(p, ESP_ERR_INVALID_ARG);
+    }
+    const json_int_field_t *f = &p->fields[p->field];
+    int64_t value = p->negative ? -p->value : p->value;
+    if (value < f->min || value > f->max) {
+        return parser_fail(p, ESP_ERR_INVALID_SIZE);
+    }
+    int32_t v = (int32_t)value;
+    memcpy((uint8_t *)p->target + f->offset, &v, sizeof(v));
+    p->seen |= 1u << p->field;
+    p->state = ST_AFTER_VALUE;
+    return ESP_OK;
+}
+
+void json_obj_parser_init(json_obj_parser_t *p, const json_int_field_t *fields,
+                          size_t field_count, void *target)
+{
+    memset(p, 0, sizeof(*p));
+    p->fields = fields;
+    p->field_count = field_count;
+    p->target = target;
+    p->state = ST_OBJ_START;
+    p->field = -1;
+    if (fields == NULL || target == NULL || field_count > JSON_OBJ_PARSER_MAX_FIELDS) {
+        p->err = ESP_ERR_INVALID_ARG;
+    }
+}
+
+esp_err_t json_obj_parser_feed(json_obj_parser_t *p, const char *data, size_t len)
+{
+    for (size_t i = 0; i < len && p->err == ESP_OK; i++) {
+        char c = data[i];
+
+        switch (p->state) {
+        case ST_OBJ_START:
+            if (c == '{') {
+                p->state = ST_KEY_OR_END;
+            } else if (!is_ws(c)) {
+                return parser_fail(p, ESP_ERR_INVALID_ARG);
+            }
+            break;
+
+        case ST_KEY_OR_END:
+        case ST_KEY:
+            if (c == '"') {
+                p->key_len = 0;
+                p->state = ST_IN_KEY;
+            } else if (c == '}' && p->state == ST_KEY_OR_END) {
+                p->state = ST_DONE;
+            } else if (!is_ws(c)) {
+                return parser_fail(p, ESP_ERR_INVALID_ARG);
+            }
+            break;
+
+        case ST_IN_KEY:
+        case ST_IN_KEY_ESC:
+            if (p->state == ST_IN_KEY && c == '"') {
+                lookup_key(p);
+                p->state = ST_COLON;
+                break;
+            }
+            /* 转义的键不会与字段名匹配，按原样记录即可 */
+            p->state = (p->state == ST_IN_KEY && c == '\\') ? ST_IN_KEY_ESC : ST_IN_KEY;
+            if (p->key_len < JSON_OBJ_PARSER_KEY_MAX) {
+                p->key[p->key_len] = c;
+            }
+            if (p->key_len <= JSON_OBJ_PARSER_KEY_MAX) {
+                p->key_len++;
+            }
+            break;
+
+        case ST_COLON:
+            if (c == ':') {
+                p->state = ST_VALUE;
+            } else if (!is_ws(c)) {
+                return parser_fail(p, ESP_ERR_INVALID_ARG);
+            }
+            break;
+
+        case ST_VALUE:
+            if (is_ws(c)) {
+                break;
+            }
+            if (p->field >= 0) {
+                p->value = 0;
+                p->negative = false;
+                p->has_digits = false;
+                p->quoted = (c == '"');
+                p->state = ST_NUMBER;
+                if (!p->quoted) {
+                    i--;  // 由ST_NUMBER处理该字符
+                }
+            } else if (c == '"') {
+                p->resume = ST_AFTER_VALUE;
+                p->state = ST_SKIP_STRING;
+            } else if (c == '{' || c == '[') {
+                p->depth = 1;
+                p->nest = (c == '{');
+                p->state = ST_SKIP_NESTED;
+            } else if (!skip_scalar_begin(p, c, ST_AFTER_VALUE)) {
+                return parser_fail(p, ESP_ERR_INVALID_ARG);
+            }
+            break;
+
+        case ST_NUMBER:
+            if (c == '-' && !p->negative && !p->has_digits) {
+                /* 带引号与不带引号的值都允许一个前导负号 */
+                p->negative = true;
+            } else if (is_digit(c)) {
+                /* 超过int32范围后不再累加，由范围检查拒绝 */
+                if (p->value <= INT32_MAX) {
+                    p->value = p->value * 10 + (c - '0');
+                }
+                p->has_digits = true;
+            } else if (p->quoted && c == '"') {
+                if (store_number(p) != ESP_OK) {
+                    return p->err;
+                }
+            } else if (!p->quoted && (is_ws(c) || c == ',' || c == '}')) {
+                if (store_number(p) != ESP_OK) {
+                    return p->err;
+                }
+                i--;  // 由ST_AFTER_VALUE处理分隔符
+            } else {
+                /* 小数、指数及其它字符均不是合法的整数字段值 */
+                return parser_fail(p, ESP_ERR_INVALID_ARG);
+            }
+            break;
+
+        case ST_AFTER_VALUE:
+            if (c == ',') {
+                p->state = ST_KEY;
+            } else if (c == '}') {
+                p->state = ST_DONE;
+            } else if (!is_ws(c)) {
+                return parser_fail(p, ESP_ERR_INVALID_ARG);
+            }
+            break;
+
+        case ST_SKIP_STRING:
+            if (c == '\\') {
+                p->state = ST_SKIP_STRING_ESC;
+            } else if (c == '"') {
+                p->state = p->resume;
+            } else if ((unsigned char)c < 0x20) {
+                /* 字符串内不允许未转义的控制字符 */
+                return parser_fail(p, ESP_ERR_INVALID_ARG);
+            }
+            break;
+
+        case ST_SKIP_STRING_ESC:
+            if (c == 'u') {
+                p->lit_pos = 0;
+                p->state = ST_SKIP_STRING_HEX;
+            } else if (c != '\0' && strchr("\"\\/bfnrt", c) != NULL) {
+                p->state = ST_SKIP_STRING;
+            } else {
+                return parser_fail(p, ESP_ERR_INVALID_ARG);
+            }
+            break;
+
+        case ST_SKIP_STRING_HEX:
+            if (!is_hex(c)) {
+                return parser_fail(p, ESP_ERR_INVALID_ARG);
+            }
+            if (++p->lit_pos == 4) {
+                p->state = ST_SKIP_STRING;
+            }
+            break;
+
+        case ST_SKIP_NESTED:
+            /* 逐个校验记号并匹配括号类型，不检查逗号和冒号的位置 */
+            if (c == '"') {
+                p->resume = ST_SKIP_NESTED;
+                p->state = ST_SKIP_STRING;
+            } else if (c == '{' || c == '[') {
+                if (p->depth == SKIP_MAX_DEPTH) {
+                    return parser_fail(p, ESP_ERR_INVALID_SIZE);
+                }
+                p->nest = (p->nest << 1) | (c == '{');
+                p->depth++;
+            } else if (c == '}' || c == ']') {
+                if ((p->nest & 1) != (c == '}')) {
+                    return parser_fail(p, ESP_ERR_INVALID_ARG);
+                }
+                p->nest >>= 1;
+                if (--p->depth == 0) {
+                    p->state = ST_AFTER_VALUE;
+                }
+            } else if (!is_ws(c) && c != ',' && c != ':' && !skip_scalar_begin(p, c, ST_SKIP_NESTED)) {
+                return parser_fail(p, ESP_ERR_INVALID_ARG);
+            }
+            break;
+
+        case ST_SKIP_LITERAL:
+            if (p->literal[p->lit_pos] == '\0') {
+                p->state = p->resume;
+                i--;  // 由resume状态处理该字符
+            } else if (c == p->literal[p->lit_pos]) {
+                p->lit_pos++;
+            } else {
+                return parser_fail(p, ESP_ERR_INVALID_ARG);
+            }
+            break;
+
+        case ST_SKIP_NUM_MINUS:
+        case ST_SKIP_NUM_DOT:
+        case ST_SKIP_NUM_EXP_SIGN:
+            /* 这些位置之后必须是数字 */
+            if (!is_digit(c)) {
+                return parser_fail(p, ESP_ERR_INVALID_ARG);
+            }
+            p->state = (p->state == ST_SKIP_NUM_MINUS) ? (c == '0' ? ST_SKIP_NUM_ZERO : ST_SKIP_NUM_INT)
+                     : (p->state == ST_SKIP_NUM_DOT) ? ST_SKIP_NUM_FRAC : ST_SKIP_NUM_EXP;
+            break;
+
+        case ST_SKIP_NUM_EXP_MARK:
+            if (c == '+' || c == '-') {
+                p->state = ST_SKIP_NUM_EXP_SIGN;
+            } else if (is_digit(c)) {
+                p->state = ST_SKIP_NUM_EXP;
+            } else {
+                return parser_fail(p, ESP_ERR_INVALID_ARG);
+            }
+            break;
+
+        case ST_SKIP_NUM_ZERO:
+        case ST_SKIP_NUM_INT:
+        case ST_SKIP_NUM_FRAC:
+        case ST_SKIP_NUM_EXP:
+            if (is_digit(c) && p->state != ST_SKIP_NUM_ZERO) {
+                break;
+            }
+            if (c == '.' && p->state <= ST_SKIP_NUM_INT) {
+                p->state = ST_SKIP_NUM_DOT;
+            } else if ((c == 'e' || c == 'E') && p->state != ST_SKIP_NUM_EXP) {
+                p->state = ST_SKIP_NUM_EXP_MARK;
+            } else {
+                p->state = p->resume;
+                i--;  // 数字结束，由resume状态处理该字符
+            }
+            break;
+
+        case ST_DONE:
+            if (!is_ws(c)) {
+                return parser_fail(p, ESP_ERR_INVALID_ARG);
+            }
+            break;
+        }
+    }
+    return p->err;
+}
+
+esp_err_t json_obj_parser_finish(json_obj_parser_t *p)
+{
+    if (p->err != ESP_OK) {
+        return p->err;
+    }
+    if (p->state != ST_DONE) {
+        return parser_fail(p, ESP_ERR_INVALID_STATE);
+    }
+    for (size_t i = 0; i < p->field_count; i++) {
+        if (p->fields[i].required && !(p->seen & (1u << i))) {
+            return parser_fail(p, ESP_ERR_NOT_FOUND);
+        }
+    }
+    return ESP_OK;
+}
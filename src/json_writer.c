@@ -0,0 +1,270 @@
+/**
+ * @file json_writer.c
+ * @brief 无堆分配的流式JSON写入器实现
+ */
+#include <string.h>
+#include <math.h>
+#include "sdkconfig.h"
+#include "json_writer.h"
+
+static inline void json_write(json_writer_t *w, const char *data, size_t len)
+{
+    chunk_buf_write(&w->out, data, len);
+}
+
+static inline void json_putc(json_writer_t *w, char c)
+{
+    json_write(w, &c, 1);
+}
+
+/* 值或容器开始前，按需插入逗号 */
+static inline void json_separator(json_writer_t *w)
+{
+    if (w->need_comma) {
+        json_putc(w, ',');
+    }
+}
+
+/* 将无符号整数格式化到tmp末尾，返回首字符位置 */
+static char *format_u64(char *end, uint64_t value)
+{
+    char *p = end;
+    do {
+        *--p = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    return p;
+}
+
+void json_writer_init(json_writer_t *w, char *buf, size_t size, httpd_req_t *req)
+{
+    chunk_buf_init(&w->out, buf, size, req);
+    w->need_comma = false;
+}
+
+void json_obj_begin(json_writer_t *w)
+{
+    json_separator(w);
+    json_putc(w, '{');
+    w->need_comma = false;
+}
+
+void json_obj_end(json_writer_t *w)
+{
+    json_putc(w, '}');
+    w->need_comma = true;
+}
+
+void json_arr_begin(json_writer_t *w)
+{
+    json_separator(w);
+    json_putc(w, '[');
+    w->need_comma = false;
+}
+
+void json_arr_end(json_writer_t *w)
+{
+    json_putc(w, ']');
+    w->need_comma = true;
+}
+
+void json_key(json_writer_t *w, const char *key)
+{
+    json_separator(w);
+    json_putc(w, '"');
+    json_write(w, key, strlen(key));
+    json_write(w, "\":", 2);
+    w->need_comma = false;
+}
+
+void json_str(json_writer_t *w, const char *value)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    json_separator(w);
+    json_putc(w, '"');
+    const char *run = value;
+    for (const char *p = value; *p; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        /* 先输出无需转义的连续片段，再输出转义字符 */
+        json_write(w, run, p - run);
+        run = p + 1;
+        if (c == '"' || c == '\\') {
+            char esc[2] = {'\\', (char)c};
+            json_write(w, esc, 2);
+        } else if (c == '\n') {
+            json_write(w, "\\n", 2);
+        } else {
+            char esc[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+            json_write(w, esc, 6);
+        }
+    }
+    json_write(w, run, strlen(run));
+    json_putc(w, '"');
+    w->need_comma = true;
+}
+
+void json_uint(json_writer_t *w, uint64_t value)
+{
+    char tmp[20];
+    char *p = format_u64(tmp + sizeof(tmp), value);
+    json_separator(w);
+    json_write(w, p, tmp + sizeof(tmp) - p);
+    w->need_comma = true;
+}
+
+void json_int(json_writer_t *w, int64_t value)
+{
+    char tmp[21];
+    uint64_t mag = value < 0 ? (uint64_t)0 - (uint64_t)value : (uint64_t)value;
+    char *p = format_u64(tmp + sizeof(tmp), mag);
+    if (value < 0) {
+        *--p = '-';
+    }
+    json_separator(w);
+    json_write(w, p, tmp + sizeof(tmp) - p);
+    w->need_comma = true;
+}
+
+void json_bool(json_writer_t *w, bool value)
+{
+    json_separator(w);
+    if (value) {
+        json_write(w, "true", 4);
+    } else {
+        json_write(w, "false", 5);
+    }
+    w->need_comma = true;
+}
+
+void json_null(json_writer_t *w)
+{
+    json_separator(w);
+    json_write(w, "null", 4);
+    w->need_comma = true;
+}
+
+void json_float(json_writer_t *w, double value, int decimals)
+{
+    static const uint32_t pow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+
+    if (!isfinite(value) || fabs(value) >= 9.0e12) {
+        json_null(w);
+        return;
+    }
+    if (decimals < 0) {
+        decimals = 0;
+    } else if (decimals > 6) {
+        decimals = 6;
+    }
+
+    /* 按定点数四舍五入后分别输出整数和小数部分 */
+    bool negative = value < 0;
+    uint64_t scaled = (uint64_t)((negative ? -value : value) * pow10[decimals] + 0.5);
+    uint64_t int_part = scaled / pow10[decimals];
+    uint32_t frac_part = scaled % pow10[decimals];
+
+    char tmp[32];
+    char *end = tmp + sizeof(tmp);
+    char *p = end;
+    for (int i = 0; i < decimals; i++) {
+        *--p = (char)('0' + frac_part % 10);
+        frac_part /= 10;
+    }
+    if (decimals > 0) {
+        *--p = '.';
+    }
+    p = format_u64(p, int_part);
+    if (negative && scaled != 0) {
+        *--p = '-';
+    }
+
+    json_separator(w);
+    json_write(w, p, end - p);
+    w->need_comma = true;
+}
+
+void json_kv_str(json_writer_t *w, const char *key, const char *value)
+{
+    json_key(w, key);
+    json_str(w, value);
+}
+
+void json_kv_int(json_writer_t *w, const char *key, int64_t value)
+{
+    json_key(w, key);
+    json_int(w, value);
+}
+
+void json_kv_uint(json_writer_t *w, const char *key, uint64_t value)
+{
+    json_key(w, key);
+    json_uint(w, value);
+}
+
+void json_kv_bool(json_writer_t *w, const char *key, bool value)
+{
+    json_key(w, key);
+    json_bool(w, value);
+}
+
+void json_kv_float(json_writer_t *w, const char *key, double value, int decimals)
+{
+    json_key(w, key);
+    json_float(w, value, decimals);
+}
+
+esp_err_t json_writer_finish(json_writer_t *w)
+{
+    return chunk_buf_finish(&w->out);
+}
+
+#if CONFIG_PERF_BENCHMARKS
+#include <stdlib.h>
+#include "cJSON.h"
+#include "perf_bench.h"
+
+#define JSON_BENCH_ITERATIONS 1000
+
+/* 与temperature_data_get_handler的响应内容一致 */
+void json_writer_benchmark(void)
+{
+    perf_bench_t bench;
+    char buf[128];
+    volatile size_t sink = 0;
+
+    perf_bench_begin(&bench, "cJSON_Print 温度响应");
+    for (int i = 0; i < JSON_BENCH_ITERATIONS; i++) {
+        cJSON *root = cJSON_CreateObject();
+        cJSON_AddNumberToObject(root, "raw", 23.45 + i % 10);
+        cJSON_AddNumberToObject(root, "humidity", 48.2);
+        cJSON_AddNumberToObject(root, "seq", i);
+        cJSON_AddNumberToObject(root, "age_ms", 830);
+        cJSON_AddBoolToObject(root, "valid", true);
+        char *out = cJSON_Print(root);
+        sink += strlen(out);
+        free(out);
+        cJSON_Delete(root);
+    }
+    perf_bench_end(&bench, JSON_BENCH_ITERATIONS);
+
+    perf_bench_begin(&bench, "json_writer 温度响应");
+    for (int i = 0; i < JSON_BENCH_ITERATIONS; i++) {
+        json_writer_t w;
+        json_writer_init(&w, buf, sizeof(buf), NULL);
+        json_obj_begin(&w);
+        json_kv_float(&w, "raw", 23.45 + i % 10, 2);
+        json_kv_float(&w, "humidity", 48.2, 2);
+        json_kv_uint(&w, "seq", i);
+        json_kv_int(&w, "age_ms", 830);
+        json_kv_bool(&w, "valid", true);
+        json_obj_end(&w);
+        sink += w.out.len;
+    }
+    perf_bench_end(&bench, JSON_BENCH_ITERATIONS);
+    (void)sink;
+}
+#endif
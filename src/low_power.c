@@ -0,0 +1,368 @@
+/**
+ * @file low_power.c
+ * @brief 深度睡眠占空比采样
+ *
+ * 每次定时器唤醒只做一次测量：触发AHT10后浅睡眠等待转换，读取结果追加到
+ * RTC慢速内存中的环形缓冲区，随即进入深度睡眠，不启动WiFi。
+ * 攒够一批、变化超过阈值或缓冲区将满时才连网，把整批数据一次POST出去。
+ * 各状态的累计时间保存在RTC内存中，按配置的电流估算平均电流和每次采样的能量。
+ */
+#include "low_power.h"
+
+#if CONFIG_LOW_POWER_MODE
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include "aht10.h"
+#include "esp_attr.h"
+#include "esp_http_client.h"
+#include "esp_log.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "json_writer.h"
+
+static const char *TAG = "LOW_POWER";
+
+// RTC状态有效标志，冷启动后内容随机
+#define LOW_POWER_MAGIC 0x4C505753
+
+// 每批上传的采样数，不超过缓冲区容量
+#define LOW_POWER_BATCH_SIZE (CONFIG_LOW_POWER_BATCH_SIZE < CONFIG_LOW_POWER_BUFFER_LEN ? \
+                              CONFIG_LOW_POWER_BATCH_SIZE : CONFIG_LOW_POWER_BUFFER_LEN)
+
+// 上传时每个采样的JSON长度上限，如[4294967295,-40.00,100.00],
+#define LOW_POWER_POINT_JSON_MAX 40
+// 上传JSON中固定部分的长度上限
+#define LOW_POWER_JSON_OVERHEAD 512
+
+// 缓冲区中的一个采样（8字节）
+typedef struct {
+    uint32_t timestamp;     // 采样时间，单位：秒（深度睡眠期间由RTC计时）
+    int16_t temp_centi;     // 温度，单位：0.01℃
+    uint16_t hum_centi;     // 湿度，单位：0.01%
+} low_power_sample_t;
+
+// 跨深度睡眠保存的状态
+typedef struct {
+    uint32_t magic;
+    uint16_t head;                  // 最旧采样的下标
+    uint16_t count;                 // 缓冲区中的采样数
+    uint16_t next_flush;            // 缓冲达到该数量时上传，上传失败后推迟一批
+    bool has_ref;                   // ref_*是否有效
+    int16_t ref_temp_centi;         // 上次上传时的最新温度，用于变化阈值判断
+    uint16_t ref_hum_centi;         // 上次上传时的最新湿度
+    low_power_stats_t stats;
+    low_power_sample_t samples[CONFIG_LOW_POWER_BUFFER_LEN];
+} low_power_rtc_t;
+
+RTC_DATA_ATTR static low_power_rtc_t s_rtc;
+
+/**
+ * @brief 冷启动时清空RTC状态
+ */
+static void rtc_reset(void)
+{
+    memset(&s_rtc, 0, sizeof(s_rtc));
+    s_rtc.magic = LOW_POWER_MAGIC;
+    s_rtc.next_flush = LOW_POWER_BATCH_SIZE;
+}
+
+/**
+ * @brief 当前时间，单位：秒
+ *
+ * 系统时间在深度睡眠期间由RTC维持；未经SNTP校时时为首次上电以来的秒数。
+ *
+ * @return uint32_t 当前时间
+ */
+static uint32_t now_s(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint32_t)tv.tv_sec;
+}
+
+/**
+ * @brief 测量一次温湿度，等待转换期间浅睡眠
+ *
+ * @param i2c_num I2C端口号
+ * @param dev_addr 设备地址
+ * @param cold_boot 是否冷启动（需要发送初始化命令）
+ * @param fixed 输出定点温湿度
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+static esp_err_t measure(i2c_port_t i2c_num, uint8_t dev_addr, bool cold_boot, aht10_fixed_t *fixed)
+{
+    // 传感器在深度睡眠期间保持供电，校准状态不丢失，只在冷启动时初始化
+    esp_err_t ret = cold_boot ? aht10_init_at(i2c_num, dev_addr) : ESP_OK;
+    if (ret == ESP_OK) {
+        ret = aht10_trigger_measurement_at(i2c_num, dev_addr);
+    }
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    esp_sleep_enable_timer_wakeup(AHT10_MEASURE_TYPICAL_MS * 1000ULL);
+    esp_light_sleep_start();
+    s_rtc.stats.light_sleep_us += esp_timer_get_time() - start_us;
+
+    TickType_t poll_ticks = pdMS_TO_TICKS(AHT10_POLL_INTERVAL_MS);
+    while ((ret = aht10_collect_fixed_at(i2c_num, dev_addr, fixed)) == ESP_ERR_NOT_FINISHED) {
+        if (esp_timer_get_time() - start_us >= AHT10_MEASURE_TIMEOUT_MS * 1000LL) {
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(poll_ticks > 0 ? poll_ticks : 1);
+    }
+    return ret;
+}
+
+/**
+ * @brief 追加一个采样，缓冲区满时覆盖最旧的采样
+ *
+ * @param fixed 定点温湿度
+ */
+static void append_sample(const aht10_fixed_t *fixed)
+{
+    if (s_rtc.count == CONFIG_LOW_POWER_BUFFER_LEN) {
+        s_rtc.head = (s_rtc.head + 1) % CONFIG_LOW_POWER_BUFFER_LEN;
+        s_rtc.count--;
+        s_rtc.stats.dropped++;
+    }
+    low_power_sample_t *sample = &s_rtc.samples[(s_rtc.head + s_rtc.count) % CONFIG_LOW_POWER_BUFFER_LEN];
+    sample->timestamp = now_s();
+    sample->temp_centi = fixed->temp_centi;
+    sample->hum_centi = fixed->hum_centi;
+    s_rtc.count++;
+    s_rtc.stats.samples++;
+}
+
+/**
+ * @brief 最新采样相对上次上传是否变化超过阈值
+ *
+ * @param fixed 最新采样
+ * @return bool 超过阈值返回true
+ */
+static bool crossed_threshold(const aht10_fixed_t *fixed)
+{
+    if (!s_rtc.has_ref) {
+        return false;
+    }
+#if CONFIG_LOW_POWER_TEMP_DELTA_CENTI > 0
+    if (abs(fixed->temp_centi - s_rtc.ref_temp_centi) >= CONFIG_LOW_POWER_TEMP_DELTA_CENTI) {
+        return true;
+    }
+#endif
+#if CONFIG_LOW_POWER_HUM_DELTA_CENTI > 0
+    if (abs((int)fixed->hum_centi - (int)s_rtc.ref_hum_centi) >= CONFIG_LOW_POWER_HUM_DELTA_CENTI) {
+        return true;
+    }
+#endif
+    return false;
+}
+
+/**
+ * @brief 把统计写入JSON
+ *
+ * @param w 写入器
+ * @param stats 统计
+ */
+static void write_stats(json_writer_t *w, const low_power_stats_t *stats)
+{
+    json_obj_begin(w);
+    json_kv_uint(w, "wakes", stats->wakes);
+    json_kv_uint(w, "samples", stats->samples);
+    json_kv_uint(w, "errors", stats->errors);
+    json_kv_uint(w, "uploaded", stats->uploaded);
+    json_kv_uint(w, "dropped", stats->dropped);
+    json_kv_uint(w, "flush_failures", stats->flush_failures);
+    json_kv_uint(w, "active_ms", stats->active_us / 1000);
+    json_kv_uint(w, "light_sleep_ms", stats->light_sleep_us / 1000);
+    json_kv_uint(w, "wifi_ms", stats->wifi_us / 1000);
+    json_kv_uint(w, "deep_sleep_ms", stats->deep_sleep_us / 1000);
+    json_kv_uint(w, "avg_current_ua", stats->avg_current_ua);
+    json_kv_uint(w, "energy_per_sample_uj", stats->energy_per_sample_uj);
+    json_obj_end(w);
+}
+
+/**
+ * @brief 把缓冲区中的全部采样POST到上传地址
+ *
+ * 格式与/api/v1/temp/history的原始分辨率一致：points为[时间, 温度, 湿度]数组。
+ *
+ * @return esp_err_t 服务器返回2xx时为ESP_OK，失败返回相应错误码
+ */
+static esp_err_t upload_batch(void)
+{
+    size_t size = LOW_POWER_JSON_OVERHEAD + (size_t)s_rtc.count * LOW_POWER_POINT_JSON_MAX;
+    char *buf = malloc(size);
+    if (buf == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    low_power_stats_t stats;
+    low_power_get_stats(&stats);
+
+    json_writer_t w;
+    json_writer_init(&w, buf, size, NULL);
+    json_obj_begin(&w);
+    json_kv_uint(&w, "now", now_s());
+    json_key(&w, "points");
+    json_arr_begin(&w);
+    for (uint16_t i = 0; i < s_rtc.count; i++) {
+        const low_power_sample_t *sample = &s_rtc.samples[(s_rtc.head + i) % CONFIG_LOW_POWER_BUFFER_LEN];
+        json_arr_begin(&w);
+        json_uint(&w, sample->timestamp);
+        json_float(&w, sample->temp_centi / 100.0, 2);
+        json_float(&w, sample->hum_centi / 100.0, 2);
+        json_arr_end(&w);
+    }
+    json_arr_end(&w);
+    json_key(&w, "metrics");
+    write_stats(&w, &stats);
+    json_obj_end(&w);
+    esp_err_t ret = json_writer_finish(&w);
+    if (ret != ESP_OK) {
+        free(buf);
+        return ret;
+    }
+
+    esp_http_client_config_t config = {
+        .url = CONFIG_LOW_POWER_UPLOAD_URL,
+        .method = HTTP_METHOD_POST,
+        .timeout_ms = CONFIG_LOW_POWER_UPLOAD_TIMEOUT_MS,
+    };
+    esp_http_client_handle_t client = esp_http_client_init(&config);
+    if (client == NULL) {
+        free(buf);
+        return ESP_ERR_NO_MEM;
+    }
+    esp_http_client_set_header(client, "Content-Type", "application/json");
+    esp_http_client_set_post_field(client, buf, w.out.len);
+    ret = esp_http_client_perform(client);
+    if (ret == ESP_OK) {
+        int status = esp_http_client_get_status_code(client);
+        if (status < 200 || status >= 300) {
+            ESP_LOGW(TAG, "上传被拒绝，HTTP状态码: %d", status);
+            ret = ESP_ERR_INVALID_RESPONSE;
+        }
+    }
+    esp_http_client_cleanup(client);
+    free(buf);
+    return ret;
+}
+
+/**
+ * @brief 连网并上传缓冲区，成功后清空，失败则推迟到下一批
+ *
+ * @param connect 建立网络连接的回调
+ */
+static void flush(low_power_connect_t connect)
+{
+    int64_t start_us = esp_timer_get_time();
+    uint16_t count = s_rtc.count;
+    esp_err_t ret = connect();
+    if (ret == ESP_OK) {
+        ret = upload_batch();
+    }
+    esp_wifi_stop();
+    s_rtc.stats.wifi_us += esp_timer_get_time() - start_us;
+
+    if (ret == ESP_OK) {
+        const low_power_sample_t *last = &s_rtc.samples[(s_rtc.head + count - 1) % CONFIG_LOW_POWER_BUFFER_LEN];
+        s_rtc.has_ref = true;
+        s_rtc.ref_temp_centi = last->temp_centi;
+        s_rtc.ref_hum_centi = last->hum_centi;
+        s_rtc.head = 0;
+        s_rtc.count = 0;
+        s_rtc.next_flush = LOW_POWER_BATCH_SIZE;
+        s_rtc.stats.uploaded += count;
+        s_rtc.stats.flushes++;
+        ESP_LOGI(TAG, "已上传 %u 个采样，耗时 %lld ms", count,
+                 (long long)((esp_timer_get_time() - start_us) / 1000));
+    } else {
+        s_rtc.stats.flush_failures++;
+        uint32_t next = (uint32_t)count + LOW_POWER_BATCH_SIZE;
+        s_rtc.next_flush = next < CONFIG_LOW_POWER_BUFFER_LEN ? next : CONFIG_LOW_POWER_BUFFER_LEN;
+        ESP_LOGW(TAG, "上传失败，错误代码: %d，%u 个采样保留到下一批", ret, count);
+    }
+}
+
+/**
+ * @brief 执行一次低功耗唤醒周期，不返回
+ *
+ * @param i2c_num 已初始化的I2C端口
+ * @param dev_addr AHT10地址
+ * @param connect 建立网络连接的回调
+ */
+void low_power_run(i2c_port_t i2c_num, uint8_t dev_addr, low_power_connect_t connect)
+{
+    bool cold_boot = s_rtc.magic != LOW_POWER_MAGIC ||
+                     esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_TIMER;
+    if (cold_boot) {
+        rtc_reset();
+    }
+    s_rtc.stats.wakes++;
+    uint64_t light_before_us = s_rtc.stats.light_sleep_us;
+    uint64_t wifi_before_us = s_rtc.stats.wifi_us;
+
+    aht10_fixed_t fixed;
+    esp_err_t ret = measure(i2c_num, dev_addr, cold_boot, &fixed);
+    bool urgent = false;
+    if (ret == ESP_OK) {
+        append_sample(&fixed);
+        urgent = crossed_threshold(&fixed);
+        // 符号单独输出，-1℃到0℃之间整数部分为0
+        int temp_abs = abs(fixed.temp_centi);
+        ESP_LOGD(TAG, "温度: %s%d.%02d°C, 湿度: %u.%02u%%，缓冲 %u", fixed.temp_centi < 0 ? "-" : "",
+                 temp_abs / 100, temp_abs % 100, fixed.hum_centi / 100, fixed.hum_centi % 100, s_rtc.count);
+    } else {
+        s_rtc.stats.errors++;
+        ESP_LOGE(TAG, "读取AHT10失败，错误代码: %d", ret);
+    }
+
+    if (s_rtc.count > 0 && (urgent || s_rtc.count >= s_rtc.next_flush)) {
+        flush(connect);
+    }
+
+    // 本次唤醒的CPU运行时间，不含浅睡眠和WiFi
+    int64_t awake_us = esp_timer_get_time();
+    s_rtc.stats.active_us += awake_us - (s_rtc.stats.light_sleep_us - light_before_us) -
+                             (s_rtc.stats.wifi_us - wifi_before_us);
+
+    int64_t sleep_us = (int64_t)CONFIG_LOW_POWER_PERIOD_MS * 1000 - awake_us;
+    if (sleep_us < 1000) {
+        sleep_us = 1000;
+    }
+    s_rtc.stats.deep_sleep_us += sleep_us;
+    esp_sleep_enable_timer_wakeup(sleep_us);
+    esp_deep_sleep_start();
+}
+
+/**
+ * @brief 读取低功耗模式统计
+ *
+ * @param stats 输出统计
+ */
+void low_power_get_stats(low_power_stats_t *stats)
+{
+    *stats = s_rtc.stats;
+    stats->buffered = s_rtc.count;
+
+    // 电荷量 = Σ 各状态电流 × 时间，单位：uA·us
+    double charge = (double)stats->active_us * CONFIG_LOW_POWER_ACTIVE_UA +
+                    (double)stats->light_sleep_us * CONFIG_LOW_POWER_LIGHT_SLEEP_UA +
+                    (double)stats->wifi_us * CONFIG_LOW_POWER_WIFI_UA +
+                    (double)stats->deep_sleep_us * CONFIG_LOW_POWER_DEEP_SLEEP_UA;
+    double total_us = (double)(stats->active_us + stats->light_sleep_us +
+                               stats->wifi_us + stats->deep_sleep_us);
+    stats->avg_current_ua = total_us > 0 ? (uint32_t)(charge / total_us) : 0;
+    // uA·us × mV = 1e-15 J，换算为uJ
+    double energy_uj = charge * CONFIG_LOW_POWER_SUPPLY_MV / 1e9;
+    stats->energy_per_sample_uj = stats->samples > 0 ? (uint32_t)(energy_uj / stats->samples) : 0;
+}
+
+#endif
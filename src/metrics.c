@@ -0,0 +1,231 @@
+/**
+ * @file metrics.c
+ * @brief 延迟直方图与Prometheus文本格式输出
+ */
+#include <string.h>
+#include "metrics.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// 各桶上限（微秒），与s_bucket_le一一对应，最后一个桶为+Inf
+static const uint32_t s_bucket_us[METRICS_HIST_BUCKETS - 1] = {
+    50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000,
+};
+static const char *const s_bucket_le[METRICS_HIST_BUCKETS] = {
+    "0.00005", "0.0001", "0.00025", "0.0005", "0.001", "0.0025",
+    "0.005", "0.01", "0.025", "0.05", "0.1", "+Inf",
+};
+
+// 输出栈高水位的任务，不存在的任务跳过
+static const char *const s_watched_tasks[] = {
+    "httpd", "sampler", "i2c_bus0", "i2c_bus1", "event_worker", "sys_evt", "tiT", "wifi",
+};
+
+/**
+ * @brief 记录一次耗时
+ *
+ * @param hist 直方图
+ * @param value_us 耗时，单位：微秒
+ */
+void metrics_hist_observe(metrics_hist_t *hist, uint32_t value_us)
+{
+    size_t i = 0;
+    while (i < METRICS_HIST_BUCKETS - 1 && value_us > s_bucket_us[i]) {
+        i++;
+    }
+    atomic_fetch_add_explicit(&hist->buckets[i], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&hist->sum_us, value_us, memory_order_relaxed);
+}
+
+static inline void metrics_write(metrics_writer_t *w, const char *data, size_t len)
+{
+    chunk_buf_write(&w->out, data, len);
+}
+
+static inline void metrics_puts(metrics_writer_t *w, const char *s)
+{
+    metrics_write(w, s, strlen(s));
+}
+
+/* 将无符号整数格式化到tmp末尾，返回首字符位置 */
+static char *format_u64(char *end, uint64_t value)
+{
+    char *p = end;
+    do {
+        *--p = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    return p;
+}
+
+static void metrics_put_u64(metrics_writer_t *w, uint64_t value)
+{
+    char tmp[20];
+    char *p = format_u64(tmp + sizeof(tmp), value);
+    metrics_write(w, p, tmp + sizeof(tmp) - p);
+}
+
+/* 以秒为单位输出微秒值，固定6位小数 */
+static void metrics_put_seconds(metrics_writer_t *w, uint64_t value_us)
+{
+    char tmp[28];
+    char *p = tmp + sizeof(tmp);
+    uint32_t frac = value_us % 1000000;
+    for (int i = 0; i < 6; i++) {
+        *--p = (char)('0' + frac % 10);
+        frac /= 10;
+    }
+    *--p = '.';
+    p = format_u64(p, value_us / 1000000);
+    metrics_write(w, p, tmp + sizeof(tmp) - p);
+}
+
+/* 写入指标名和标签，extra为附加标签（如le），可为NULL */
+static void metrics_put_name(metrics_writer_t *w, const char *name, const char *suffix,
+                             const char *labels, const char *extra)
+{
+    metrics_puts(w, name);
+    if (suffix) {
+        metrics_puts(w, suffix);
+    }
+    if (labels || extra) {
+        metrics_write(w, "{", 1);
+        if (labels) {
+            metrics_puts(w, labels);
+        }
+        if (labels && extra) {
+            metrics_write(w, ",", 1);
+        }
+        if (extra) {
+            metrics_puts(w, extra);
+        }
+        metrics_write(w, "}", 1);
+    }
+    metrics_write(w, " ", 1);
+}
+
+/**
+ * @brief 初始化写入器
+ *
+ * @param w 写入器
+ * @param buf 输出缓冲区
+ * @param size 缓冲区容量
+ * @param req 绑定的HTTP请求
+ */
+void metrics_writer_init(metrics_writer_t *w, char *buf, size_t size, httpd_req_t *req)
+{
+    chunk_buf_init(&w->out, buf, size, req);
+    if (req == NULL) {
+        w->out.err = ESP_ERR_INVALID_ARG;
+    }
+}
+
+/**
+ * @brief 写入指标的HELP和TYPE行，每个指标名只写一次
+ *
+ * @param w 写入器
+ * @param name 指标名
+ * @param type "counter"、"gauge"或"histogram"
+ * @param help 说明
+ */
+void metrics_header(metrics_writer_t *w, const char *name, const char *type, const char *help)
+{
+    metrics_puts(w, "# HELP ");
+    metrics_puts(w, name);
+    metrics_write(w, " ", 1);
+    metrics_puts(w, help);
+    metrics_puts(w, "\n# TYPE ");
+    metrics_puts(w, name);
+    metrics_write(w, " ", 1);
+    metrics_puts(w, type);
+    metrics_write(w, "\n", 1);
+}
+
+/**
+ * @brief 写入一个样本
+ *
+ * @param w 写入器
+ * @param name 指标名
+ * @param labels 标签，如"uri=\"/x\""，按原样输出，可为NULL
+ * @param value 值
+ */
+void metrics_sample(metrics_writer_t *w, const char *name, const char *labels, uint64_t value)
+{
+    metrics_put_name(w, name, NULL, labels, NULL);
+    metrics_put_u64(w, value);
+    metrics_write(w, "\n", 1);
+}
+
+/**
+ * @brief 写入一个直方图的_bucket、_sum和_count样本，单位换算为秒
+ *
+ * @param w 写入器
+ * @param name 指标名（不含后缀）
+ * @param labels 标签，按原样输出，可为NULL
+ * @param hist 直方图
+ */
+void metrics_hist(metrics_writer_t *w, const char *name, const char *labels, const metrics_hist_t *hist)
+{
+    // 累积计数由各桶相加得到，保证+Inf桶与_count一致
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < METRICS_HIST_BUCKETS; i++) {
+        char le[16] = "le=\"";
+        strlcat(le, s_bucket_le[i], sizeof(le));
+        strlcat(le, "\"", sizeof(le));
+        cumulative += atomic_load_explicit(&hist->buckets[i], memory_order_relaxed);
+        metrics_put_name(w, name, "_bucket", labels, le);
+        metrics_put_u64(w, cumulative);
+        metrics_write(w, "\n", 1);
+    }
+    metrics_put_name(w, name, "_sum", labels, NULL);
+    metrics_put_seconds(w, atomic_load_explicit(&hist->sum_us, memory_order_relaxed));
+    metrics_write(w, "\n", 1);
+    metrics_put_name(w, name, "_count", labels, NULL);
+    metrics_put_u64(w, cumulative);
+    metrics_write(w, "\n", 1);
+}
+
+/**
+ * @brief 写入堆、PSRAM余量和各任务栈的剩余高水位
+ *
+ * @param w 写入器
+ */
+void metrics_write_runtime(metrics_writer_t *w)
+{
+    metrics_header(w, "heap_free_bytes", "gauge", "Free heap bytes");
+    metrics_sample(w, "heap_free_bytes", "region=\"internal\"", heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
+    metrics_sample(w, "heap_free_bytes", "region=\"psram\"", heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+    metrics_header(w, "heap_min_free_bytes", "gauge", "Lowest free heap bytes since boot");
+    metrics_sample(w, "heap_min_free_bytes", "region=\"internal\"", heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL));
+    metrics_sample(w, "heap_min_free_bytes", "region=\"psram\"", heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM));
+    metrics_header(w, "heap_largest_free_block_bytes", "gauge", "Largest allocatable block");
+    metrics_sample(w, "heap_largest_free_block_bytes", "region=\"internal\"",
+                   heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL));
+    metrics_sample(w, "heap_largest_free_block_bytes", "region=\"psram\"",
+                   heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM));
+
+    // ESP-IDF中StackType_t为字节，高水位即从未使用过的栈字节数
+    metrics_header(w, "task_stack_free_min_bytes", "gauge", "Task stack high-water mark (bytes never used)");
+    for (size_t i = 0; i < sizeof(s_watched_tasks) / sizeof(s_watched_tasks[0]); i++) {
+        TaskHandle_t task = xTaskGetHandle(s_watched_tasks[i]);
+        if (task == NULL) {
+            continue;
+        }
+        char labels[32] = "task=\"";
+        strlcat(labels, s_watched_tasks[i], sizeof(labels));
+        strlcat(labels, "\"", sizeof(labels));
+        metrics_sample(w, "task_stack_free_min_bytes", labels, uxTaskGetStackHighWaterMark(task));
+    }
+}
+
+/**
+ * @brief 发送剩余内容并结束分块响应
+ *
+ * @param w 写入器
+ * @return esp_err_t 写入过程中的首个错误
+ */
+esp_err_t metrics_writer_finish(metrics_writer_t *w)
+{
+    return chunk_buf_finish(&w->out);
+}
@@ -0,0 +1,64 @@
+/**
+ * @file perf_bench.c
+ * @brief 设备端微基准测量工具
+ *
+ * 通过esp_timer计时，并在开启CONFIG_HEAP_USE_HOOKS时借助堆钩子统计分配/释放次数。
+ */
+#include "perf_bench.h"
+
+#if CONFIG_PERF_BENCHMARKS
+
+#include <stdatomic.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
+
+// 日志标签
+static const char *TAG = "PERF";
+
+static atomic_uint s_allocs;
+static atomic_uint s_frees;
+
+#if CONFIG_HEAP_USE_HOOKS
+/* 堆钩子可能在中断中被调用，需放在IRAM中 */
+IRAM_ATTR void esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps)
+{
+    atomic_fetch_add_explicit(&s_allocs, 1, memory_order_relaxed);
+}
+
+IRAM_ATTR void esp_heap_trace_free_hook(void *ptr)
+{
+    atomic_fetch_add_explicit(&s_frees, 1, memory_order_relaxed);
+}
+#endif
+
+void perf_bench_begin(perf_bench_t *bench, const char *name)
+{
+    bench->name = name;
+    bench->start_allocs = atomic_load(&s_allocs);
+    bench->start_frees = atomic_load(&s_frees);
+    bench->start_us = esp_timer_get_time();
+}
+
+void perf_bench_end(perf_bench_t *bench, uint32_t iterations)
+{
+    int64_t elapsed_us = esp_timer_get_time() - bench->start_us;
+    uint32_t allocs = atomic_load(&s_allocs) - bench->start_allocs;
+    uint32_t frees = atomic_load(&s_frees) - bench->start_frees;
+
+    if (iterations == 0) {
+        iterations = 1;
+    }
+#if CONFIG_HEAP_USE_HOOKS
+    ESP_LOGI(TAG, "%s: %lu 次, %.2f us/次, 分配 %.2f 次/次, 释放 %.2f 次/次",
+             bench->name, (unsigned long)iterations, (double)elapsed_us / iterations,
+             (double)allocs / iterations, (double)frees / iterations);
+#else
+    (void)allocs;
+    (void)frees;
+    ESP_LOGI(TAG, "%s: %lu 次, %.2f us/次（开启CONFIG_HEAP_USE_HOOKS可统计堆操作）",
+             bench->name, (unsigned long)iterations, (double)elapsed_us / iterations);
+#endif
+}
+
+#endif
@@ -13,14 +13,32 @@
    software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
    CONDITIONS OF ANY KIND, either express or implied.
 */
+#include <stddef.h>
+#include <stdio.h>
 #include <string.h>
 #include <fcntl.h>
+#include <stdatomic.h>
+#include "sdkconfig.h"
 #include "esp_http_server.h"
 #include "esp_chip_info.h"
-#include "esp_random.h"
 #include "esp_log.h"
 #include "esp_vfs.h"
-#include "cJSON.h"
+#include "sample_store.h"
+#include "sample_log.h"
+#include "series_codec.h"
+#include "sensor_snapshot.h"
+#include "web_assets.h"
+#include "json_writer.h"
+#include "cbor_writer.h"
+#include "chunk_buf.h"
+#include "json_obj_parser.h"
+#include "boot_prof.h"
+#include "metrics.h"
+#include "i2c_driver.h"
+#include "i2c_bus.h"
+#include "sampler.h"
+#include "trace_log.h"
+#include "esp_timer.h"
 
 static const char *REST_TAG = "esp-rest";
 
@@ -47,6 +65,42 @@ static const char *REST_TAG = "esp-rest";
 #define FILE_PATH_MAX (ESP_VFS_PATH_MAX + 128)
 /** 临时缓冲区大小 */
 #define SCRATCH_BUFSIZE (10240)
+/** 历史查询每批从存储中取出的数据点数 */
+#define HISTORY_BATCH_POINTS 32
+
+/** 可注册的URI处理程序数 */
+#define REST_MAX_ROUTES (12)
+
+/** 指标中每个I2C端口输出的设备数上限，统计数组位于上下文的batch中 */
+#define METRICS_I2C_DEVICES (CONFIG_I2C_BUS_MAX_DEVICES < 16 ? CONFIG_I2C_BUS_MAX_DEVICES : 16)
+
+/** ETag缓存条目数 */
+#define ETAG_CACHE_SIZE (16)
+/** ETag字符串长度（含引号和结束符） */
+#define ETAG_LEN (19)
+
+/**
+ * @brief ETag缓存条目
+ * 
+ * 静态资源烧录后不再变化，内容哈希只需在每次启动后首次请求时计算一次
+ */
+typedef struct {
+    uint64_t path_hash;     /**< 文件路径哈希，0表示空条目 */
+    char etag[ETAG_LEN];    /**< 强ETag，内容的FNV-1a哈希 */
+} etag_cache_entry_t;
+
+/**
+ * @brief 带统计的URI处理程序
+ *
+ * 注册到httpd的是rest_route_handler，由它计时并调用原处理程序。
+ */
+typedef struct {
+    const char *uri;                       /**< URI，与注册时的字符串相同 */
+    esp_err_t (*handler)(httpd_req_t *r);  /**< 原处理程序 */
+    void *user_ctx;                        /**< 原处理程序的user_ctx */
+    atomic_uint errors;                    /**< 处理程序返回错误的次数 */
+    metrics_hist_t latency;                /**< 处理耗时 */
+} rest_route_t;
 
 /**
  * @brief REST服务器上下文结构体
@@ -56,6 +110,20 @@ static const char *REST_TAG = "esp-rest";
 typedef struct rest_server_context {
     char base_path[ESP_VFS_PATH_MAX + 1];  /**< 网站根目录路径 */
     char scratch[SCRATCH_BUFSIZE];         /**< 用于文件读取和数据处理的临时缓冲区 */
+    union {                                /**< 历史查询的一批数据点及指标导出的设备统计，与scratch一样由httpd任务独占，不占用任务栈 */
+        sample_point_t store[HISTORY_BATCH_POINTS];
+        sample_seq_point_t seq[HISTORY_BATCH_POINTS];
+        sample_log_point_t log[HISTORY_BATCH_POINTS];
+        i2c_bus_dev_stats_t i2c_devs[METRICS_I2C_DEVICES];
+    } batch;
+    httpd_handle_t server;                 /**< HTTP服务器句柄 */
+    atomic_bool broadcast_pending;         /**< 是否已有待执行的采样推送 */
+    etag_cache_entry_t etag_cache[ETAG_CACHE_SIZE]; /**< 静态文件ETag缓存 */
+    char sys_info[96];                     /**< 预先生成的系统信息响应 */
+    size_t sys_info_len;                   /**< 系统信息响应长度 */
+    int etag_cache_next;                   /**< 下一个被替换的缓存条目 */
+    rest_route_t routes[REST_MAX_ROUTES];  /**< 已注册的URI及其统计 */
+    size_t route_count;                    /**< 已注册的URI数 */
 } rest_server_context_t;
 
 /**
@@ -82,16 +150,127 @@ static esp_err_t set_content_type_from_file(httpd_req_t *req, const char *filepa
     } else if (CHECK_FILE_EXTENSION(filepath, ".ico")) {
         type = "image/x-icon";
     } else if (CHECK_FILE_EXTENSION(filepath, ".svg")) {
-        type = "text/xml";
+        type = "image/svg+xml";
+    } else if (CHECK_FILE_EXTENSION(filepath, ".json") || CHECK_FILE_EXTENSION(filepath, ".map")) {
+        type = "application/json";
+    } else if (CHECK_FILE_EXTENSION(filepath, ".woff2")) {
+        type = "font/woff2";
+    } else if (CHECK_FILE_EXTENSION(filepath, ".woff")) {
+        type = "font/woff";
     }
     return httpd_resp_set_type(req, type);  // 设置HTTP响应的内容类型
 }
 
+/* FNV-1a 64位哈希，可分段累加 */
+static uint64_t fnv1a64(uint64_t hash, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+#define FNV1A64_INIT (0xcbf29ce484222325ULL)
+
+/* 获取文件的强ETag，未缓存时读取整个文件计算内容哈希 */
+static const char *get_file_etag(rest_server_context_t *rest_context, const char *filepath, int fd)
+{
+    uint64_t path_hash = fnv1a64(FNV1A64_INIT, filepath, strlen(filepath));
+    for (int i = 0; i < ETAG_CACHE_SIZE; i++) {
+        if (rest_context->etag_cache[i].path_hash == path_hash) {
+            return rest_context->etag_cache[i].etag;
+        }
+    }
+
+    uint64_t content_hash = FNV1A64_INIT;
+    ssize_t read_bytes;
+    while ((read_bytes = read(fd, rest_context->scratch, SCRATCH_BUFSIZE)) > 0) {
+        content_hash = fnv1a64(content_hash, rest_context->scratch, read_bytes);
+    }
+    lseek(fd, 0, SEEK_SET);
+    if (read_bytes < 0) {
+        return NULL;
+    }
+
+    etag_cache_entry_t *entry = &rest_context->etag_cache[rest_context->etag_cache_next];
+    rest_context->etag_cache_next = (rest_context->etag_cache_next + 1) % ETAG_CACHE_SIZE;
+    entry->path_hash = path_hash;
+    snprintf(entry->etag, sizeof(entry->etag), "\"%016llx\"", (unsigned long long)content_hash);
+    return entry->etag;
+}
+
+/* 检查请求头中是否包含指定的值（子串匹配） */
+static bool req_header_contains(httpd_req_t *req, const char *field, const char *value)
+{
+    char header[128];
+    if (httpd_req_get_hdr_value_str(req, field, header, sizeof(header)) != ESP_OK) {
+        return false;
+    }
+    return strstr(header, value) != NULL;
+}
+
+/* 设置缓存相关响应头：文件名带内容哈希的构建产物可长期缓存，其余资源每次通过ETag重新验证 */
+static void set_cache_headers(httpd_req_t *req)
+{
+    const char *uri = req->uri;
+    bool immutable = strncmp(uri, "/js/", 4) == 0 || strncmp(uri, "/css/", 5) == 0 ||
+                     strncmp(uri, "/img/", 5) == 0 || strncmp(uri, "/fonts/", 7) == 0;
+    httpd_resp_set_hdr(req, "Cache-Control", immutable ? "public, max-age=31536000, immutable" : "no-cache");
+    httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+}
+
+/* 从内存映射的资源镜像发送文件，内容直接取自映射的flash，不经过文件系统和scratch缓冲区 */
+static esp_err_t rest_asset_get_handler(httpd_req_t *req)
+{
+    char path[FILE_PATH_MAX];
+    size_t uri_len = strcspn(req->uri, "?");
+    const char *uri = req->uri;
+    if (uri_len == 0 || uri[uri_len - 1] == '/') {
+        snprintf(path, sizeof(path), "%.*sindex.html", (int)uri_len, uri);
+        uri = path;
+        uri_len = strlen(path);
+    }
+
+    web_asset_t asset;
+    if (web_assets_find(uri, uri_len, &asset) != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "File does not exist");
+        return ESP_FAIL;
+    }
+
+    const uint8_t *data = asset.data;
+    size_t length = asset.length;
+    const char *etag = asset.etag;
+    bool gzipped = asset.gz_data != NULL && req_header_contains(req, "Accept-Encoding", "gzip");
+    if (gzipped) {
+        data = asset.gz_data;
+        length = asset.gz_length;
+        etag = asset.gz_etag;
+    }
+
+    set_cache_headers(req);
+    httpd_resp_set_hdr(req, "ETag", etag);
+    if (req_header_contains(req, "If-None-Match", etag)) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
+    }
+    if (gzipped) {
+        httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    }
+    httpd_resp_set_type(req, asset.mime);
+    return httpd_resp_send(req, (const char *)data, length);
+}
+
 /* 发送HTTP响应，包含请求文件的内容 */
 static esp_err_t rest_common_get_handler(httpd_req_t *req)
 {
     char filepath[FILE_PATH_MAX];
 
+    if (web_assets_ready()) {
+        return rest_asset_get_handler(req);
+    }
+
     rest_server_context_t *rest_context = (rest_server_context_t *)req->user_ctx;
     strlcpy(filepath, rest_context->base_path, sizeof(filepath));
     if (req->uri[strlen(req->uri) - 1] == '/') {
@@ -99,7 +278,19 @@ static esp_err_t rest_common_get_handler(httpd_req_t *req)
     } else {
         strlcat(filepath, req->uri, sizeof(filepath));
     }
-    int fd = open(filepath, O_RDONLY, 0);  // 打开文件
+
+    /* 客户端支持gzip时优先发送构建时生成的.gz文件 */
+    char gzpath[FILE_PATH_MAX];
+    int fd = -1;
+    bool gzipped = false;
+    if (req_header_contains(req, "Accept-Encoding", "gzip") &&
+        snprintf(gzpath, sizeof(gzpath), "%s.gz", filepath) < (int)sizeof(gzpath)) {
+        fd = open(gzpath, O_RDONLY, 0);
+        gzipped = (fd != -1);
+    }
+    if (fd == -1) {
+        fd = open(filepath, O_RDONLY, 0);  // 打开文件
+    }
     if (fd == -1) {
         ESP_LOGE(REST_TAG, "Failed to open file : %s", filepath);
         /* Respond with 500 Internal Server Error */
@@ -107,6 +298,22 @@ static esp_err_t rest_common_get_handler(httpd_req_t *req)
         return ESP_FAIL;
     }
 
+    set_cache_headers(req);
+
+    /* gzip和原始文件内容不同，各自拥有独立的ETag */
+    const char *etag = get_file_etag(rest_context, gzipped ? gzpath : filepath, fd);
+    if (etag) {
+        httpd_resp_set_hdr(req, "ETag", etag);
+        if (req_header_contains(req, "If-None-Match", etag)) {
+            close(fd);
+            httpd_resp_set_status(req, "304 Not Modified");
+            return httpd_resp_send(req, NULL, 0);
+        }
+    }
+    if (gzipped) {
+        httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    }
+
     set_content_type_from_file(req, filepath);  // 设置内容类型
 
     char *chunk = rest_context->scratch;
@@ -137,68 +344,908 @@ static esp_err_t rest_common_get_handler(httpd_req_t *req)
     return ESP_OK;
 }
 
-/* 简单的灯光亮度控制处理程序 */
+/* 灯光颜色，由请求体直接解析得到 */
+typedef struct {
+    int32_t red;
+    int32_t green;
+    int32_t blue;
+} light_color_t;
+
+/* 灯光控制请求体的字段表，新增字段只需在此添加 */
+static const json_int_field_t s_light_fields[] = {
+    { "red",   0, 255, true, offsetof(light_color_t, red) },
+    { "green", 0, 255, true, offsetof(light_color_t, green) },
+    { "blue",  0, 255, true, offsetof(light_color_t, blue) },
+};
+
+// 灯光控制请求体的最大长度
+#define LIGHT_BODY_MAX_LEN 256
+// 每次从套接字读取的字节数
+#define LIGHT_RECV_CHUNK 64
+
+/* 灯光亮度控制的处理程序，请求体边接收边解析，不复制、不分配内存 */
 static esp_err_t light_brightness_post_handler(httpd_req_t *req)
 {
-    int total_len = req->content_len;
-    int cur_len = 0;
-    char *buf = ((rest_server_context_t *)(req->user_ctx))->scratch;
-    int received = 0;
-    if (total_len >= SCRATCH_BUFSIZE) {
-        /* Respond with 500 Internal Server Error */
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "content too long");
+    size_t remaining = req->content_len;
+    if (remaining > LIGHT_BODY_MAX_LEN) {
+        httpd_resp_send_err(req, HTTPD_413_CONTENT_TOO_LARGE, "content too long");
         return ESP_FAIL;
     }
-    while (cur_len < total_len) {
-        received = httpd_req_recv(req, buf + cur_len, total_len);  // 接收请求内容
+
+    light_color_t color;
+    json_obj_parser_t parser;
+    json_obj_parser_init(&parser, s_light_fields,
+                         sizeof(s_light_fields) / sizeof(s_light_fields[0]), &color);
+
+    char chunk[LIGHT_RECV_CHUNK];
+    esp_err_t err = ESP_OK;
+    while (remaining > 0) {
+        int received = httpd_req_recv(req, chunk, remaining < sizeof(chunk) ? remaining : sizeof(chunk));  // 接收请求内容
+        if (received == HTTPD_SOCK_ERR_TIMEOUT) {
+            continue;
+        }
         if (received <= 0) {
-            /* Respond with 500 Internal Server Error */
             httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to post control value");
             return ESP_FAIL;
         }
-        cur_len += received;
+        remaining -= received;
+        // 出错后仍需读完请求体，保证连接可以继续复用
+        if (err == ESP_OK) {
+            err = json_obj_parser_feed(&parser, chunk, received);
+        }
+    }
+    if (err == ESP_OK) {
+        err = json_obj_parser_finish(&parser);
+    }
+
+    switch (err) {
+    case ESP_OK:
+        break;
+    case ESP_ERR_INVALID_SIZE:
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "value out of range 0-255");
+        return ESP_FAIL;
+    case ESP_ERR_NOT_FOUND:
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "red, green and blue are required");
+        return ESP_FAIL;
+    default:
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "invalid JSON");
+        return ESP_FAIL;
     }
-    buf[total_len] = '\0';
 
-    cJSON *root = cJSON_Parse(buf);  // 解析JSON内容
-    int red = cJSON_GetObjectItem(root, "red")->valueint;
-    int green = cJSON_GetObjectItem(root, "green")->valueint;
-    int blue = cJSON_GetObjectItem(root, "blue")->valueint;
-    ESP_LOGI(REST_TAG, "Light control: red = %d, green = %d, blue = %d", red, green, blue);
-    cJSON_Delete(root);
+    ESP_LOGI(REST_TAG, "Light control: red = %d, green = %d, blue = %d",
+             (int)color.red, (int)color.green, (int)color.blue);
     httpd_resp_sendstr(req, "Post control value successfully");  // 发送响应
     return ESP_OK;
 }
 
-/* 获取系统信息的处理程序 */
+/* 获取系统信息的处理程序，响应内容在启动时预先生成 */
 static esp_err_t system_info_get_handler(httpd_req_t *req)
 {
+    rest_server_context_t *rest_context = (rest_server_context_t *)req->user_ctx;
     httpd_resp_set_type(req, "application/json");  // 设置响应类型为JSON
-    cJSON *root = cJSON_CreateObject();
+    return httpd_resp_send(req, rest_context->sys_info, rest_context->sys_info_len);  // 发送系统信息
+}
+
+/* 生成系统信息响应，内容在运行期间不变，只需生成一次 */
+static esp_err_t render_system_info(rest_server_context_t *rest_context)
+{
     esp_chip_info_t chip_info;
     esp_chip_info(&chip_info);  // 获取芯片信息
-    cJSON_AddStringToObject(root, "version", IDF_VER);
-    cJSON_AddNumberToObject(root, "cores", chip_info.cores);
-    const char *sys_info = cJSON_Print(root);
-    httpd_resp_sendstr(req, sys_info);  // 发送系统信息
-    free((void *)sys_info);
-    cJSON_Delete(root);
+
+    json_writer_t w;
+    json_writer_init(&w, rest_context->sys_info, sizeof(rest_context->sys_info), NULL);
+    json_obj_begin(&w);
+    json_kv_str(&w, "version", IDF_VER);
+    json_kv_uint(&w, "cores", chip_info.cores);
+    json_obj_end(&w);
+    rest_context->sys_info_len = w.out.len;
+    return json_writer_finish(&w);
+}
+
+/* 所有URI的入口：还原原处理程序的user_ctx并记录耗时，只做原子加法，不加锁 */
+static esp_err_t rest_route_handler(httpd_req_t *req)
+{
+    rest_route_t *route = (rest_route_t *)req->user_ctx;
+    int64_t start_us = esp_timer_get_time();
+    req->user_ctx = route->user_ctx;
+    esp_err_t ret = route->handler(req);
+    req->user_ctx = route;
+    metrics_hist_observe(&route->latency, (uint32_t)(esp_timer_get_time() - start_us));
+    if (ret != ESP_OK) {
+        atomic_fetch_add_explicit(&route->errors, 1, memory_order_relaxed);
+    }
+    return ret;
+}
+
+/* 注册URI处理程序，经rest_route_handler转发以便统计 */
+static esp_err_t register_route(rest_server_context_t *rest_context, const httpd_uri_t *uri)
+{
+    if (rest_context->route_count >= REST_MAX_ROUTES) {
+        ESP_LOGE(REST_TAG, "Too many URI handlers, %s not registered", uri->uri);
+        return ESP_ERR_NO_MEM;
+    }
+    rest_route_t *route = &rest_context->routes[rest_context->route_count];
+    route->uri = uri->uri;
+    route->handler = uri->handler;
+    route->user_ctx = uri->user_ctx;
+
+    httpd_uri_t metered = *uri;
+    metered.handler = rest_route_handler;
+    metered.user_ctx = route;
+    esp_err_t ret = httpd_register_uri_handler(rest_context->server, &metered);
+    if (ret == ESP_OK) {
+        rest_context->route_count++;
+    }
+    return ret;
+}
+
+/* 输出Prometheus文本格式的运行指标 */
+static esp_err_t metrics_get_handler(httpd_req_t *req)
+{
+    rest_server_context_t *rest_context = (rest_server_context_t *)req->user_ctx;
+    char labels[48];
+    httpd_resp_set_type(req, "text/plain; version=0.0.4");
+
+    metrics_writer_t w;
+    metrics_writer_init(&w, rest_context->scratch, SCRATCH_BUFSIZE, req);
+
+    /* HTTP处理程序 */
+    metrics_header(&w, "http_request_duration_seconds", "histogram", "Handler latency per URI");
+    for (size_t i = 0; i < rest_context->route_count; i++) {
+        const rest_route_t *route = &rest_context->routes[i];
+        snprintf(labels, sizeof(labels), "uri=\"%s\"", route->uri);
+        metrics_hist(&w, "http_request_duration_seconds", labels, &route->latency);
+    }
+    metrics_header(&w, "http_request_errors_total", "counter", "Handler calls that returned an error");
+    for (size_t i = 0; i < rest_context->route_count; i++) {
+        const rest_route_t *route = &rest_context->routes[i];
+        snprintf(labels, sizeof(labels), "uri=\"%s\"", route->uri);
+        metrics_sample(&w, "http_request_errors_total", labels,
+                       atomic_load_explicit(&route->errors, memory_order_relaxed));
+    }
+
+    /* I2C事务（驱动层）与各设备的排队统计（总线管理器） */
+    metrics_header(&w, "i2c_transaction_duration_seconds", "histogram", "I2C transaction latency per port");
+    for (int port = 0; port < I2C_NUM_MAX; port++) {
+        snprintf(labels, sizeof(labels), "port=\"%d\"", port);
+        metrics_hist(&w, "i2c_transaction_duration_seconds", labels, &i2c_driver_get_metrics(port)->latency);
+    }
+    metrics_header(&w, "i2c_transaction_errors_total", "counter", "Failed I2C transactions by cause");
+    for (int port = 0; port < I2C_NUM_MAX; port++) {
+        const i2c_driver_metrics_t *m = i2c_driver_get_metrics(port);
+        snprintf(labels, sizeof(labels), "port=\"%d\",cause=\"nack\"", port);
+        metrics_sample(&w, "i2c_transaction_errors_total", labels, atomic_load(&m->nacks));
+        snprintf(labels, sizeof(labels), "port=\"%d\",cause=\"timeout\"", port);
+        metrics_sample(&w, "i2c_transaction_errors_total", labels, atomic_load(&m->timeouts));
+        snprintf(labels, sizeof(labels), "port=\"%d\",cause=\"other\"", port);
+        metrics_sample(&w, "i2c_transaction_errors_total", labels, atomic_load(&m->errors));
+    }
+    metrics_header(&w, "i2c_bus_wait_microseconds_total", "counter", "Time transactions spent queued for the bus");
+    i2c_bus_dev_stats_t *devs = rest_context->batch.i2c_devs;
+    for (int port = 0; port < I2C_NUM_MAX; port++) {
+        size_t n = i2c_bus_get_stats(port, devs, METRICS_I2C_DEVICES);
+        for (size_t i = 0; i < n; i++) {
+            snprintf(labels, sizeof(labels), "port=\"%d\",addr=\"0x%02x\"", port, devs[i].dev_addr);
+            metrics_sample(&w, "i2c_bus_wait_microseconds_total", labels, devs[i].wait_us);
+        }
+    }
+
+    /* 传感器采样 */
+    metrics_header(&w, "sampler_samples_total", "counter", "Successful sensor reads");
+    for (size_t i = 0; i < sampler_count(); i++) {
+        sampler_stats_t st;
+        if (sampler_get_stats(i, &st) == ESP_OK) {
+            snprintf(labels, sizeof(labels), "sensor=\"%u\"", (unsigned)i);
+            metrics_sample(&w, "sampler_samples_total", labels, st.samples);
+        }
+    }
+    metrics_header(&w, "sampler_errors_total", "counter", "Failed sensor reads");
+    for (size_t i = 0; i < sampler_count(); i++) {
+        sampler_stats_t st;
+        if (sampler_get_stats(i, &st) == ESP_OK) {
+            snprintf(labels, sizeof(labels), "sensor=\"%u\"", (unsigned)i);
+            metrics_sample(&w, "sampler_errors_total", labels, st.errors);
+        }
+    }
+    sensor_reading_t reading;
+    if (sensor_snapshot_read(&g_sensor_snapshot, &reading)) {
+        metrics_header(&w, "sensor_sample_age_milliseconds", "gauge", "Age of the latest published sample");
+        metrics_sample(&w, "sensor_sample_age_milliseconds", NULL,
+                       (uint64_t)(esp_timer_get_time() - reading.timestamp_us) / 1000);
+        metrics_header(&w, "sensor_sample_valid", "gauge", "Whether the latest read succeeded");
+        metrics_sample(&w, "sensor_sample_valid", NULL, reading.valid);
+    }
+
+    /* 堆、PSRAM与任务栈 */
+    metrics_write_runtime(&w);
+
+    if (metrics_writer_finish(&w) != ESP_OK) {
+        ESP_LOGE(REST_TAG, "Metrics sending failed!");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+/* 获取启动时间线的处理程序，本次启动在前，之后是RTC内存中保留的历史启动 */
+static esp_err_t system_boot_get_handler(httpd_req_t *req)
+{
+    char *buf = ((rest_server_context_t *)(req->user_ctx))->scratch;
+    httpd_resp_set_type(req, "application/json");  // 设置响应类型为JSON
+
+    json_writer_t w;
+    json_writer_init(&w, buf, SCRATCH_BUFSIZE, req);
+    json_obj_begin(&w);
+    json_key(&w, "boots");
+    json_arr_begin(&w);
+
+    boot_prof_record_t record;
+    for (size_t i = 0; w.out.err == ESP_OK && boot_prof_get(i, &record); i++) {
+        json_obj_begin(&w);
+        json_kv_uint(&w, "boot", record.boot_count);
+        json_kv_str(&w, "reset_reason", boot_prof_reset_reason_name(record.reset_reason));
+        json_kv_bool(&w, "complete", record.complete);
+        json_kv_uint(&w, "app_start_us", record.app_start_us);
+        json_kv_uint(&w, "total_us", record.total_us);
+        json_kv_uint(&w, "free_heap_start", record.free_heap_start);
+        json_kv_uint(&w, "free_heap_end", record.free_heap_end);
+        json_key(&w, "stages");
+        json_arr_begin(&w);
+        for (size_t s = 0; s < record.stage_count; s++) {
+            const boot_prof_stage_t *stage = &record.stages[s];
+            json_obj_begin(&w);
+            json_kv_str(&w, "name", stage->name);
+            json_kv_uint(&w, "start_us", stage->start_us);
+            json_kv_uint(&w, "duration_us", stage->duration_us);
+            json_kv_int(&w, "heap_delta", stage->heap_delta);
+            json_obj_end(&w);
+        }
+        json_arr_end(&w);
+        json_obj_end(&w);
+    }
+
+    json_arr_end(&w);
+    json_obj_end(&w);
+    if (json_writer_finish(&w) != ESP_OK) {
+        ESP_LOGE(REST_TAG, "Boot profile sending failed!");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+/* 二进制跟踪日志转储的文件头，格式见tools/tracelog.py */
+typedef struct __attribute__((packed)) {
+    char magic[4];          /**< "TRLG" */
+    uint16_t version;       /**< 格式版本 */
+    uint16_t entry_size;    /**< sizeof(trace_log_entry_t) */
+    uint16_t event_count;   /**< 格式串个数 */
+    uint16_t cores;         /**< 核心数 */
+    uint32_t dropped;       /**< 初始化前丢弃的记录数 */
+    int64_t now_us;         /**< 转储时的esp_timer时间 */
+} trace_dump_header_t;
+
+/* 下载跟踪日志：默认在设备上格式化为文本，?format=bin返回二进制转储由主机解码 */
+static esp_err_t system_log_get_handler(httpd_req_t *req)
+{
+    char *buf = ((rest_server_context_t *)(req->user_ctx))->scratch;
+    char query[32];
+    char format[8] = {0};
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        httpd_query_key_value(query, "format", format, sizeof(format));
+    }
+    bool binary = strcmp(format, "bin") == 0;
+
+    chunk_buf_t out;
+    chunk_buf_init(&out, buf, SCRATCH_BUFSIZE, req);
+    trace_log_iter_t iter;
+    trace_log_entry_t entry;
+    trace_log_iter_init(&iter);
+
+    if (binary) {
+        httpd_resp_set_type(req, "application/octet-stream");
+        trace_dump_header_t header = {
+            .magic = {'T', 'R', 'L', 'G'},
+            .version = 1,
+            .entry_size = sizeof(trace_log_entry_t),
+            .event_count = TRACE_LOG_EVENT_MAX,
+            .cores = portNUM_PROCESSORS,
+            .dropped = trace_log_dropped(),
+            .now_us = esp_timer_get_time(),
+        };
+        chunk_buf_write(&out, &header, sizeof(header));
+        for (uint16_t id = 0; out.err == ESP_OK && id < TRACE_LOG_EVENT_MAX; id++) {
+            const char *fmt = trace_log_event_format(id);
+            uint16_t fmt_len = strlen(fmt);
+            chunk_buf_write(&out, &fmt_len, sizeof(fmt_len));
+            chunk_buf_write(&out, fmt, fmt_len);
+        }
+        while (out.err == ESP_OK && trace_log_iter_next(&iter, &entry)) {
+            chunk_buf_write(&out, &entry, sizeof(entry));
+        }
+    } else {
+        httpd_resp_set_type(req, "text/plain; charset=utf-8");
+        char line[160];
+        while (out.err == ESP_OK && trace_log_iter_next(&iter, &entry)) {
+            int n = trace_log_format(&entry, line, sizeof(line));
+            if (n > 0) {
+                chunk_buf_write(&out, line, (size_t)n < sizeof(line) ? (size_t)n : sizeof(line) - 1);
+            }
+        }
+        if (out.err == ESP_OK && (iter.lost > 0 || trace_log_dropped() > 0)) {
+            int n = snprintf(line, sizeof(line), "# lost %lu, dropped before init %lu\n",
+                             (unsigned long)iter.lost, (unsigned long)trace_log_dropped());
+            chunk_buf_write(&out, line, n);
+        }
+    }
+
+    if (chunk_buf_finish(&out) != ESP_OK) {
+        ESP_LOGE(REST_TAG, "Trace log sending failed!");
+        return ESP_FAIL;
+    }
     return ESP_OK;
 }
 
-/* 获取温度数据的处理程序 */
+/* 获取温度数据的处理程序，读取采样任务发布的最新快照，不访问I2C总线 */
 static esp_err_t temperature_data_get_handler(httpd_req_t *req)
 {
+    sensor_reading_t reading;
+    if (!sensor_snapshot_read(&g_sensor_snapshot, &reading)) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_sendstr(req, "No sample available yet");
+        return ESP_OK;
+    }
+
+    char buf[128];
+    json_writer_t w;
+    json_writer_init(&w, buf, sizeof(buf), NULL);
+    json_obj_begin(&w);
+    json_kv_float(&w, "raw", reading.value.temp_centi / 100.0f, 2);
+    json_kv_float(&w, "humidity", reading.value.hum_centi / 100.0f, 2);
+    json_kv_uint(&w, "seq", reading.seq);
+    json_kv_int(&w, "age_ms", (esp_timer_get_time() - reading.timestamp_us) / 1000);
+    json_kv_bool(&w, "valid", reading.valid);
+    json_obj_end(&w);
+
     httpd_resp_set_type(req, "application/json");  // 设置响应类型为JSON
-    cJSON *root = cJSON_CreateObject();
-    cJSON_AddNumberToObject(root, "raw", esp_random() % 20);  // 生成随机温度数据
-    const char *sys_info = cJSON_Print(root);
-    httpd_resp_sendstr(req, sys_info);  // 发送温度数据
-    free((void *)sys_info);
-    cJSON_Delete(root);
+    return httpd_resp_send(req, buf, w.out.len);  // 发送温度数据
+}
+
+/* 从查询字符串中读取无符号整数参数，不存在时返回默认值 */
+static uint32_t query_get_u32(const char *query, const char *key, uint32_t def)
+{
+    char value[16];
+    if (query == NULL || httpd_query_key_value(query, key, value, sizeof(value)) != ESP_OK) {
+        return def;
+    }
+    return strtoul(value, NULL, 10);
+}
+
+/* 查询字符串中是否指定了format=delta */
+static bool query_is_delta(const char *query)
+{
+    char format[8];
+    return query != NULL && httpd_query_key_value(query, "format", format, sizeof(format)) == ESP_OK &&
+           strcmp(format, "delta") == 0;
+}
+
+/* 按Accept头协商批量数据的格式：包含application/cbor时返回true，否则为JSON */
+static bool req_accepts_cbor(httpd_req_t *req)
+{
+    // 同一URI按Accept返回不同内容，告知缓存
+    httpd_resp_set_hdr(req, "Vary", "Accept");
+    return req_header_contains(req, "Accept", "application/cbor");
+}
+
+/* 编码一个点，缓冲区满时先发送已编码的部分，再在同一个编码流上继续 */
+static esp_err_t series_send_point(httpd_req_t *req, series_encoder_t *enc, const series_point_t *point)
+{
+    if (series_encode(enc, point)) {
+        return ESP_OK;
+    }
+    esp_err_t ret = httpd_resp_send_chunk(req, (const char *)enc->buf, enc->len);
+    enc->len = 0;
+    if (ret == ESP_OK) {
+        series_encode(enc, point);
+    }
+    return ret;
+}
+
+/* 发送剩余的编码流并结束分块响应 */
+static esp_err_t series_send_finish(httpd_req_t *req, series_encoder_t *enc, esp_err_t ret)
+{
+    if (ret == ESP_OK && enc->len > 0) {
+        ret = httpd_resp_send_chunk(req, (const char *)enc->buf, enc->len);
+    }
+    if (ret == ESP_OK) {
+        ret = httpd_resp_send_chunk(req, NULL, 0);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(REST_TAG, "Series sending failed!");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+/* 以差分编码流发送原始采样历史 */
+static esp_err_t temperature_history_send_delta(httpd_req_t *req, rest_server_context_t *rest_context,
+                                                uint32_t from, uint32_t to)
+{
+    httpd_resp_set_type(req, "application/octet-stream");
+
+    series_encoder_t enc;
+    series_encoder_init(&enc, (uint8_t *)rest_context->scratch, SCRATCH_BUFSIZE);
+    sample_point_t *points = rest_context->batch.store;
+    sample_store_iter_t iter;
+    sample_store_iter_init(&iter, SAMPLE_RES_RAW, from, to);
+    esp_err_t ret = ESP_OK;
+    size_t n;
+    while (ret == ESP_OK && (n = sample_store_iter_next(&iter, points, HISTORY_BATCH_POINTS)) > 0) {
+        for (size_t i = 0; ret == ESP_OK && i < n; i++) {
+            series_point_t point = {
+                .timestamp = points[i].timestamp,
+                .value = { .temp_centi = points[i].temp_mean, .hum_centi = points[i].hum_mean },
+            };
+            ret = series_send_point(req, &enc, &point);
+        }
+    }
+    return series_send_finish(req, &enc, ret);
+}
+
+/* 以CBOR发送历史数据，结构与JSON相同，温湿度为0.01单位的整数 */
+static esp_err_t temperature_history_send_cbor(httpd_req_t *req, rest_server_context_t *rest_context,
+                                               sample_res_t res, uint32_t now, uint32_t from, uint32_t to)
+{
+    httpd_resp_set_type(req, "application/cbor");
+
+    cbor_writer_t w;
+    cbor_writer_init(&w, (uint8_t *)rest_context->scratch, SCRATCH_BUFSIZE, req);
+    cbor_map_begin(&w);
+    cbor_kv_str(&w, "res", sample_store_res_name(res));
+    cbor_kv_uint(&w, "now", now);
+    cbor_str(&w, "points");
+    cbor_arr_begin(&w);
+
+    sample_point_t *points = rest_context->batch.store;
+    sample_store_iter_t iter;
+    sample_store_iter_init(&iter, res, from, to);
+    size_t n;
+    while (w.out.err == ESP_OK && (n = sample_store_iter_next(&iter, points, HISTORY_BATCH_POINTS)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            const sample_point_t *p = &points[i];
+            if (res == SAMPLE_RES_RAW) {
+                cbor_arr_begin_n(&w, 3);
+                cbor_uint(&w, p->timestamp);
+                cbor_int(&w, p->temp_mean);
+                cbor_uint(&w, p->hum_mean);
+            } else {
+                cbor_arr_begin_n(&w, 8);
+                cbor_uint(&w, p->timestamp);
+                cbor_uint(&w, p->count);
+                cbor_int(&w, p->temp_min);
+                cbor_int(&w, p->temp_max);
+                cbor_int(&w, p->temp_mean);
+                cbor_uint(&w, p->hum_min);
+                cbor_uint(&w, p->hum_max);
+                cbor_uint(&w, p->hum_mean);
+            }
+        }
+    }
+
+    cbor_end(&w);
+    cbor_end(&w);
+    if (cbor_writer_finish(&w) != ESP_OK) {
+        ESP_LOGE(REST_TAG, "History sending failed!");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+/* 获取温湿度历史数据的处理程序：/api/v1/temp/history?from=&to=&res=&format= */
+static esp_err_t temperature_history_get_handler(httpd_req_t *req)
+{
+    rest_server_context_t *rest_context = (rest_server_context_t *)req->user_ctx;
+    char *buf = rest_context->scratch;
+    char *query = NULL;
+    char res_name[8] = {0};
+    sample_res_t res;
+    uint32_t now = sample_store_now();
+
+    size_t query_len = httpd_req_get_url_query_len(req) + 1;
+    if (query_len > 1) {
+        query = malloc(query_len);
+        if (query && httpd_req_get_url_query_str(req, query, query_len) != ESP_OK) {
+            free(query);
+            query = NULL;
+        }
+    }
+    uint32_t to = query_get_u32(query, "to", now);
+    uint32_t from = query_get_u32(query, "from", to > 3600 ? to - 3600 : 0);
+    bool has_res = query && httpd_query_key_value(query, "res", res_name, sizeof(res_name)) == ESP_OK;
+    bool delta = query_is_delta(query);
+    free(query);
+
+    if (delta) {
+        // 差分编码只用于原始采样
+        if (has_res && strcmp(res_name, sample_store_res_name(SAMPLE_RES_RAW)) != 0) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "format=delta requires res=raw");
+            return ESP_FAIL;
+        }
+        return temperature_history_send_delta(req, rest_context, from, to);
+    }
+    if (has_res) {
+        if (sample_store_res_from_name(res_name, &res) != ESP_OK) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "res must be raw, 1m or 1h");
+            return ESP_FAIL;
+        }
+    } else {
+        // 未指定分辨率时按时间跨度选择，使返回点数保持在数百量级
+        uint32_t span = to > from ? to - from : 0;
+        res = span <= 3600 ? SAMPLE_RES_RAW : (span <= 2 * 86400 ? SAMPLE_RES_MINUTE : SAMPLE_RES_HOUR);
+    }
+    if (req_accepts_cbor(req)) {
+        return temperature_history_send_cbor(req, rest_context, res, now, from, to);
+    }
+
+    httpd_resp_set_type(req, "application/json");  // 设置响应类型为JSON
+
+    /* 分批取出并经写入器分块发送，避免一次性构建整棵JSON树 */
+    json_writer_t w;
+    json_writer_init(&w, buf, SCRATCH_BUFSIZE, req);
+    json_obj_begin(&w);
+    json_kv_str(&w, "res", sample_store_res_name(res));
+    json_kv_uint(&w, "now", now);
+    json_key(&w, "points");
+    json_arr_begin(&w);
+
+    sample_point_t *points = rest_context->batch.store;
+    sample_store_iter_t iter;
+    sample_store_iter_init(&iter, res, from, to);
+    size_t n;
+    while (w.out.err == ESP_OK && (n = sample_store_iter_next(&iter, points, HISTORY_BATCH_POINTS)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            const sample_point_t *p = &points[i];
+            json_arr_begin(&w);
+            json_uint(&w, p->timestamp);
+            if (res == SAMPLE_RES_RAW) {
+                json_float(&w, p->temp_mean / 100.0f, 2);
+                json_float(&w, p->hum_mean / 100.0f, 2);
+            } else {
+                json_uint(&w, p->count);
+                json_float(&w, p->temp_min / 100.0f, 2);
+                json_float(&w, p->temp_max / 100.0f, 2);
+                json_float(&w, p->temp_mean / 100.0f, 2);
+                json_float(&w, p->hum_min / 100.0f, 2);
+                json_float(&w, p->hum_max / 100.0f, 2);
+                json_float(&w, p->hum_mean / 100.0f, 2);
+            }
+            json_arr_end(&w);
+        }
+    }
+
+    json_arr_end(&w);
+    json_obj_end(&w);
+    if (json_writer_finish(&w) != ESP_OK) {
+        ESP_LOGE(REST_TAG, "History sending failed!");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+/** 增量同步单次返回的默认和最大采样数 */
+#define SINCE_DEFAULT_POINTS 256
+#define SINCE_MAX_POINTS 1024
+
+/* 以CBOR发送增量同步结果，结构与JSON相同，采样直接取自存储中的定点值 */
+static esp_err_t temperature_since_send_cbor(httpd_req_t *req, rest_server_context_t *rest_context,
+                                             uint32_t boot_id, uint32_t seq, uint32_t max,
+                                             bool reset, uint32_t lost)
+{
+    httpd_resp_set_type(req, "application/cbor");
+
+    cbor_writer_t w;
+    cbor_writer_init(&w, (uint8_t *)rest_context->scratch, SCRATCH_BUFSIZE, req);
+    cbor_map_begin(&w);
+    cbor_kv_uint(&w, "boot", boot_id);
+    cbor_kv_bool(&w, "reset", reset);
+    cbor_kv_uint(&w, "lost", lost);
+    cbor_str(&w, "samples");
+    cbor_arr_begin(&w);
+
+    sample_seq_point_t *points = rest_context->batch.seq;
+    uint32_t sent = 0;
+    while (w.out.err == ESP_OK && sent < max) {
+        size_t batch = max - sent < HISTORY_BATCH_POINTS ? max - sent : HISTORY_BATCH_POINTS;
+        size_t n = sample_store_since(seq, points, batch);
+        if (n == 0) {
+            break;
+        }
+        for (size_t i = 0; i < n; i++) {
+            cbor_arr_begin_n(&w, 4);
+            cbor_uint(&w, points[i].seq);
+            cbor_uint(&w, points[i].timestamp);
+            cbor_int(&w, points[i].value.temp_centi);
+            cbor_uint(&w, points[i].value.hum_centi);
+        }
+        seq = points[n - 1].seq;
+        sent += n;
+    }
+
+    cbor_end(&w);
+    sample_seq_range_t range;
+    sample_store_seq_range(&range);
+    cbor_kv_uint(&w, "seq", seq);
+    cbor_kv_bool(&w, "more", seq < range.newest);
+    cbor_end(&w);
+    if (cbor_writer_finish(&w) != ESP_OK) {
+        ESP_LOGE(REST_TAG, "Since sending failed!");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+/* 增量同步的处理程序：/api/v1/temp/since?seq=&max=，返回序号大于seq的采样 */
+static esp_err_t temperature_since_get_handler(httpd_req_t *req)
+{
+    rest_server_context_t *rest_context = (rest_server_context_t *)req->user_ctx;
+    char *buf = rest_context->scratch;
+    char *query = NULL;
+
+    size_t query_len = httpd_req_get_url_query_len(req) + 1;
+    if (query_len > 1) {
+        query = malloc(query_len);
+        if (query && httpd_req_get_url_query_str(req, query, query_len) != ESP_OK) {
+            free(query);
+            query = NULL;
+        }
+    }
+    uint32_t seq = query_get_u32(query, "seq", 0);
+    uint32_t max = query_get_u32(query, "max", SINCE_DEFAULT_POINTS);
+    free(query);
+    if (max == 0 || max > SINCE_MAX_POINTS) {
+        max = SINCE_MAX_POINTS;
+    }
+
+    sample_seq_range_t range;
+    sample_store_seq_range(&range);
+    // 序号超过最新采样，说明客户端的序号来自上一次启动，从头开始
+    bool reset = seq > range.newest;
+    if (reset) {
+        seq = 0;
+    }
+    // 客户端之后、最早保存的采样之前的采样已被覆盖
+    uint32_t lost = range.oldest > seq + 1 ? range.oldest - seq - 1 : 0;
+
+    if (req_accepts_cbor(req)) {
+        return temperature_since_send_cbor(req, rest_context, range.boot_id, seq, max, reset, lost);
+    }
+
+    httpd_resp_set_type(req, "application/json");  // 设置响应类型为JSON
+
+    json_writer_t w;
+    json_writer_init(&w, buf, SCRATCH_BUFSIZE, req);
+    json_obj_begin(&w);
+    json_kv_uint(&w, "boot", range.boot_id);
+    json_kv_bool(&w, "reset", reset);
+    json_kv_uint(&w, "lost", lost);
+    json_key(&w, "samples");
+    json_arr_begin(&w);
+
+    sample_seq_point_t *points = rest_context->batch.seq;
+    uint32_t sent = 0;
+    while (w.out.err == ESP_OK && sent < max) {
+        size_t batch = max - sent < HISTORY_BATCH_POINTS ? max - sent : HISTORY_BATCH_POINTS;
+        size_t n = sample_store_since(seq, points, batch);
+        if (n == 0) {
+            break;
+        }
+        for (size_t i = 0; i < n; i++) {
+            json_arr_begin(&w);
+            json_uint(&w, points[i].seq);
+            json_uint(&w, points[i].timestamp);
+            json_float(&w, points[i].value.temp_centi / 100.0f, 2);
+            json_float(&w, points[i].value.hum_centi / 100.0f, 2);
+            json_arr_end(&w);
+        }
+        seq = points[n - 1].seq;
+        sent += n;
+    }
+
+    json_arr_end(&w);
+    // 发送期间可能有新采样，按当前最新序号判断是否还有剩余
+    sample_store_seq_range(&range);
+    json_kv_uint(&w, "seq", seq);
+    json_kv_bool(&w, "more", seq < range.newest);
+    json_obj_end(&w);
+    if (json_writer_finish(&w) != ESP_OK) {
+        ESP_LOGE(REST_TAG, "Since sending failed!");
+        return ESP_FAIL;
+    }
     return ESP_OK;
 }
 
+/* 查询flash采样日志的处理程序：/api/v1/temp/log?from=&to=&format=，时间为日志时间，跨重启有效 */
+static esp_err_t temperature_log_get_handler(httpd_req_t *req)
+{
+    rest_server_context_t *rest_context = (rest_server_context_t *)req->user_ctx;
+    char *buf = rest_context->scratch;
+    char *query = NULL;
+    sample_log_stats_t stats;
+    sample_log_get_stats(&stats);
+    if (stats.segments == 0) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_sendstr(req, "Sample log not available");
+        return ESP_OK;
+    }
+    uint32_t now = sample_log_now();
+
+    size_t query_len = httpd_req_get_url_query_len(req) + 1;
+    if (query_len > 1) {
+        query = malloc(query_len);
+        if (query && httpd_req_get_url_query_str(req, query, query_len) != ESP_OK) {
+            free(query);
+            query = NULL;
+        }
+    }
+    uint32_t to = query_get_u32(query, "to", now);
+    uint32_t from = query_get_u32(query, "from", to > 86400 ? to - 86400 : 0);
+    bool delta = query_is_delta(query);
+    free(query);
+
+    sample_log_point_t *points = rest_context->batch.log;
+    sample_log_iter_t iter;
+    sample_log_iter_init(&iter, from, to);
+    size_t n;
+
+    if (delta) {
+        httpd_resp_set_type(req, "application/octet-stream");
+        series_encoder_t enc;
+        series_encoder_init(&enc, (uint8_t *)buf, SCRATCH_BUFSIZE);
+        esp_err_t ret = ESP_OK;
+        while (ret == ESP_OK && (n = sample_log_iter_next(&iter, points, HISTORY_BATCH_POINTS)) > 0) {
+            for (size_t i = 0; ret == ESP_OK && i < n; i++) {
+                series_point_t point = {
+                    .timestamp = points[i].timestamp,
+                    .value = { .temp_centi = points[i].temp_centi, .hum_centi = points[i].hum_centi },
+                };
+                ret = series_send_point(req, &enc, &point);
+            }
+        }
+        return series_send_finish(req, &enc, ret);
+    }
+
+    if (req_accepts_cbor(req)) {
+        httpd_resp_set_type(req, "application/cbor");
+        cbor_writer_t w;
+        cbor_writer_init(&w, (uint8_t *)buf, SCRATCH_BUFSIZE, req);
+        cbor_map_begin(&w);
+        cbor_kv_uint(&w, "now", now);
+        cbor_kv_uint(&w, "oldest", stats.oldest_ts);
+        cbor_kv_uint(&w, "newest", stats.newest_ts);
+        cbor_str(&w, "points");
+        cbor_arr_begin(&w);
+        while (w.out.err == ESP_OK && (n = sample_log_iter_next(&iter, points, HISTORY_BATCH_POINTS)) > 0) {
+            for (size_t i = 0; i < n; i++) {
+                cbor_arr_begin_n(&w, 3);
+                cbor_uint(&w, points[i].timestamp);
+                cbor_int(&w, points[i].temp_centi);
+                cbor_uint(&w, points[i].hum_centi);
+            }
+        }
+        cbor_end(&w);
+        cbor_end(&w);
+        if (cbor_writer_finish(&w) != ESP_OK) {
+            ESP_LOGE(REST_TAG, "Sample log sending failed!");
+            return ESP_FAIL;
+        }
+        return ESP_OK;
+    }
+
+    httpd_resp_set_type(req, "application/json");  // 设置响应类型为JSON
+
+    json_writer_t w;
+    json_writer_init(&w, buf, SCRATCH_BUFSIZE, req);
+    json_obj_begin(&w);
+    json_kv_uint(&w, "now", now);
+    json_kv_uint(&w, "oldest", stats.oldest_ts);
+    json_kv_uint(&w, "newest", stats.newest_ts);
+    json_key(&w, "points");
+    json_arr_begin(&w);
+
+    while (w.out.err == ESP_OK && (n = sample_log_iter_next(&iter, points, HISTORY_BATCH_POINTS)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            json_arr_begin(&w);
+            json_uint(&w, points[i].timestamp);
+            json_float(&w, points[i].temp_centi / 100.0f, 2);
+            json_float(&w, points[i].hum_centi / 100.0f, 2);
+            json_arr_end(&w);
+        }
+    }
+
+    json_arr_end(&w);
+    json_obj_end(&w);
+    if (json_writer_finish(&w) != ESP_OK) {
+        ESP_LOGE(REST_TAG, "Sample log sending failed!");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+/** 推送时一次最多遍历的客户端数 */
+#define STREAM_MAX_CLIENTS CONFIG_LWIP_MAX_SOCKETS
+
+/* 采样推送WebSocket处理程序：握手后仅需保持连接，客户端发来的帧直接丢弃 */
+static esp_err_t temperature_stream_handler(httpd_req_t *req)
+{
+    if (req->method == HTTP_GET) {
+        ESP_LOGI(REST_TAG, "Stream client connected, fd %d", httpd_req_to_sockfd(req));
+        return ESP_OK;
+    }
+
+    httpd_ws_frame_t frame = {0};
+    esp_err_t ret = httpd_ws_recv_frame(req, &frame, 0);  // 只获取帧长度
+    if (ret != ESP_OK || frame.len == 0) {
+        return ret;
+    }
+    if (frame.len >= SCRATCH_BUFSIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    frame.payload = (uint8_t *)((rest_server_context_t *)(req->user_ctx))->scratch;
+    return httpd_ws_recv_frame(req, &frame, frame.len);
+}
+
+/* 在httpd任务中执行：将最新快照推送给所有WebSocket客户端 */
+static void temperature_stream_broadcast(void *arg)
+{
+    rest_server_context_t *rest_context = (rest_server_context_t *)arg;
+    atomic_store(&rest_context->broadcast_pending, false);
+
+    sensor_reading_t reading;
+    if (!sensor_snapshot_read(&g_sensor_snapshot, &reading) || !reading.valid) {
+        return;
+    }
+
+    char payload[64];
+    json_writer_t w;
+    json_writer_init(&w, payload, sizeof(payload), NULL);
+    json_obj_begin(&w);
+    json_kv_float(&w, "t", reading.value.temp_centi / 100.0f, 2);
+    json_kv_float(&w, "h", reading.value.hum_centi / 100.0f, 2);
+    json_kv_uint(&w, "s", reading.seq);
+    json_obj_end(&w);
+    if (json_writer_finish(&w) != ESP_OK) {
+        ESP_LOGE(REST_TAG, "Stream payload truncated");
+        return;
+    }
+    httpd_ws_frame_t frame = {
+        .final = true,
+        .type = HTTPD_WS_TYPE_TEXT,
+        .payload = (uint8_t *)payload,
+        .len = w.out.len,
+    };
+
+    int client_fds[STREAM_MAX_CLIENTS];
+    size_t fds = STREAM_MAX_CLIENTS;
+    if (httpd_get_client_list(rest_context->server, &fds, client_fds) != ESP_OK) {
+        return;
+    }
+    for (size_t i = 0; i < fds; i++) {
+        if (httpd_ws_get_fd_info(rest_context->server, client_fds[i]) == HTTPD_WS_CLIENT_WEBSOCKET) {
+            httpd_ws_send_frame_async(rest_context->server, client_fds[i], &frame);
+        }
+    }
+}
+
+/* 快照发布通知，在采样任务中调用：把推送工作排入httpd任务，已有待执行推送时合并 */
+static void temperature_stream_on_publish(void *arg)
+{
+    rest_server_context_t *rest_context = (rest_server_context_t *)arg;
+    if (atomic_exchange(&rest_context->broadcast_pending, true)) {
+        return;
+    }
+    if (httpd_queue_work(rest_context->server, temperature_stream_broadcast, rest_context) != ESP_OK) {
+        atomic_store(&rest_context->broadcast_pending, false);
+    }
+}
+
 /* 启动HTTP服务器 */
 esp_err_t start_rest_server(const char *base_path)
 {
@@ -206,13 +1253,16 @@ esp_err_t start_rest_server(const char *base_path)
     rest_server_context_t *rest_context = calloc(1, sizeof(rest_server_context_t));
     REST_CHECK(rest_context, "No memory for rest context", err);
     strlcpy(rest_context->base_path, base_path, sizeof(rest_context->base_path));
+    REST_CHECK(render_system_info(rest_context) == ESP_OK, "Render system info failed", err_start);
 
     httpd_handle_t server = NULL;
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.uri_match_fn = httpd_uri_match_wildcard;
+    config.max_uri_handlers = REST_MAX_ROUTES;
 
     ESP_LOGI(REST_TAG, "Starting HTTP Server");
     REST_CHECK(httpd_start(&server, &config) == ESP_OK, "Start server failed", err_start);  // 启动HTTP服务器
+    rest_context->server = server;
 
     /* URI handler for fetching system info */
     httpd_uri_t system_info_get_uri = {
@@ -221,7 +1271,34 @@ esp_err_t start_rest_server(const char *base_path)
         .handler = system_info_get_handler,
         .user_ctx = rest_context
     };
-    httpd_register_uri_handler(server, &system_info_get_uri);  // 注册系统信息获取处理程序
+    register_route(rest_context, &system_info_get_uri);  // 注册系统信息获取处理程序
+
+    /* URI handler for fetching boot timeline */
+    httpd_uri_t system_boot_get_uri = {
+        .uri = "/api/v1/system/boot",
+        .method = HTTP_GET,
+        .handler = system_boot_get_handler,
+        .user_ctx = rest_context
+    };
+    register_route(rest_context, &system_boot_get_uri);  // 注册启动时间线查询处理程序
+
+    /* URI handler for Prometheus metrics */
+    httpd_uri_t metrics_get_uri = {
+        .uri = "/api/v1/metrics",
+        .method = HTTP_GET,
+        .handler = metrics_get_handler,
+        .user_ctx = rest_context
+    };
+    register_route(rest_context, &metrics_get_uri);  // 注册运行指标处理程序
+
+    /* URI handler for downloading the trace log */
+    httpd_uri_t system_log_get_uri = {
+        .uri = "/api/v1/system/log",
+        .method = HTTP_GET,
+        .handler = system_log_get_handler,
+        .user_ctx = rest_context
+    };
+    register_route(rest_context, &system_log_get_uri);  // 注册跟踪日志下载处理程序
 
     /* URI handler for fetching temperature data */
     httpd_uri_t temperature_data_get_uri = {
@@ -230,7 +1307,45 @@ esp_err_t start_rest_server(const char *base_path)
         .handler = temperature_data_get_handler,
         .user_ctx = rest_context
     };
-    httpd_register_uri_handler(server, &temperature_data_get_uri);  // 注册温度数据获取处理程序
+    register_route(rest_context, &temperature_data_get_uri);  // 注册温度数据获取处理程序
+
+    /* URI handler for fetching temperature history */
+    httpd_uri_t temperature_history_get_uri = {
+        .uri = "/api/v1/temp/history",
+        .method = HTTP_GET,
+        .handler = temperature_history_get_handler,
+        .user_ctx = rest_context
+    };
+    register_route(rest_context, &temperature_history_get_uri);  // 注册温湿度历史查询处理程序
+
+    /* URI handler for incremental sample sync */
+    httpd_uri_t temperature_since_get_uri = {
+        .uri = "/api/v1/temp/since",
+        .method = HTTP_GET,
+        .handler = temperature_since_get_handler,
+        .user_ctx = rest_context
+    };
+    register_route(rest_context, &temperature_since_get_uri);  // 注册增量同步处理程序
+
+    /* URI handler for querying the persistent sample log */
+    httpd_uri_t temperature_log_get_uri = {
+        .uri = "/api/v1/temp/log",
+        .method = HTTP_GET,
+        .handler = temperature_log_get_handler,
+        .user_ctx = rest_context
+    };
+    register_route(rest_context, &temperature_log_get_uri);  // 注册采样日志查询处理程序
+
+    /* URI handler for live sample stream (WebSocket) */
+    httpd_uri_t temperature_stream_uri = {
+        .uri = "/api/v1/temp/stream",
+        .method = HTTP_GET,
+        .handler = temperature_stream_handler,
+        .user_ctx = rest_context,
+        .is_websocket = true
+    };
+    register_route(rest_context, &temperature_stream_uri);  // 注册采样推送处理程序
+    sensor_snapshot_set_listener(&g_sensor_snapshot, temperature_stream_on_publish, rest_context);
 
     /* URI handler for light brightness control */
     httpd_uri_t light_brightness_post_uri = {
@@ -239,7 +1354,7 @@ esp_err_t start_rest_server(const char *base_path)
         .handler = light_brightness_post_handler,
         .user_ctx = rest_context
     };
-    httpd_register_uri_handler(server, &light_brightness_post_uri);  // 注册灯光亮度控制处理程序
+    register_route(rest_context, &light_brightness_post_uri);  // 注册灯光亮度控制处理程序
 
     /* URI handler for getting web server files */
     httpd_uri_t common_get_uri = {
@@ -248,7 +1363,7 @@ esp_err_t start_rest_server(const char *base_path)
         .handler = rest_common_get_handler,
         .user_ctx = rest_context
     };
-    httpd_register_uri_handler(server, &common_get_uri);  // 注册文件获取处理程序
+    register_route(rest_context, &common_get_uri);  // 注册文件获取处理程序
 
     return ESP_OK;
 err_start:
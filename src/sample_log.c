@@ -0,0 +1,618 @@
+/**
+ * @file sample_log.c
+ * @brief 温湿度采样的持久化日志实现
+ *
+ * 分区布局：分区划分为若干段，每段首页为段头（魔数、版本、段序号、段起始时间），
+ * 其余为数据页。数据页256字节，页头记录页起始时间、记录数和CRC16，
+ * 之后是41条6字节记录（相对页起始时间的秒差、温度、湿度）。
+ *
+ * 段按物理顺序循环使用，段序号每开一个新段加1。最新段只剩最后几页时开始预擦除下一段
+ * （写满整个分区后即为最旧的段），每次追加最多擦除一个扇区，采样回调中不会出现
+ * 整段擦除的长时间阻塞；开新段时只补擦尚未擦除的扇区。
+ * RAM中保存各段的序号和起始时间作为稀疏索引。
+ */
+#include <string.h>
+#include <time.h>
+#include "sample_log.h"
+#include "esp_crc.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "sdkconfig.h"
+
+_Static_assert(CONFIG_SAMPLE_LOG_SEGMENT_SIZE % 4096 == 0,
+               "CONFIG_SAMPLE_LOG_SEGMENT_SIZE must be a multiple of the flash sector size");
+
+#define LOG_SECTOR_SIZE     4096
+#define LOG_SECTORS_PER_SEG (CONFIG_SAMPLE_LOG_SEGMENT_SIZE / LOG_SECTOR_SIZE)
+#define LOG_PAGE_SIZE       256
+#define LOG_RECS_PER_PAGE   41
+#define LOG_MAX_SEGMENTS    64
+#define LOG_MAGIC           0x474F4C53  // "SLOG"
+#define LOG_VERSION         1
+#define LOG_ERASED_TS       0xFFFFFFFFu
+#define LOG_VALID_EPOCH     1577836800u // 2020-01-01，早于此说明系统时间未同步
+// 最新段剩余页数不超过此值时开始预擦除，每条记录擦除一个扇区，留出两页余量
+#define LOG_ERASE_LEAD_PAGES (LOG_SECTORS_PER_SEG / LOG_RECS_PER_PAGE + 2)
+#define LOG_NO_SEGMENT      UINT32_MAX
+
+// 日志标签
+static const char *TAG = "SAMPLE_LOG";
+
+/** 段头，位于段的首页 */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t page_size;
+    uint32_t seq;       // 段序号，从1开始
+    uint32_t base_ts;   // 段内第一条记录的时间
+} log_seg_header_t;
+
+/** 数据记录 */
+typedef struct __attribute__((packed)) {
+    uint16_t dt;        // 相对页起始时间的秒数
+    int16_t temp_centi;
+    uint16_t hum_centi;
+} log_record_t;
+
+/** 数据页，擦除后未写入的页base_ts为0xFFFFFFFF */
+typedef struct __attribute__((packed)) {
+    uint32_t base_ts;   // 页内第一条记录的时间
+    uint8_t count;      // 记录数
+    uint8_t reserved;
+    uint16_t crc;       // 除本字段外整页的CRC16
+    log_record_t recs[LOG_RECS_PER_PAGE];
+    uint8_t pad[2];
+} log_page_t;
+
+_Static_assert(sizeof(log_page_t) == LOG_PAGE_SIZE, "log page must fill a flash page");
+
+/** 段索引项 */
+typedef struct {
+    uint32_t seq;       // 段序号，0表示无效
+    uint32_t base_ts;   // 段起始时间
+} log_seg_index_t;
+
+static const esp_partition_t *s_part = NULL;
+static SemaphoreHandle_t s_lock = NULL;
+static uint32_t s_seg_count;                // 段数
+static uint16_t s_pages_per_seg;            // 每段页数（含段头页）
+static log_seg_index_t s_index[LOG_MAX_SEGMENTS];
+static uint32_t s_used;                     // 有效段数，从最新段向前连续
+static uint32_t s_head;                     // 最新段的物理下标
+static uint32_t s_head_seq;                 // 最新段的序号，无数据时为0
+static uint16_t s_next_page;                // 最新段下一个写入的页，等于s_pages_per_seg时需开新段
+static log_page_t s_page;                   // 正在填充的页
+static uint32_t s_last_ts;                  // 最新记录的时间
+static uint32_t s_time_base;                // 系统时间未同步时，日志时间 = 启动秒数 + s_time_base
+static uint32_t s_erase_phys = LOG_NO_SEGMENT; // 正在预擦除的段的物理下标
+static uint32_t s_erased;                   // 该段已擦除的扇区数
+static sample_log_stats_t s_stats;
+
+static inline size_t seg_offset(uint32_t phys)
+{
+    return (size_t)phys * CONFIG_SAMPLE_LOG_SEGMENT_SIZE;
+}
+
+static inline size_t page_offset(uint32_t phys, uint16_t page)
+{
+    return seg_offset(phys) + (size_t)page * LOG_PAGE_SIZE;
+}
+
+static inline uint32_t oldest_seq(void)
+{
+    return s_head_seq - s_used + 1;
+}
+
+/* 段序号仍在分区中时返回true并给出物理下标 */
+static bool seg_phys(uint32_t seq, uint32_t *phys)
+{
+    if (s_used == 0 || seq > s_head_seq || s_head_seq - seq >= s_used) {
+        return false;
+    }
+    *phys = (s_head + s_seg_count - (s_head_seq - seq)) % s_seg_count;
+    return true;
+}
+
+/* RAM中正在填充的页在写入后所处的位置 */
+static void ram_page_pos(uint32_t *seq, uint16_t *page)
+{
+    if (s_next_page >= s_pages_per_seg) {
+        *seq = s_head_seq + 1;
+        *page = 1;
+    } else {
+        *seq = s_head_seq;
+        *page = s_next_page;
+    }
+}
+
+static uint16_t page_crc(const log_page_t *page)
+{
+    const uint8_t *p = (const uint8_t *)page;
+    size_t crc_off = offsetof(log_page_t, crc);
+    uint16_t crc = esp_crc16_le(0, p, crc_off);
+    return esp_crc16_le(crc, p + crc_off + sizeof(page->crc), LOG_PAGE_SIZE - crc_off - sizeof(page->crc));
+}
+
+static void page_reset(void)
+{
+    memset(&s_page, 0xFF, sizeof(s_page));
+    s_page.count = 0;
+}
+
+static inline uint32_t read_page_ts(uint32_t phys, uint16_t page)
+{
+    uint32_t ts;
+    if (esp_partition_read(s_part, page_offset(phys, page), &ts, sizeof(ts)) != ESP_OK) {
+        return LOG_ERASED_TS;
+    }
+    return ts;
+}
+
+/* 在段内二分查找第一个页起始时间大于ts的页，未写入的页视为无穷大 */
+static uint16_t page_upper_bound(uint32_t phys, uint16_t pages, uint32_t ts)
+{
+    uint16_t lo = 1, hi = pages;
+    while (lo < hi) {
+        uint16_t mid = lo + (hi - lo) / 2;
+        uint32_t page_ts = read_page_ts(phys, mid);
+        if (page_ts != LOG_ERASED_TS && page_ts <= ts) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/* 擦除下一个物理段中的一个扇区，整段已擦除时直接返回，调用方持有锁 */
+static esp_err_t erase_step_locked(void)
+{
+    uint32_t phys = (s_head + 1) % s_seg_count;
+    if (s_erase_phys != phys) {
+        if (s_used == s_seg_count) {
+            // 覆盖最旧的段，先移出有效范围，擦除中途失败也不会再被读取
+            s_used--;
+        }
+        s_index[phys].seq = 0;
+        s_erase_phys = phys;
+        s_erased = 0;
+    }
+    if (s_erased == LOG_SECTORS_PER_SEG) {
+        return ESP_OK;
+    }
+
+    esp_err_t ret = esp_partition_erase_range(s_part, seg_offset(phys) + (size_t)s_erased * LOG_SECTOR_SIZE,
+                                              LOG_SECTOR_SIZE);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "擦除段 %u 扇区 %u 失败，错误代码: %d", (unsigned)phys, (unsigned)s_erased, ret);
+        return ret;
+    }
+    if (++s_erased == LOG_SECTORS_PER_SEG) {
+        s_stats.erases++;
+    }
+    return ESP_OK;
+}
+
+/* 补擦下一个物理段剩余的扇区并写入段头，调用方持有锁 */
+static esp_err_t open_segment_locked(uint32_t base_ts)
+{
+    uint32_t phys = (s_head + 1) % s_seg_count;
+    do {
+        esp_err_t ret = erase_step_locked();
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    } while (s_erased < LOG_SECTORS_PER_SEG);
+
+    log_seg_header_t hdr = {
+        .magic = LOG_MAGIC,
+        .version = LOG_VERSION,
+        .page_size = LOG_PAGE_SIZE,
+        .seq = s_head_seq + 1,
+        .base_ts = base_ts,
+    };
+    esp_err_t ret = esp_partition_write(s_part, seg_offset(phys), &hdr, sizeof(hdr));
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "写入段头失败，段 %u，错误代码: %d", (unsigned)phys, ret);
+        return ret;
+    }
+
+    s_head = phys;
+    s_head_seq = hdr.seq;
+    s_used++;
+    s_index[phys].seq = hdr.seq;
+    s_index[phys].base_ts = base_ts;
+    s_next_page = 1;
+    s_erase_phys = LOG_NO_SEGMENT;
+    return ESP_OK;
+}
+
+/* 写入RAM中的页，调用方持有锁 */
+static esp_err_t flush_page_locked(void)
+{
+    if (s_page.count == 0) {
+        return ESP_OK;
+    }
+    if (s_next_page >= s_pages_per_seg) {
+        esp_err_t ret = open_segment_locked(s_page.base_ts);
+        if (ret != ESP_OK) {
+            page_reset();
+            return ret;
+        }
+    }
+
+    s_page.crc = page_crc(&s_page);
+    esp_err_t ret = esp_partition_write(s_part, page_offset(s_head, s_next_page), &s_page, sizeof(s_page));
+    // 写入失败时该页可能已部分编程，同样跳过
+    s_next_page++;
+    page_reset();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "写入数据页失败，错误代码: %d", ret);
+        return ret;
+    }
+    s_stats.pages_written++;
+    return ESP_OK;
+}
+
+/* 从最新段的末尾恢复写入位置和最新记录时间 */
+static void recover_tail(void)
+{
+    s_next_page = page_upper_bound(s_head, s_pages_per_seg, LOG_ERASED_TS - 1);
+    s_last_ts = s_index[s_head].base_ts;
+    if (s_next_page <= 1) {
+        return;
+    }
+
+    log_page_t page;
+    if (esp_partition_read(s_part, page_offset(s_head, s_next_page - 1), &page, sizeof(page)) != ESP_OK) {
+        return;
+    }
+    if (page.crc != page_crc(&page) || page.count == 0 || page.count > LOG_RECS_PER_PAGE) {
+        // 掉电时正在写入的页，只有页起始时间可信
+        s_stats.crc_errors++;
+        s_last_ts = page.base_ts;
+        return;
+    }
+    s_last_ts = page.base_ts + page.recs[page.count - 1].dt;
+}
+
+static void sample_log_shutdown(void)
+{
+    sample_log_flush();
+}
+
+/**
+ * @brief 打开日志分区并恢复写入位置
+ *
+ * @return esp_err_t 成功返回ESP_OK；找不到分区返回ESP_ERR_NOT_FOUND
+ */
+esp_err_t sample_log_init(void)
+{
+    if (s_lock != NULL) {
+        return ESP_OK;
+    }
+    s_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                      CONFIG_SAMPLE_LOG_PARTITION_LABEL);
+    if (s_part == NULL) {
+        ESP_LOGE(TAG, "未找到分区: %s", CONFIG_SAMPLE_LOG_PARTITION_LABEL);
+        return ESP_ERR_NOT_FOUND;
+    }
+    s_seg_count = s_part->size / CONFIG_SAMPLE_LOG_SEGMENT_SIZE;
+    if (s_seg_count > LOG_MAX_SEGMENTS) {
+        s_seg_count = LOG_MAX_SEGMENTS;
+    }
+    if (s_seg_count < 2) {
+        ESP_LOGE(TAG, "分区太小，至少需要2个段（%u 字节）", (unsigned)(2 * CONFIG_SAMPLE_LOG_SEGMENT_SIZE));
+        return ESP_ERR_INVALID_SIZE;
+    }
+    s_pages_per_seg = CONFIG_SAMPLE_LOG_SEGMENT_SIZE / LOG_PAGE_SIZE;
+
+    int64_t start = esp_timer_get_time();
+    memset(&s_stats, 0, sizeof(s_stats));
+
+    // 只读取段头，找到序号最大的段
+    int newest = -1;
+    for (uint32_t i = 0; i < s_seg_count; i++) {
+        log_seg_header_t hdr;
+        s_index[i].seq = 0;
+        if (esp_partition_read(s_part, seg_offset(i), &hdr, sizeof(hdr)) != ESP_OK ||
+            hdr.magic != LOG_MAGIC || hdr.version != LOG_VERSION || hdr.page_size != LOG_PAGE_SIZE ||
+            hdr.seq == 0 || hdr.seq == UINT32_MAX) {
+            continue;
+        }
+        s_index[i].seq = hdr.seq;
+        s_index[i].base_ts = hdr.base_ts;
+        if (newest < 0 || hdr.seq > s_index[newest].seq) {
+            newest = (int)i;
+        }
+    }
+
+    if (newest >= 0) {
+        s_head = (uint32_t)newest;
+        s_head_seq = s_index[newest].seq;
+        // 从最新段向前数序号连续的段，旧一轮残留的段因序号不连续而被排除
+        s_used = 1;
+        while (s_used < s_seg_count && s_used < s_head_seq) {
+            uint32_t prev = (s_head + s_seg_count - s_used) % s_seg_count;
+            if (s_index[prev].seq != s_head_seq - s_used) {
+                break;
+            }
+            s_used++;
+        }
+        recover_tail();
+    } else {
+        s_head = s_seg_count - 1;
+        s_head_seq = 0;
+        s_used = 0;
+        s_next_page = s_pages_per_seg;
+        s_last_ts = 0;
+    }
+    s_time_base = s_used > 0 ? s_last_ts + 1 : 0;
+    // 重启前的预擦除进度未知，下一段从头擦除
+    s_erase_phys = LOG_NO_SEGMENT;
+    page_reset();
+    s_stats.recover_us = (uint32_t)(esp_timer_get_time() - start);
+
+    s_lock = xSemaphoreCreateMutex();
+    if (s_lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_register_shutdown_handler(sample_log_shutdown);
+
+    ESP_LOGI(TAG, "采样日志已打开，段 %u/%u，最新段序号 %u 页 %u，恢复耗时 %u us",
+             (unsigned)s_used, (unsigned)s_seg_count, (unsigned)s_head_seq,
+             (unsigned)s_next_page, (unsigned)s_stats.recover_us);
+    return ESP_OK;
+}
+
+/**
+ * @brief 获取日志时间
+ *
+ * @return uint32_t 日志时间，单位：秒
+ */
+uint32_t sample_log_now(void)
+{
+    time_t wall = time(NULL);
+    if (wall >= (time_t)LOG_VALID_EPOCH) {
+        return (uint32_t)wall;
+    }
+    return s_time_base + (uint32_t)(esp_timer_get_time() / 1000000);
+}
+
+/**
+ * @brief 追加一条采样，攒满一页后写入flash
+ *
+ * @param value 定点温湿度
+ * @return esp_err_t 成功返回ESP_OK；未初始化返回ESP_ERR_INVALID_STATE；flash错误返回相应错误码
+ */
+esp_err_t sample_log_append(const aht10_fixed_t *value)
+{
+    if (value == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    uint32_t ts = sample_log_now();
+    esp_err_t ret = ESP_OK;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (ts < s_last_ts) {
+        ts = s_last_ts;
+    }
+    // 与页起始时间的差超出16位时提前结束该页
+    if (s_page.count > 0 && ts - s_page.base_ts > UINT16_MAX) {
+        ret = flush_page_locked();
+    }
+    if (s_page.count == 0) {
+        s_page.base_ts = ts;
+    }
+    log_record_t *rec = &s_page.recs[s_page.count++];
+    rec->dt = (uint16_t)(ts - s_page.base_ts);
+    rec->temp_centi = value->temp_centi;
+    rec->hum_centi = value->hum_centi;
+    s_last_ts = ts;
+    if (s_page.count == LOG_RECS_PER_PAGE) {
+        esp_err_t flush_ret = flush_page_locked();
+        if (ret == ESP_OK) {
+            ret = flush_ret;
+        }
+    } else if (s_pages_per_seg - s_next_page <= LOG_ERASE_LEAD_PAGES) {
+        // 未写页的这次追加顺带擦除一个扇区，开新段时通常已无需擦除
+        esp_err_t erase_ret = erase_step_locked();
+        if (ret == ESP_OK) {
+            ret = erase_ret;
+        }
+    }
+    xSemaphoreGive(s_lock);
+    return ret;
+}
+
+/**
+ * @brief 立即写入RAM中不足一页的记录
+ *
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t sample_log_flush(void)
+{
+    if (s_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    esp_err_t ret = flush_page_locked();
+    xSemaphoreGive(s_lock);
+    return ret;
+}
+
+/**
+ * @brief 初始化查询迭代器
+ *
+ * @param iter 迭代器
+ * @param from 起始时间（含）
+ * @param to 结束时间（含）
+ */
+void sample_log_iter_init(sample_log_iter_t *iter, uint32_t from, uint32_t to)
+{
+    memset(iter, 0, sizeof(*iter));
+    iter->from = from;
+    iter->to = to;
+}
+
+/* 定位第一页可能包含from的页：先在段索引中二分，再在段内按页头二分，调用方持有锁 */
+static void iter_seek_locked(sample_log_iter_t *iter)
+{
+    if (s_used == 0) {
+        ram_page_pos(&iter->seg_seq, &iter->page);
+        return;
+    }
+    // 第一个起始时间大于from的段，其前一段即起点
+    uint32_t lo = 0, hi = s_used;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        uint32_t phys;
+        seg_phys(oldest_seq() + mid, &phys);
+        if (s_index[phys].base_ts <= iter->from) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    uint32_t seq = oldest_seq() + (lo > 0 ? lo - 1 : 0);
+    uint32_t phys;
+    seg_phys(seq, &phys);
+    uint16_t pages = seq == s_head_seq ? s_next_page : s_pages_per_seg;
+    uint16_t page = page_upper_bound(phys, pages, iter->from);
+
+    iter->seg_seq = seq;
+    iter->page = page > 1 ? page - 1 : 1;
+    iter->rec = 0;
+}
+
+/* 从一页中取出记录，页读完返回true，输出已满或超出结束时间返回false */
+static bool iter_emit(sample_log_iter_t *iter, const log_page_t *page,
+                      sample_log_point_t *out, size_t *n, size_t max_points)
+{
+    while (iter->rec < page->count) {
+        if (*n == max_points) {
+            return false;
+        }
+        const log_record_t *rec = &page->recs[iter->rec];
+        uint32_t ts = page->base_ts + rec->dt;
+        if (ts > iter->to) {
+            iter->done = true;
+            return false;
+        }
+        iter->rec++;
+        if (ts >= iter->from) {
+            out[*n].timestamp = ts;
+            out[*n].temp_centi = rec->temp_centi;
+            out[*n].hum_centi = rec->hum_centi;
+            (*n)++;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 按时间顺序取出下一批记录，包含RAM中尚未写入的记录
+ *
+ * @param iter 迭代器
+ * @param out 输出缓冲区
+ * @param max_points 输出缓冲区容量
+ * @return size_t 实际取出的记录数，0表示结束
+ */
+size_t sample_log_iter_next(sample_log_iter_t *iter, sample_log_point_t *out, size_t max_points)
+{
+    if (s_lock == NULL || iter->done || iter->from > iter->to) {
+        return 0;
+    }
+    size_t n = 0;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (!iter->started) {
+        iter_seek_locked(iter);
+        iter->started = true;
+    }
+    while (!iter->done && n < max_points) {
+        uint32_t ram_seq;
+        uint16_t ram_page;
+        ram_page_pos(&ram_seq, &ram_page);
+        if (iter->seg_seq == ram_seq && iter->page == ram_page) {
+            // 已到达尚未写入flash的页，读完即结束
+            if (iter_emit(iter, &s_page, out, &n, max_points)) {
+                iter->done = true;
+            }
+            break;
+        }
+
+        uint32_t phys;
+        if (!seg_phys(iter->seg_seq, &phys)) {
+            if (s_used > 0 && iter->seg_seq < oldest_seq()) {
+                // 查询期间起点所在的段已被擦除，从最旧的段继续
+                iter->seg_seq = oldest_seq();
+                iter->page = 1;
+                iter->rec = 0;
+                continue;
+            }
+            iter->done = true;
+            break;
+        }
+
+        log_page_t page;
+        bool page_done = true;
+        if (esp_partition_read(s_part, page_offset(phys, iter->page), &page, sizeof(page)) != ESP_OK) {
+            iter->done = true;
+            break;
+        }
+        if (page.base_ts == LOG_ERASED_TS) {
+            // 写入失败而跳过的页
+        } else if (page.crc != page_crc(&page) || page.count > LOG_RECS_PER_PAGE) {
+            s_stats.crc_errors++;
+        } else {
+            page_done = iter_emit(iter, &page, out, &n, max_points);
+        }
+        if (page_done) {
+            iter->rec = 0;
+            if (++iter->page >= s_pages_per_seg) {
+                iter->seg_seq++;
+                iter->page = 1;
+            }
+        }
+    }
+    xSemaphoreGive(s_lock);
+    return n;
+}
+
+/**
+ * @brief 读取日志统计
+ *
+ * @param stats 输出统计
+ */
+void sample_log_get_stats(sample_log_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    if (s_lock == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *stats = s_stats;
+    stats->segments = s_seg_count;
+    stats->used_segments = s_used;
+    stats->capacity = s_seg_count * (s_pages_per_seg - 1) * LOG_RECS_PER_PAGE;
+    stats->pending = s_page.count;
+    if (s_used > 0) {
+        uint32_t phys;
+        seg_phys(oldest_seq(), &phys);
+        stats->oldest_ts = s_index[phys].base_ts;
+    } else if (s_page.count > 0) {
+        stats->oldest_ts = s_page.base_ts;
+    }
+    if (s_used > 0 || s_page.count > 0) {
+        stats->newest_ts = s_last_ts;
+    }
+    xSemaphoreGive(s_lock);
+}
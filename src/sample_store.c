@@ -0,0 +1,482 @@
+/**
+ * @file sample_store.c
+ * @brief 多分辨率温湿度时序存储实现
+ *
+ * 原始采样、1分钟汇总和1小时汇总各占一个位于PSRAM的固定大小环形缓冲区。
+ * 每个汇总层维护一个当前桶累加器，新采样到来时以O(1)更新，
+ * 桶结束时写入对应环形缓冲区。全程使用定点值，汇总只做整数运算。环内记录按时间有序，查询起点通过二分查找定位。
+ *
+ * 原始采样以定点值差分编码（series_codec）写入固定大小的块，块写满后开始新块，
+ * 每块是一段独立的编码流，环形缓冲区以块为单位覆盖。按块首时间二分后在块内顺序解码。
+ * 块内采样序号连续，块头记录块首序号，增量同步按块首序号二分定位。
+ */
+#include <string.h>
+#include "sample_store.h"
+#include "series_codec.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_random.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "sdkconfig.h"
+
+// 日志标签
+static const char *TAG = "SAMPLE_STORE";
+
+/** 原始采样块大小 */
+#define RAW_BLOCK_SIZE 128
+
+/** 原始采样块，data为从块首采样开始的差分编码流 */
+typedef struct {
+    uint32_t timestamp; // 块首采样的时间，必须为首个成员，环形缓冲区按此字段二分查找
+    uint32_t seq;       // 块首采样的序号，块内序号连续
+    uint16_t count;     // 块内采样数
+    uint16_t len;       // 编码流长度
+    uint8_t data[RAW_BLOCK_SIZE - 12];
+} sample_raw_block_t;
+
+_Static_assert(sizeof(sample_raw_block_t) == RAW_BLOCK_SIZE, "raw block layout");
+
+/** 环形缓冲区 */
+typedef struct {
+    uint8_t *buf;       // 记录数组
+    size_t elem_size;   // 单条记录大小
+    uint32_t capacity;  // 记录容量
+    uint32_t written;   // 累计写入条数，最新记录序号为written-1
+} sample_ring_t;
+
+/** 汇总桶累加器 */
+typedef struct {
+    uint32_t bucket;    // 桶起始时间
+    uint32_t count;     // 桶内采样数
+    int16_t temp_min;
+    int16_t temp_max;
+    uint16_t hum_min;
+    uint16_t hum_max;
+    int64_t temp_sum;   // 小时桶在高采样率下可能超出32位
+    int64_t hum_sum;
+} rollup_acc_t;
+
+static const uint32_t s_capacity[SAMPLE_RES_MAX] = {
+    [SAMPLE_RES_RAW] = CONFIG_SAMPLE_STORE_RAW_BYTES / RAW_BLOCK_SIZE,
+    [SAMPLE_RES_MINUTE] = CONFIG_SAMPLE_STORE_MINUTE_CAPACITY,
+    [SAMPLE_RES_HOUR] = CONFIG_SAMPLE_STORE_HOUR_CAPACITY,
+};
+
+static const uint32_t s_period[SAMPLE_RES_MAX] = {
+    [SAMPLE_RES_RAW] = 0,
+    [SAMPLE_RES_MINUTE] = SAMPLE_STORE_MINUTE_PERIOD,
+    [SAMPLE_RES_HOUR] = SAMPLE_STORE_HOUR_PERIOD,
+};
+
+static const char *const s_res_name[SAMPLE_RES_MAX] = {
+    [SAMPLE_RES_RAW] = "raw",
+    [SAMPLE_RES_MINUTE] = "1m",
+    [SAMPLE_RES_HOUR] = "1h",
+};
+
+static sample_ring_t s_rings[SAMPLE_RES_MAX];
+static rollup_acc_t s_acc[SAMPLE_RES_MAX];
+static sample_raw_block_t *s_raw_block;     // 正在写入的原始采样块，总是环中最新的块
+static series_encoder_t s_raw_enc;          // s_raw_block的编码器
+static uint32_t s_boot_id;                  // 本次启动的随机标识
+static SemaphoreHandle_t s_lock = NULL;
+
+static inline uint32_t ring_oldest(const sample_ring_t *ring)
+{
+    return ring->written > ring->capacity ? ring->written - ring->capacity : 0;
+}
+
+static inline void *ring_at(const sample_ring_t *ring, uint32_t seq)
+{
+    return ring->buf + (size_t)(seq % ring->capacity) * ring->elem_size;
+}
+
+static inline uint32_t ring_timestamp(const sample_ring_t *ring, uint32_t seq)
+{
+    return *(const uint32_t *)ring_at(ring, seq);
+}
+
+static inline void *ring_push(sample_ring_t *ring)
+{
+    return ring_at(ring, ring->written++);
+}
+
+/* 返回第一个时间戳不小于ts的记录序号，不存在时返回written */
+static uint32_t ring_lower_bound(const sample_ring_t *ring, uint32_t ts)
+{
+    uint32_t lo = ring_oldest(ring);
+    uint32_t hi = ring->written;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (ring_timestamp(ring, mid) < ts) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/* 四舍五入的整数平均值 */
+static inline int32_t mean_round(int64_t sum, uint32_t count)
+{
+    return (int32_t)(sum >= 0 ? (sum + count / 2) / count : -((-sum + count / 2) / count));
+}
+
+static void acc_to_point(const rollup_acc_t *acc, sample_point_t *point)
+{
+    point->timestamp = acc->bucket;
+    point->count = acc->count;
+    point->temp_min = acc->temp_min;
+    point->temp_max = acc->temp_max;
+    point->temp_mean = (int16_t)mean_round(acc->temp_sum, acc->count);
+    point->hum_min = acc->hum_min;
+    point->hum_max = acc->hum_max;
+    point->hum_mean = (uint16_t)mean_round(acc->hum_sum, acc->count);
+}
+
+static void acc_fold(rollup_acc_t *acc, uint32_t bucket, int16_t temp, uint16_t hum)
+{
+    if (acc->count == 0) {
+        acc->bucket = bucket;
+        acc->temp_min = acc->temp_max = temp;
+        acc->hum_min = acc->hum_max = hum;
+        acc->temp_sum = acc->hum_sum = 0;
+    }
+    if (temp < acc->temp_min) acc->temp_min = temp;
+    if (temp > acc->temp_max) acc->temp_max = temp;
+    if (hum < acc->hum_min) acc->hum_min = hum;
+    if (hum > acc->hum_max) acc->hum_max = hum;
+    acc->temp_sum += temp;
+    acc->hum_sum += hum;
+    acc->count++;
+}
+
+/* 从块中第iter->sub个采样起解码，跳过早于from的采样，遇到晚于to的采样时结束查询 */
+static size_t raw_block_read(sample_store_iter_t *iter, const sample_raw_block_t *block,
+                             sample_point_t *out, size_t max_points)
+{
+    series_decoder_t dec;
+    series_point_t point;
+    size_t n = 0;
+    uint32_t index = 0;
+
+    series_decoder_init(&dec, block->data, block->len);
+    while (n < max_points && index < block->count && series_decode(&dec, &point)) {
+        if (index++ < iter->sub) {
+            continue;
+        }
+        if (point.timestamp > iter->to) {
+            iter->done = true;
+            break;
+        }
+        iter->sub++;
+        if (point.timestamp < iter->from) {
+            continue;
+        }
+        out[n].timestamp = point.timestamp;
+        out[n].count = 1;
+        out[n].temp_min = out[n].temp_max = out[n].temp_mean = point.value.temp_centi;
+        out[n].hum_min = out[n].hum_max = out[n].hum_mean = point.value.hum_centi;
+        n++;
+    }
+    return n;
+}
+
+/**
+ * @brief 初始化采样存储，在PSRAM中分配固定大小的环形缓冲区
+ *
+ * @return esp_err_t 成功返回ESP_OK；PSRAM不可用时返回ESP_ERR_NO_MEM
+ */
+esp_err_t sample_store_init(void)
+{
+    if (s_lock != NULL) {
+        return ESP_OK;
+    }
+
+    size_t total = 0;
+    for (int res = 0; res < SAMPLE_RES_MAX; res++) {
+        sample_ring_t *ring = &s_rings[res];
+        ring->elem_size = (res == SAMPLE_RES_RAW) ? sizeof(sample_raw_block_t) : sizeof(sample_point_t);
+        ring->capacity = s_capacity[res];
+        ring->written = 0;
+        ring->buf = heap_caps_calloc(ring->capacity, ring->elem_size, MALLOC_CAP_SPIRAM);
+        if (ring->buf == NULL) {
+            ESP_LOGE(TAG, "PSRAM分配失败，分辨率: %s, 大小: %u 字节",
+                     s_res_name[res], (unsigned)(ring->capacity * ring->elem_size));
+            goto err;
+        }
+        total += ring->capacity * ring->elem_size;
+    }
+    memset(s_acc, 0, sizeof(s_acc));
+    s_raw_block = NULL;
+    s_boot_id = esp_random();
+
+    s_lock = xSemaphoreCreateMutex();
+    if (s_lock == NULL) {
+        goto err;
+    }
+
+    ESP_LOGI(TAG, "采样存储初始化成功，PSRAM占用: %u 字节", (unsigned)total);
+    return ESP_OK;
+
+err:
+    for (int res = 0; res < SAMPLE_RES_MAX; res++) {
+        heap_caps_free(s_rings[res].buf);
+        s_rings[res].buf = NULL;
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+/**
+ * @brief 获取存储使用的当前时间
+ *
+ * @return uint32_t 自启动起的秒数
+ */
+uint32_t sample_store_now(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000000);
+}
+
+/**
+ * @brief 追加一个采样，并以O(1)更新分钟和小时汇总
+ *
+ * @param timestamp 采样时间，单位：秒，应单调不减
+ * @param seq 采样序号，从1开始严格递增
+ * @param value 定点温湿度
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t sample_store_add(uint32_t timestamp, uint32_t seq, const aht10_fixed_t *value)
+{
+    if (value == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    series_point_t point = { .timestamp = timestamp, .value = *value };
+    // 当前块已满或序号不连续时开始新块（可能覆盖最旧的块），新块必能容纳一个采样
+    if (s_raw_block == NULL || seq != s_raw_block->seq + s_raw_block->count ||
+        !series_encode(&s_raw_enc, &point)) {
+        s_raw_block = ring_push(&s_rings[SAMPLE_RES_RAW]);
+        s_raw_block->timestamp = timestamp;
+        s_raw_block->seq = seq;
+        series_encoder_init(&s_raw_enc, s_raw_block->data, sizeof(s_raw_block->data));
+        series_encode(&s_raw_enc, &point);
+    }
+    s_raw_block->count = (uint16_t)s_raw_enc.count;
+    s_raw_block->len = (uint16_t)s_raw_enc.len;
+
+    for (int res = SAMPLE_RES_MINUTE; res < SAMPLE_RES_MAX; res++) {
+        rollup_acc_t *acc = &s_acc[res];
+        uint32_t bucket = timestamp - timestamp % s_period[res];
+        // 进入新桶时，将已结束的桶写入环形缓冲区
+        if (acc->count != 0 && acc->bucket != bucket) {
+            acc_to_point(acc, ring_push(&s_rings[res]));
+            acc->count = 0;
+        }
+        acc_fold(acc, bucket, value->temp_centi, value->hum_centi);
+    }
+
+    xSemaphoreGive(s_lock);
+    return ESP_OK;
+}
+
+/**
+ * @brief 初始化查询迭代器
+ *
+ * @param iter 迭代器
+ * @param res 查询分辨率
+ * @param from 起始时间（含）
+ * @param to 结束时间（含）
+ */
+void sample_store_iter_init(sample_store_iter_t *iter, sample_res_t res, uint32_t from, uint32_t to)
+{
+    memset(iter, 0, sizeof(*iter));
+    iter->res = res < SAMPLE_RES_MAX ? res : SAMPLE_RES_RAW;
+    // 汇总分辨率下，起点对齐到所在桶，使覆盖from的桶也被返回
+    if (s_period[iter->res] != 0) {
+        from -= from % s_period[iter->res];
+    }
+    iter->from = from;
+    iter->to = to;
+    iter->done = (from > to);
+}
+
+/**
+ * @brief 按时间顺序取出下一批数据点
+ *
+ * @param iter 迭代器
+ * @param out 输出缓冲区
+ * @param max_points 输出缓冲区容量
+ * @return size_t 实际取出的数据点数，0表示结束
+ */
+size_t sample_store_iter_next(sample_store_iter_t *iter, sample_point_t *out, size_t max_points)
+{
+    if (iter == NULL || out == NULL || iter->done || s_lock == NULL) {
+        return 0;
+    }
+
+    size_t n = 0;
+    const sample_ring_t *ring = &s_rings[iter->res];
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    if (!iter->started) {
+        iter->next = ring_lower_bound(ring, iter->from);
+        // 原始采样按块首时间定位，from可能落在前一块中
+        if (iter->res == SAMPLE_RES_RAW && iter->next > ring_oldest(ring)) {
+            iter->next--;
+        }
+        iter->sub = 0;
+        iter->started = true;
+    }
+    // 两次调用之间被覆盖的记录直接跳过
+    if (iter->next < ring_oldest(ring)) {
+        iter->next = ring_oldest(ring);
+        iter->sub = 0;
+    }
+
+    while (n < max_points && iter->next < ring->written) {
+        const void *rec = ring_at(ring, iter->next);
+        if (*(const uint32_t *)rec > iter->to) {
+            iter->done = true;
+            break;
+        }
+        if (iter->res == SAMPLE_RES_RAW) {
+            n += raw_block_read(iter, rec, out + n, max_points - n);
+            if (iter->done || iter->sub < ((const sample_raw_block_t *)rec)->count) {
+                break;
+            }
+            iter->sub = 0;
+        } else {
+            memcpy(&out[n++], rec, sizeof(sample_point_t));
+        }
+        iter->next++;
+    }
+
+    // 环形缓冲区已读完，附带尚未结束的当前桶
+    if (!iter->done && n < max_points && iter->next >= ring->written) {
+        const rollup_acc_t *acc = &s_acc[iter->res];
+        if (iter->res != SAMPLE_RES_RAW && acc->count != 0 &&
+            acc->bucket >= iter->from && acc->bucket <= iter->to) {
+            acc_to_point(acc, &out[n++]);
+        }
+        iter->done = true;
+    }
+
+    xSemaphoreGive(s_lock);
+    return n;
+}
+
+/**
+ * @brief 读取原始采样的序号范围
+ *
+ * @param range 输出序号范围
+ */
+void sample_store_seq_range(sample_seq_range_t *range)
+{
+    memset(range, 0, sizeof(*range));
+    if (s_lock == NULL) {
+        return;
+    }
+    const sample_ring_t *ring = &s_rings[SAMPLE_RES_RAW];
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    range->boot_id = s_boot_id;
+    if (s_raw_block != NULL) {
+        range->oldest = ((const sample_raw_block_t *)ring_at(ring, ring_oldest(ring)))->seq;
+        range->newest = s_raw_block->seq + s_raw_block->count - 1;
+    }
+    xSemaphoreGive(s_lock);
+}
+
+/**
+ * @brief 按序号顺序取出序号大于after_seq的原始采样
+ *
+ * @param after_seq 已取得的最新序号，0表示从最早的采样开始
+ * @param out 输出缓冲区
+ * @param max_points 输出缓冲区容量
+ * @return size_t 实际取出的采样数，0表示没有更新的采样
+ */
+size_t sample_store_since(uint32_t after_seq, sample_seq_point_t *out, size_t max_points)
+{
+    if (out == NULL || max_points == 0 || s_lock == NULL) {
+        return 0;
+    }
+    const sample_ring_t *ring = &s_rings[SAMPLE_RES_RAW];
+    size_t n = 0;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    // 第一个块首序号大于after_seq的块，其前一块可能包含更新的采样
+    uint32_t lo = ring_oldest(ring);
+    uint32_t hi = ring->written;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (((const sample_raw_block_t *)ring_at(ring, mid))->seq <= after_seq) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo > ring_oldest(ring)) {
+        lo--;
+    }
+
+    for (uint32_t blk = lo; n < max_points && blk < ring->written; blk++) {
+        const sample_raw_block_t *block = ring_at(ring, blk);
+        series_decoder_t dec;
+        series_point_t point;
+        series_decoder_init(&dec, block->data, block->len);
+        for (uint32_t i = 0; n < max_points && i < block->count && series_decode(&dec, &point); i++) {
+            if (block->seq + i <= after_seq) {
+                continue;
+            }
+            out[n].seq = block->seq + i;
+            out[n].timestamp = point.timestamp;
+            out[n].value = point.value;
+            n++;
+        }
+    }
+
+    xSemaphoreGive(s_lock);
+    return n;
+}
+
+/**
+ * @brief 分辨率名称（"raw"、"1m"、"1h"）
+ *
+ * @param res 分辨率
+ * @return const char* 名称字符串
+ */
+const char *sample_store_res_name(sample_res_t res)
+{
+    return res < SAMPLE_RES_MAX ? s_res_name[res] : "unknown";
+}
+
+/**
+ * @brief 按名称解析分辨率
+ *
+ * @param name 名称字符串
+ * @param res 输出分辨率
+ * @return esp_err_t 成功返回ESP_OK，未知名称返回ESP_ERR_INVALID_ARG
+ */
+esp_err_t sample_store_res_from_name(const char *name, sample_res_t *res)
+{
+    if (name == NULL || res == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < SAMPLE_RES_MAX; i++) {
+        if (strcmp(name, s_res_name[i]) == 0) {
+            *res = (sample_res_t)i;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_INVALID_ARG;
+}
@@ -0,0 +1,266 @@
+/**
+ * @file sampler.c
+ * @brief 多传感器采样调度器
+ *
+ * 一个任务按各传感器的周期调度测量。每个传感器是一个两状态的状态机：
+ * 到期时发送触发命令进入转换状态，转换时间到后读取结果。
+ * 任务只在I2C事务期间占用总线，其余时间休眠到最近的截止时间，
+ * 因此N个传感器的转换相互重叠，吞吐量随传感器数近似线性增长，
+ * 而不是每个传感器阻塞约100ms。
+ *
+ * 休眠由esp_timer单次定时器结束：定时器回调只向调度任务发送任务通知，
+ * I2C传输全部在调度任务中进行，不占用esp_timer任务；唤醒精度为微秒而不是tick。
+ */
+#include <string.h>
+#include "sampler.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+// 日志标签
+static const char *TAG = "SAMPLER";
+
+// 定时器唤醒使用的任务通知索引；索引0留给i2c_bus等以eSetBits通知的模块
+#define SAMPLER_NOTIFY_INDEX 1
+#if configTASK_NOTIFICATION_ARRAY_ENTRIES <= SAMPLER_NOTIFY_INDEX
+#error "CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES must be at least 2 for the sampler"
+#endif
+
+/** 传感器实例运行状态 */
+typedef struct {
+    sampler_sensor_t cfg;   // 配置
+    bool converting;        // 是否已触发、等待结果
+    int64_t next_due_us;    // 下一次触发时间
+    int64_t trigger_us;     // 本次触发时间
+    int64_t ready_us;       // 下一次读取时间
+    sampler_stats_t stats;  // 统计
+} sampler_slot_t;
+
+const sampler_driver_t sampler_driver_aht10 = {
+    .name = "AHT10",
+    .conversion_ms = AHT10_MEASURE_TYPICAL_MS,
+    .poll_ms = AHT10_POLL_INTERVAL_MS,
+    .timeout_ms = AHT10_MEASURE_TIMEOUT_MS,
+    .init = aht10_init_at,
+    .trigger = aht10_trigger_measurement_at,
+    .collect = aht10_collect_fixed_at,
+};
+
+static sampler_slot_t s_slots[CONFIG_SAMPLER_MAX_SENSORS];
+static size_t s_count = 0;
+static TaskHandle_t s_task = NULL;
+static sampler_cb_t s_cb = NULL;
+static void *s_cb_arg = NULL;
+
+/* 交付一次结果并安排下一个周期，周期按固定节拍推进，落后时从当前时间重新计时 */
+static void slot_finish(size_t index, sampler_slot_t *slot, esp_err_t result,
+                        const aht10_fixed_t *value, int64_t now_us)
+{
+    slot->converting = false;
+    slot->stats.last_latency_us = (uint32_t)(now_us - slot->trigger_us);
+    if (result == ESP_OK) {
+        slot->stats.samples++;
+    } else {
+        slot->stats.errors++;
+    }
+
+    int64_t period_us = (int64_t)slot->cfg.period_ms * 1000;
+    slot->next_due_us += period_us;
+    if (slot->next_due_us <= now_us) {
+        slot->stats.overruns++;
+        slot->next_due_us = now_us + period_us;
+    }
+
+    if (s_cb != NULL) {
+        s_cb(index, &slot->cfg, result, result == ESP_OK ? value : NULL, s_cb_arg);
+    }
+}
+
+/* 推进一个传感器的状态机，返回该传感器的下一个截止时间 */
+static int64_t slot_step(size_t index, sampler_slot_t *slot, int64_t now_us)
+{
+    const sampler_driver_t *drv = slot->cfg.driver;
+
+    if (!slot->converting) {
+        if (now_us < slot->next_due_us) {
+            return slot->next_due_us;
+        }
+        slot->trigger_us = now_us;
+        esp_err_t ret = drv->trigger(slot->cfg.i2c_num, slot->cfg.dev_addr);
+        if (ret != ESP_OK) {
+            slot_finish(index, slot, ret, NULL, now_us);
+            return slot->next_due_us;
+        }
+        slot->converting = true;
+        slot->ready_us = now_us + (int64_t)drv->conversion_ms * 1000;
+        return slot->ready_us;
+    }
+
+    if (now_us < slot->ready_us) {
+        return slot->ready_us;
+    }
+    aht10_fixed_t value;
+    esp_err_t ret = drv->collect(slot->cfg.i2c_num, slot->cfg.dev_addr, &value);
+    if (ret == ESP_ERR_NOT_FINISHED) {
+        if (now_us - slot->trigger_us < (int64_t)drv->timeout_ms * 1000) {
+            slot->ready_us = now_us + (int64_t)drv->poll_ms * 1000;
+            return slot->ready_us;
+        }
+        ret = ESP_ERR_TIMEOUT;
+    }
+    slot_finish(index, slot, ret, &value, now_us);
+    return slot->next_due_us;
+}
+
+/* 定时器到期，只唤醒调度任务 */
+static void sampler_wake_cb(void *arg)
+{
+    xTaskNotifyGiveIndexed((TaskHandle_t)arg, SAMPLER_NOTIFY_INDEX);
+}
+
+static void sampler_task(void *arg)
+{
+    // 定时器在任务内创建，回调参数即本任务，不依赖创建者写回的句柄
+    esp_timer_handle_t timer = NULL;
+    const esp_timer_create_args_t timer_args = {
+        .callback = sampler_wake_cb,
+        .arg = xTaskGetCurrentTaskHandle(),
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "sampler_wake",
+    };
+    if (esp_timer_create(&timer_args, &timer) != ESP_OK) {
+        ESP_LOGW(TAG, "创建唤醒定时器失败，改用按tick休眠");
+        timer = NULL;
+    }
+
+    // 各传感器的首次触发错开，避免同时占用总线
+    int64_t start_us = esp_timer_get_time();
+    for (size_t i = 0; i < s_count; i++) {
+        s_slots[i].next_due_us = start_us + (int64_t)i * 1000;
+    }
+
+    while (1) {
+        int64_t now_us = esp_timer_get_time();
+        int64_t wake_us = INT64_MAX;
+        for (size_t i = 0; i < s_count; i++) {
+            int64_t deadline = slot_step(i, &s_slots[i], now_us);
+            if (deadline < wake_us) {
+                wake_us = deadline;
+            }
+        }
+
+        // 休眠到最近的截止时间；已到期时立即进入下一轮
+        int64_t sleep_us = wake_us - esp_timer_get_time();
+        if (sleep_us <= 0) {
+            continue;
+        }
+        if (timer != NULL && esp_timer_start_once(timer, (uint64_t)sleep_us) == ESP_OK) {
+            ulTaskNotifyTakeIndexed(SAMPLER_NOTIFY_INDEX, pdTRUE, portMAX_DELAY);
+        } else {
+            TickType_t ticks = pdMS_TO_TICKS((sleep_us + 999) / 1000);
+            vTaskDelay(ticks > 0 ? ticks : 1);
+        }
+    }
+}
+
+/**
+ * @brief 添加一个传感器实例，并调用驱动的init
+ *
+ * @param sensor 传感器配置
+ * @param index 输出传感器序号，可为NULL
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t sampler_add(const sampler_sensor_t *sensor, size_t *index)
+{
+    if (sensor == NULL || sensor->driver == NULL || sensor->period_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_count >= CONFIG_SAMPLER_MAX_SENSORS) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (sensor->driver->init != NULL) {
+        esp_err_t ret = sensor->driver->init(sensor->i2c_num, sensor->dev_addr);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+
+    sampler_slot_t *slot = &s_slots[s_count];
+    memset(slot, 0, sizeof(*slot));
+    slot->cfg = *sensor;
+    if (index != NULL) {
+        *index = s_count;
+    }
+    s_count++;
+
+    ESP_LOGI(TAG, "添加传感器 %s，端口 %d，地址 0x%02X，周期 %lu ms",
+             sensor->driver->name, (int)sensor->i2c_num, sensor->dev_addr,
+             (unsigned long)sensor->period_ms);
+    return ESP_OK;
+}
+
+/**
+ * @brief 启动调度任务
+ *
+ * @param cb 采样结果回调
+ * @param arg 回调参数
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t sampler_start(sampler_cb_t cb, void *arg)
+{
+    if (s_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_count == 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    s_cb = cb;
+    s_cb_arg = arg;
+#if CONFIG_SAMPLER_TASK_CORE < 0
+    BaseType_t core = tskNO_AFFINITY;
+#else
+    BaseType_t core = CONFIG_SAMPLER_TASK_CORE;
+#endif
+    if (xTaskCreatePinnedToCore(sampler_task, "sampler", CONFIG_SAMPLER_TASK_STACK_SIZE, NULL,
+                                CONFIG_SAMPLER_TASK_PRIORITY, &s_task, core) != pdPASS) {
+        s_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "采样调度器已启动，传感器数: %u", (unsigned)s_count);
+    return ESP_OK;
+}
+
+/**
+ * @brief 已添加的传感器数量
+ *
+ * @return size_t 传感器数量
+ */
+size_t sampler_count(void)
+{
+    return s_count;
+}
+
+/**
+ * @brief 获取传感器实例统计
+ *
+ * @param index 传感器序号
+ * @param stats 输出统计
+ * @return esp_err_t 成功返回ESP_OK；序号无效返回ESP_ERR_INVALID_ARG
+ */
+esp_err_t sampler_get_stats(size_t index, sampler_stats_t *stats)
+{
+    if (index >= s_count || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // 统计只由调度任务更新，各字段独立读取即可
+    *stats = s_slots[index].stats;
+    return ESP_OK;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file sensor_snapshot.c
+ * @brief 最新采样快照（seqlock）实现
+ *
+ * 写者先将计数加一（变为奇数），写入内容后再加一（变为偶数）；
+ * 读者在前后两次读到相同的偶数计数时，拷贝的内容即为一致的快照。
+ */
+#include <string.h>
+#include "sensor_snapshot.h"
+#include "esp_timer.h"
+
+sensor_snapshot_t g_sensor_snapshot;
+
+/**
+ * @brief 发布一次采样
+ *
+ * @param snap 快照
+ * @param value 定点温湿度，为NULL时保留上次数据
+ * @param valid 本次读取是否成功
+ * @return uint32_t 发布后的采样序号
+ */
+uint32_t sensor_snapshot_publish(sensor_snapshot_t *snap, const aht10_fixed_t *value, bool valid)
+{
+    unsigned int lock = atomic_load_explicit(&snap->lock, memory_order_relaxed);
+
+    atomic_store_explicit(&snap->lock, lock + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    if (value != NULL) {
+        snap->reading.value = *value;
+    }
+    snap->reading.timestamp_us = esp_timer_get_time();
+    snap->reading.valid = valid;
+    if (valid) {
+        snap->reading.seq++;
+    }
+    uint32_t seq = snap->reading.seq;
+
+    atomic_store_explicit(&snap->lock, lock + 2, memory_order_release);
+
+    sensor_snapshot_listener_t listener = snap->listener;
+    if (listener != NULL) {
+        listener(snap->listener_arg);
+    }
+    return seq;
+}
+
+/**
+ * @brief 读取最新快照
+ *
+ * @param snap 快照
+ * @param out 输出一致的快照副本
+ * @return bool 已发布过有效采样返回true
+ */
+bool sensor_snapshot_read(sensor_snapshot_t *snap, sensor_reading_t *out)
+{
+    unsigned int before, after;
+
+    do {
+        before = atomic_load_explicit(&snap->lock, memory_order_acquire);
+        memcpy(out, &snap->reading, sizeof(*out));
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&snap->lock, memory_order_relaxed);
+    } while ((before & 1) || before != after);
+
+    return out->seq != 0;
+}
+
+/**
+ * @brief 设置发布通知回调，每次发布后调用；传入NULL取消
+ *
+ * @param snap 快照
+ * @param listener 回调函数
+ * @param arg 回调参数
+ */
+void sensor_snapshot_set_listener(sensor_snapshot_t *snap, sensor_snapshot_listener_t listener, void *arg)
+{
+    snap->listener_arg = arg;
+    snap->listener = listener;
+}
@@ -0,0 +1,263 @@
+/**
+ * @file series_codec.c
+ * @brief 温湿度时序的差分压缩编码实现
+ *
+ * 每个点依次输出三个varint：
+ * - 第一个点：时间戳、zig-zag(温度)、湿度
+ * - 其余各点：zig-zag(时间差 - 上次时间差)、zig-zag(温度差)、zig-zag(湿度差)
+ * varint为小端7位分组，最高位表示后面还有字节。
+ */
+#include <string.h>
+#include "series_codec.h"
+
+static inline uint64_t zigzag_encode(int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static inline int64_t zigzag_decode(uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static inline size_t put_varint(uint8_t *p, uint64_t value)
+{
+    size_t n = 0;
+    while (value >= 0x80) {
+        p[n++] = (uint8_t)value | 0x80;
+        value >>= 7;
+    }
+    p[n++] = (uint8_t)value;
+    return n;
+}
+
+static bool get_varint(series_decoder_t *dec, uint64_t *value)
+{
+    uint64_t result = 0;
+    for (unsigned shift = 0; shift < 64 && dec->pos < dec->len; shift += 7) {
+        uint8_t byte = dec->buf[dec->pos++];
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 初始化编码器，开始一个新的流
+ *
+ * @param enc 编码器
+ * @param buf 输出缓冲区
+ * @param size 缓冲区容量
+ */
+void series_encoder_init(series_encoder_t *enc, uint8_t *buf, size_t size)
+{
+    memset(enc, 0, sizeof(*enc));
+    enc->buf = buf;
+    enc->size = size;
+}
+
+/**
+ * @brief 编码一个点
+ *
+ * @param enc 编码器
+ * @param point 采样
+ * @return bool 缓冲区剩余空间不足时返回false，编码器状态不变
+ */
+bool series_encode(series_encoder_t *enc, const series_point_t *point)
+{
+    uint8_t tmp[SERIES_POINT_MAX_BYTES];
+    size_t room = enc->size - enc->len;
+    // 剩余空间足够最坏情况时直接写入缓冲区，否则先写入临时区再检查长度
+    uint8_t *p = room >= SERIES_POINT_MAX_BYTES ? enc->buf + enc->len : tmp;
+    size_t n;
+    int64_t delta = (int64_t)point->timestamp - enc->prev_ts;
+
+    if (enc->count == 0) {
+        n = put_varint(p, point->timestamp);
+        n += put_varint(p + n, zigzag_encode(point->value.temp_centi));
+        n += put_varint(p + n, point->value.hum_centi);
+        delta = 0;
+    } else {
+        n = put_varint(p, zigzag_encode(delta - enc->prev_delta));
+        n += put_varint(p + n, zigzag_encode((int32_t)point->value.temp_centi - enc->prev.temp_centi));
+        n += put_varint(p + n, zigzag_encode((int32_t)point->value.hum_centi - enc->prev.hum_centi));
+    }
+
+    if (p == tmp) {
+        if (n > room) {
+            return false;
+        }
+        memcpy(enc->buf + enc->len, tmp, n);
+    }
+    enc->len += n;
+    enc->count++;
+    enc->prev_ts = point->timestamp;
+    enc->prev_delta = delta;
+    enc->prev = point->value;
+    return true;
+}
+
+/**
+ * @brief 初始化解码器
+ *
+ * @param dec 解码器
+ * @param buf 编码流
+ * @param len 编码流长度
+ */
+void series_decoder_init(series_decoder_t *dec, const uint8_t *buf, size_t len)
+{
+    memset(dec, 0, sizeof(*dec));
+    dec->buf = buf;
+    dec->len = len;
+}
+
+/**
+ * @brief 解码下一个点
+ *
+ * @param dec 解码器
+ * @param point 输出采样
+ * @return bool 流结束或数据截断时返回false；此时pos小于len说明数据无效
+ */
+bool series_decode(series_decoder_t *dec, series_point_t *point)
+{
+    size_t start = dec->pos;
+    uint64_t ts, temp, hum;
+    if (!get_varint(dec, &ts) || !get_varint(dec, &temp) || !get_varint(dec, &hum)) {
+        dec->pos = start;
+        return false;
+    }
+
+    if (dec->count == 0) {
+        point->timestamp = (uint32_t)ts;
+        point->value.temp_centi = (int16_t)zigzag_decode(temp);
+        point->value.hum_centi = (uint16_t)hum;
+        dec->prev_delta = 0;
+    } else {
+        dec->prev_delta += zigzag_decode(ts);
+        point->timestamp = (uint32_t)(dec->prev_ts + dec->prev_delta);
+        point->value.temp_centi = (int16_t)(dec->prev.temp_centi + zigzag_decode(temp));
+        point->value.hum_centi = (uint16_t)(dec->prev.hum_centi + zigzag_decode(hum));
+    }
+    dec->count++;
+    dec->prev_ts = point->timestamp;
+    dec->prev = point->value;
+    return true;
+}
+
+#if CONFIG_PERF_BENCHMARKS
+#include <stdio.h>
+#include "esp_log.h"
+#include "perf_bench.h"
+
+// 每条序列的点数和编解码轮数
+#define SERIES_BENCH_POINTS 2048
+#define SERIES_BENCH_ROUNDS 20
+
+static const char *TAG = "SERIES_CODEC";
+
+/* 线性同余随机数，返回[-range, range] */
+static int32_t bench_noise(uint32_t *seed, int32_t range)
+{
+    *seed = *seed * 1664525u + 1013904223u;
+    return (int32_t)((*seed >> 16) % (2 * range + 1)) - range;
+}
+
+/*
+ * 生成一条序列：
+ * steady为室内平稳场景，2秒周期偶有1秒抖动，温度缓慢漂移加±3噪声，湿度±10噪声；
+ * 否则为空调启停场景，每10分钟阶跃、噪声更大，并随机丢失采样。
+ */
+static void bench_trace(series_point_t *points, size_t count, bool steady)
+{
+    uint32_t seed = steady ? 0x2468ACE1 : 0x13579BDF;
+    uint32_t ts = 1700000000;
+    int32_t temp = 2350, hum = 4500;
+    for (size_t i = 0; i < count; i++) {
+        ts += 2;
+        if (bench_noise(&seed, 50) == 0) {
+            ts += 1;
+        }
+        if (steady) {
+            if (i % 8 == 0) {
+                temp += bench_noise(&seed, 1);
+            }
+            points[i].value.temp_centi = (int16_t)(temp + bench_noise(&seed, 3));
+            points[i].value.hum_centi = (uint16_t)(hum + bench_noise(&seed, 10));
+        } else {
+            if (i % 300 == 0) {
+                temp = 2000 + bench_noise(&seed, 600);
+                hum = 4000 + bench_noise(&seed, 1500);
+            }
+            // 丢失1至11个采样
+            if (bench_noise(&seed, 20) == 0) {
+                ts += 2 * (uint32_t)(bench_noise(&seed, 5) + 6);
+            }
+            points[i].value.temp_centi = (int16_t)(temp + bench_noise(&seed, 25));
+            points[i].value.hum_centi = (uint16_t)(hum + bench_noise(&seed, 80));
+        }
+        points[i].timestamp = ts;
+    }
+}
+
+static void bench_run(const char *name, const series_point_t *points, size_t count,
+                      uint8_t *buf, size_t size, series_point_t *decoded)
+{
+    char label[48];
+    perf_bench_t bench;
+    series_encoder_t enc;
+
+    snprintf(label, sizeof(label), "%s编码", name);
+    perf_bench_begin(&bench, label);
+    for (int r = 0; r < SERIES_BENCH_ROUNDS; r++) {
+        series_encoder_init(&enc, buf, size);
+        for (size_t i = 0; i < count; i++) {
+            series_encode(&enc, &points[i]);
+        }
+    }
+    perf_bench_end(&bench, SERIES_BENCH_ROUNDS * count);
+
+    size_t n = 0;
+    snprintf(label, sizeof(label), "%s解码", name);
+    perf_bench_begin(&bench, label);
+    for (int r = 0; r < SERIES_BENCH_ROUNDS; r++) {
+        series_decoder_t dec;
+        series_decoder_init(&dec, buf, enc.len);
+        n = 0;
+        while (n < count && series_decode(&dec, &decoded[n])) {
+            n++;
+        }
+    }
+    perf_bench_end(&bench, SERIES_BENCH_ROUNDS * count);
+
+    bool match = n == count && enc.count == count;
+    for (size_t i = 0; match && i < count; i++) {
+        match = decoded[i].timestamp == points[i].timestamp &&
+                decoded[i].value.temp_centi == points[i].value.temp_centi &&
+                decoded[i].value.hum_centi == points[i].value.hum_centi;
+    }
+    // 对照为sample_store原先的记录（时间戳+两个float，12字节）
+    ESP_LOGI(TAG, "%s: %u点 %u字节，平均 %u.%02u 字节/点，压缩比 %u.%02u，往返%s",
+             name, (unsigned)count, (unsigned)enc.len,
+             (unsigned)(enc.len / count), (unsigned)(enc.len * 100 / count % 100),
+             (unsigned)(count * 12 / enc.len), (unsigned)(count * 1200 / enc.len % 100),
+             match ? "一致" : "不一致");
+}
+
+/**
+ * @brief 在模拟的温湿度序列上测量压缩率和编解码耗时，并校验往返结果
+ */
+void series_codec_benchmark(void)
+{
+    static series_point_t points[SERIES_BENCH_POINTS];
+    static series_point_t decoded[SERIES_BENCH_POINTS];
+    static uint8_t buf[SERIES_BENCH_POINTS * SERIES_POINT_MAX_BYTES];
+
+    bench_trace(points, SERIES_BENCH_POINTS, true);
+    bench_run("室内平稳", points, SERIES_BENCH_POINTS, buf, sizeof(buf), decoded);
+    bench_trace(points, SERIES_BENCH_POINTS, false);
+    bench_run("空调启停", points, SERIES_BENCH_POINTS, buf, sizeof(buf), decoded);
+}
+#endif
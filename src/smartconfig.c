@@ -19,8 +19,12 @@ void smartconfig_init(void)
 {
     s_wifi_event_group = xEventGroupCreate();   // 创建事件组
     
-    /* 注册 smartconfig 事件处理程序 */
-    event_handler_register(SC_EVENT, ESP_EVENT_ANY_ID, &smartconfig_event_handler, NULL);
+    /* 注册 smartconfig 事件处理程序，只经事件分发表调用一次。
+       收到 SSID 和密码后要断开、配置并重新连接 WiFi，会阻塞，放到工作任务中执行 */
+    ESP_ERROR_CHECK(event_handler_register_deferred(SC_EVENT, SC_EVENT_GOT_SSID_PSWD,
+                                                    &smartconfig_event_handler, NULL,
+                                                    sizeof(smartconfig_event_got_ssid_pswd_t)));
+    ESP_ERROR_CHECK(event_handler_register(SC_EVENT, SC_EVENT_SEND_ACK_DONE, &smartconfig_event_handler, NULL));
 }
 
 static void smartconfig_event_handler(void* arg, esp_event_base_t event_base,
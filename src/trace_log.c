@@ -0,0 +1,234 @@
+/**
+ * @file trace_log.c
+ * @brief 按核心划分的无锁二进制跟踪日志
+ *
+ * 每个核心一个环形缓冲区。写者以原子加法取得序号，先把槽位序号清零，
+ * 写入内容后再写入序号+1；读者拷贝前后读到的序号都等于期望值时记录有效，
+ * 否则说明该槽位正在写入或已被覆盖，计入丢失数。
+ * 同一核心上被抢占的写者和中断之间只竞争序号，不会互相阻塞。
+ */
+#include <stdio.h>
+#include <stdatomic.h>
+#include "trace_log.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+
+_Static_assert((CONFIG_TRACE_LOG_ENTRIES & (CONFIG_TRACE_LOG_ENTRIES - 1)) == 0,
+               "CONFIG_TRACE_LOG_ENTRIES must be a power of two");
+
+#define TRACE_LOG_MASK (CONFIG_TRACE_LOG_ENTRIES - 1)
+
+// 日志标签
+static const char *TAG = "TRACE_LOG";
+
+// 缓冲区槽位
+typedef struct {
+    atomic_uint seq;            // 记录序号+1，0表示空或正在写入
+    trace_log_entry_t entry;    // 记录内容
+} trace_slot_t;
+
+// 单个核心的环形缓冲区
+typedef struct {
+    trace_slot_t *slots;        // 槽位数组，CONFIG_TRACE_LOG_ENTRIES个
+    atomic_uint head;           // 下一个写入序号
+} trace_ring_t;
+
+#define TRACE_LOG_FORMAT_(id, fmt) fmt,
+static const char *const s_formats[TRACE_LOG_EVENT_MAX] = {
+    TRACE_LOG_EVENTS(TRACE_LOG_FORMAT_)
+};
+#undef TRACE_LOG_FORMAT_
+
+static trace_ring_t s_rings[portNUM_PROCESSORS];
+static atomic_uint s_dropped;
+
+/**
+ * @brief 为每个核心分配环形缓冲区（CONFIG_TRACE_LOG_PSRAM时位于PSRAM）
+ *
+ * @return esp_err_t 成功返回ESP_OK；内存不足返回ESP_ERR_NO_MEM
+ */
+esp_err_t trace_log_init(void)
+{
+#if CONFIG_TRACE_LOG_PSRAM
+    const uint32_t caps = MALLOC_CAP_SPIRAM;
+#else
+    const uint32_t caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+#endif
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        if (s_rings[core].slots != NULL) {
+            continue;
+        }
+        trace_slot_t *slots = heap_caps_calloc(CONFIG_TRACE_LOG_ENTRIES, sizeof(trace_slot_t), caps);
+        if (slots == NULL) {
+            ESP_LOGE(TAG, "缓冲区分配失败，大小: %u 字节",
+                     (unsigned)(CONFIG_TRACE_LOG_ENTRIES * sizeof(trace_slot_t)));
+            return ESP_ERR_NO_MEM;
+        }
+        atomic_store_explicit(&s_rings[core].head, 0, memory_order_relaxed);
+        // 发布指针前槽位内容已清零
+        atomic_thread_fence(memory_order_release);
+        s_rings[core].slots = slots;
+    }
+    ESP_LOGI(TAG, "跟踪日志已启用，每核心 %u 条", (unsigned)CONFIG_TRACE_LOG_ENTRIES);
+    return ESP_OK;
+}
+
+/**
+ * @brief 记录一个事件，一般通过TRACE_LOG宏调用
+ *
+ * @param id 事件ID
+ * @param a0 参数0
+ * @param a1 参数1
+ * @param a2 参数2
+ * @param a3 参数3
+ */
+void trace_log_write(trace_log_id_t id, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3)
+{
+    // 取得核心号后即使任务被迁移，也只是写入另一个核心的缓冲区，序号仍由原子加法保证唯一
+    int core = xPortGetCoreID();
+    trace_ring_t *ring = &s_rings[core];
+    trace_slot_t *slots = ring->slots;
+    if (slots == NULL) {
+        atomic_fetch_add_explicit(&s_dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    uint32_t seq = atomic_fetch_add_explicit(&ring->head, 1, memory_order_relaxed);
+    trace_slot_t *slot = &slots[seq & TRACE_LOG_MASK];
+
+    atomic_store_explicit(&slot->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    slot->entry.timestamp_us = esp_timer_get_time();
+    slot->entry.id = (uint16_t)id;
+    slot->entry.core = (uint8_t)core;
+    slot->entry.args[0] = a0;
+    slot->entry.args[1] = a1;
+    slot->entry.args[2] = a2;
+    slot->entry.args[3] = a3;
+
+    atomic_store_explicit(&slot->seq, seq + 1, memory_order_release);
+}
+
+/**
+ * @brief 创建读取游标，从各核心缓冲区中仍保留的最早记录开始
+ *
+ * @param iter 游标
+ */
+void trace_log_iter_init(trace_log_iter_t *iter)
+{
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        uint32_t head = atomic_load_explicit(&s_rings[core].head, memory_order_acquire);
+        iter->end[core] = head;
+        iter->next[core] = head > CONFIG_TRACE_LOG_ENTRIES ? head - CONFIG_TRACE_LOG_ENTRIES : 0;
+        iter->has_pending[core] = false;
+    }
+    iter->lost = 0;
+}
+
+/* 从一个核心的缓冲区取出下一条有效记录 */
+static bool trace_ring_next(trace_log_iter_t *iter, int core, trace_log_entry_t *entry)
+{
+    const trace_slot_t *slots = s_rings[core].slots;
+    if (slots == NULL) {
+        return false;
+    }
+    while (iter->next[core] != iter->end[core]) {
+        uint32_t seq = iter->next[core]++;
+        const trace_slot_t *slot = &slots[seq & TRACE_LOG_MASK];
+
+        unsigned int before = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        *entry = slot->entry;
+        atomic_thread_fence(memory_order_acquire);
+        unsigned int after = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+        if (before == seq + 1 && after == before) {
+            return true;
+        }
+        iter->lost++;
+    }
+    return false;
+}
+
+/**
+ * @brief 按时间顺序取出下一条记录，只返回创建游标之前写入的记录
+ *
+ * @param iter 游标
+ * @param entry 输出记录
+ * @return bool 没有更多记录时返回false
+ */
+bool trace_log_iter_next(trace_log_iter_t *iter, trace_log_entry_t *entry)
+{
+    int oldest = -1;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        if (!iter->has_pending[core]) {
+            iter->has_pending[core] = trace_ring_next(iter, core, &iter->pending[core]);
+        }
+        if (iter->has_pending[core] &&
+            (oldest < 0 || iter->pending[core].timestamp_us < iter->pending[oldest].timestamp_us)) {
+            oldest = core;
+        }
+    }
+    if (oldest < 0) {
+        return false;
+    }
+    *entry = iter->pending[oldest];
+    iter->has_pending[oldest] = false;
+    return true;
+}
+
+/**
+ * @brief 事件的格式串
+ *
+ * @param id 事件ID
+ * @return const char* 格式串，ID无效时返回NULL
+ */
+const char *trace_log_event_format(uint16_t id)
+{
+    return id < TRACE_LOG_EVENT_MAX ? s_formats[id] : NULL;
+}
+
+/**
+ * @brief 将记录格式化为一行文本："[秒.微秒] C核心 消息\n"
+ *
+ * @param entry 记录
+ * @param buf 输出缓冲区
+ * @param size 缓冲区容量
+ * @return int 输出长度（不含结束符），与snprintf相同，可能超过size
+ */
+int trace_log_format(const trace_log_entry_t *entry, char *buf, size_t size)
+{
+    int n = snprintf(buf, size, "[%lu.%06lu] C%u ",
+                     (unsigned long)(entry->timestamp_us / 1000000),
+                     (unsigned long)(entry->timestamp_us % 1000000), (unsigned)entry->core);
+    if (n < 0 || (size_t)n >= size) {
+        return n;
+    }
+    const char *fmt = trace_log_event_format(entry->id);
+    int m;
+    if (fmt != NULL) {
+        m = snprintf(buf + n, size - n, fmt, entry->args[0], entry->args[1], entry->args[2], entry->args[3]);
+    } else {
+        m = snprintf(buf + n, size - n, "未知事件 %u", (unsigned)entry->id);
+    }
+    if (m < 0) {
+        return m;
+    }
+    n += m;
+    if ((size_t)n + 1 < size) {
+        buf[n] = '\n';
+        buf[n + 1] = '\0';
+    }
+    return n + 1;
+}
+
+/**
+ * @brief 初始化前被丢弃的记录数
+ *
+ * @return uint32_t 记录数
+ */
+uint32_t trace_log_dropped(void)
+{
+    return atomic_load_explicit(&s_dropped, memory_order_relaxed);
+}
@@ -0,0 +1,185 @@
+/**
+ * @file web_assets.c
+ * @brief 内存映射的静态资源镜像
+ *
+ * 由tools/mkwebassets.py生成的镜像烧录在独立的数据分区中，启动时通过
+ * esp_partition_mmap映射到地址空间，无需挂载文件系统；响应直接从映射的flash发送。
+ */
+#include <string.h>
+#include "web_assets.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+
+// 日志标签
+static const char *TAG = "WEB_ASSETS";
+
+static const uint8_t *s_image = NULL;
+static const web_asset_image_header_t *s_header = NULL;
+static const uint16_t *s_slots = NULL;
+static const web_asset_entry_t *s_entries = NULL;
+static esp_partition_mmap_handle_t s_mmap_handle;
+
+/* FNV-1a 32位哈希，初值为镜像中的种子，末尾做fmix32混合使低位均匀 */
+static uint32_t asset_hash(const char *uri, size_t len, uint32_t seed)
+{
+    uint32_t hash = seed;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (uint8_t)uri[i];
+        hash *= 16777619u;
+    }
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+/* 检查镜像内偏移区间是否越界 */
+static bool in_image(uint32_t offset, uint32_t length)
+{
+    return offset <= s_header->image_size && length <= s_header->image_size - offset;
+}
+
+static esp_err_t validate_image(void)
+{
+    const web_asset_image_header_t *hdr = s_header;
+    if (memcmp(hdr->magic, WEB_ASSETS_MAGIC, sizeof(hdr->magic)) != 0 ||
+        hdr->version != WEB_ASSETS_VERSION) {
+        ESP_LOGE(TAG, "资源镜像头无效");
+        return ESP_ERR_INVALID_VERSION;
+    }
+    if (hdr->slot_count == 0 || (hdr->slot_count & (hdr->slot_count - 1)) != 0) {
+        ESP_LOGE(TAG, "哈希槽数无效: %u", hdr->slot_count);
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    size_t slots_size = sizeof(uint16_t) * hdr->slot_count;
+    size_t entries_offset = (sizeof(*hdr) + slots_size + 3) & ~3;
+    if (!in_image(entries_offset, sizeof(web_asset_entry_t) * hdr->entry_count)) {
+        ESP_LOGE(TAG, "资源条目越界");
+        return ESP_ERR_INVALID_SIZE;
+    }
+    s_slots = (const uint16_t *)(s_image + sizeof(*hdr));
+    s_entries = (const web_asset_entry_t *)(s_image + entries_offset);
+
+    for (uint16_t i = 0; i < hdr->entry_count; i++) {
+        const web_asset_entry_t *e = &s_entries[i];
+        if (!in_image(e->uri_offset, 1) || !in_image(e->mime_offset, 1) ||
+            !in_image(e->plain.offset, e->plain.length) || !in_image(e->gzip.offset, e->gzip.length)) {
+            ESP_LOGE(TAG, "资源条目%u越界", i);
+            return ESP_ERR_INVALID_SIZE;
+        }
+    }
+    for (uint16_t i = 0; i < hdr->slot_count; i++) {
+        if (s_slots[i] > hdr->entry_count) {
+            ESP_LOGE(TAG, "哈希槽%u无效", i);
+            return ESP_ERR_INVALID_SIZE;
+        }
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 内存映射静态资源分区并校验镜像
+ *
+ * @param partition_label 分区标签
+ * @return esp_err_t 成功返回ESP_OK；分区不存在返回ESP_ERR_NOT_FOUND；镜像无效返回ESP_ERR_INVALID_VERSION
+ */
+esp_err_t web_assets_init(const char *partition_label)
+{
+    if (s_image != NULL) {
+        return ESP_OK;
+    }
+
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                           ESP_PARTITION_SUBTYPE_ANY, partition_label);
+    if (part == NULL) {
+        ESP_LOGE(TAG, "未找到资源分区: %s", partition_label);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    /* 先只读取镜像头确定实际大小，再映射整个镜像，避免占用多余的MMU页 */
+    web_asset_image_header_t hdr;
+    esp_err_t ret = esp_partition_read(part, 0, &hdr, sizeof(hdr));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (memcmp(hdr.magic, WEB_ASSETS_MAGIC, sizeof(hdr.magic)) != 0 ||
+        hdr.image_size < sizeof(hdr) || hdr.image_size > part->size) {
+        ESP_LOGE(TAG, "分区%s中没有有效的资源镜像", partition_label);
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    const void *ptr = NULL;
+    ret = esp_partition_mmap(part, 0, hdr.image_size, ESP_PARTITION_MMAP_DATA, &ptr, &s_mmap_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "资源分区映射失败 (%s)", esp_err_to_name(ret));
+        return ret;
+    }
+    s_image = ptr;
+    s_header = ptr;
+
+    ret = validate_image();
+    if (ret != ESP_OK) {
+        esp_partition_munmap(s_mmap_handle);
+        s_image = NULL;
+        s_header = NULL;
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "资源镜像已映射: %u 个文件, %lu 字节",
+             s_header->entry_count, (unsigned long)s_header->image_size);
+    return ESP_OK;
+}
+
+/**
+ * @brief 资源镜像是否已映射
+ *
+ * @return bool 已映射返回true
+ */
+bool web_assets_ready(void)
+{
+    return s_image != NULL;
+}
+
+/**
+ * @brief 按URI查找资源，O(1)
+ *
+ * @param uri 请求URI，不含查询字符串
+ * @param uri_len URI长度
+ * @param out 查找结果
+ * @return esp_err_t 成功返回ESP_OK，不存在返回ESP_ERR_NOT_FOUND
+ */
+esp_err_t web_assets_find(const char *uri, size_t uri_len, web_asset_t *out)
+{
+    if (s_image == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (uri == NULL || out == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t slot = asset_hash(uri, uri_len, s_header->hash_seed) & (s_header->slot_count - 1);
+    uint16_t index = s_slots[slot];
+    if (index == 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    /* 完美哈希只保证已知URI无冲突，未知URI仍需比较字符串 */
+    const web_asset_entry_t *e = &s_entries[index - 1];
+    const char *entry_uri = (const char *)s_image + e->uri_offset;
+    if (strncmp(entry_uri, uri, uri_len) != 0 || entry_uri[uri_len] != '\0') {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    out->uri = entry_uri;
+    out->mime = (const char *)s_image + e->mime_offset;
+    out->data = s_image + e->plain.offset;
+    out->length = e->plain.length;
+    out->etag = e->plain.etag;
+    out->gz_data = e->gzip.length ? s_image + e->gzip.offset : NULL;
+    out->gz_length = e->gzip.length;
+    out->gz_etag = e->gzip.etag;
+    return ESP_OK;
+}
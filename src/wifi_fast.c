@@ -0,0 +1,361 @@
+/**
+ * @file wifi_fast.c
+ * @brief WiFi快速重连
+ *
+ * 启动时不再每次进入SmartConfig：NVS中有凭据就直接连接。
+ * 每次获得IP后把AP的BSSID、信道和DHCP租约缓存到NVS，下次连接时锁定BSSID和信道，
+ * 省去全信道扫描；可选把租约作为静态IP，省去DHCP交互。
+ * 缓存失效时退回普通扫描和DHCP，仍失败才交给调用者转入ESPTouch。
+ */
+#include "wifi_fast.h"
+#include <string.h>
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "event_handler.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "nvs.h"
+#include "sdkconfig.h"
+#include "smartconfig.h"
+
+static const char *TAG = "wifi_fast";
+
+// NVS命名空间与键
+#define WIFI_FAST_NVS_NAMESPACE "wifi_fast"
+#define WIFI_FAST_NVS_KEY "link"
+
+// 事件标志
+#define WIFI_FAST_GOT_IP_BIT BIT0
+#define WIFI_FAST_FAIL_BIT BIT1
+
+// 上次成功连接的链路信息
+typedef struct {
+    uint8_t ssid[32];            // 对应的SSID，与当前凭据不一致时缓存无效
+    uint8_t bssid[6];            // AP的MAC地址
+    uint8_t channel;             // AP的主信道
+    uint8_t has_ip;              // ip/dns是否有效
+    esp_netif_ip_info_t ip;      // 上次DHCP租约
+    esp_ip4_addr_t dns;          // 上次的主DNS
+} wifi_fast_cache_t;
+
+// 连接状态
+typedef enum {
+    WIFI_FAST_IDLE,              // 未发起连接
+    WIFI_FAST_CACHED,            // 使用缓存的BSSID/信道连接中
+    WIFI_FAST_PLAIN,             // 普通扫描连接中
+    WIFI_FAST_CONNECTED,         // 已获得IP，断开后自动重连
+    WIFI_FAST_GAVE_UP,           // 已放弃，交给ESPTouch
+} wifi_fast_state_t;
+
+static esp_netif_t *s_netif = NULL;
+static EventGroupHandle_t s_events = NULL;
+static volatile wifi_fast_state_t s_state = WIFI_FAST_IDLE;
+static wifi_fast_cache_t s_cache;
+static bool s_cache_valid = false;
+static bool s_cache_stored = false;   // s_cache与NVS中的内容一致
+static bool s_dhcp_stopped = false;
+static wifi_config_t s_config;
+static uint32_t s_retries = 0;
+static int64_t s_connect_start_us = 0;
+static wifi_fast_stats_t s_stats = { .connect_us = -1, .boot_to_ip_us = -1 };
+
+/**
+ * @brief 从NVS读取链路缓存
+ *
+ * @param cache 输出缓存
+ * @return bool 读取成功返回true
+ */
+static bool load_cache(wifi_fast_cache_t *cache)
+{
+    nvs_handle_t handle;
+    if (nvs_open(WIFI_FAST_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return false;
+    }
+    size_t len = sizeof(*cache);
+    bool ok = nvs_get_blob(handle, WIFI_FAST_NVS_KEY, cache, &len) == ESP_OK && len == sizeof(*cache);
+    nvs_close(handle);
+    return ok;
+}
+
+/**
+ * @brief 把链路缓存写入NVS
+ *
+ * @param cache 缓存
+ */
+static void save_cache(const wifi_fast_cache_t *cache)
+{
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(WIFI_FAST_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "无法打开NVS，链路信息未缓存，错误代码: %d", ret);
+        return;
+    }
+    ret = nvs_set_blob(handle, WIFI_FAST_NVS_KEY, cache, sizeof(*cache));
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "写入链路缓存失败，错误代码: %d", ret);
+    }
+    nvs_close(handle);
+}
+
+/**
+ * @brief 恢复DHCP客户端（使用过静态IP时）
+ */
+static void restore_dhcp(void)
+{
+    if (s_dhcp_stopped) {
+        esp_netif_dhcpc_start(s_netif);
+        s_dhcp_stopped = false;
+    }
+}
+
+/**
+ * @brief 取消驱动配置中的BSSID/信道锁定
+ */
+static void unpin_ap(void)
+{
+    s_config.sta.bssid_set = false;
+    memset(s_config.sta.bssid, 0, sizeof(s_config.sta.bssid));
+    s_config.sta.channel = 0;
+    esp_wifi_set_config(WIFI_IF_STA, &s_config);
+}
+
+/**
+ * @brief 取消BSSID/信道锁定和静态IP，按普通方式重新连接
+ */
+static void connect_plain(void)
+{
+    unpin_ap();
+    restore_dhcp();
+    s_state = WIFI_FAST_PLAIN;
+    s_retries = 0;
+    s_stats.attempts++;
+    esp_wifi_connect();
+}
+
+/**
+ * @brief 获得IP后更新链路缓存，内容不变时不写flash
+ *
+ * @param event 获得IP事件
+ */
+static void update_cache(const ip_event_got_ip_t *event)
+{
+    // 经ESPTouch配网后凭据与s_config不同，以当前配置为准
+    wifi_ap_record_t ap;
+    wifi_config_t config;
+    if (esp_wifi_sta_get_ap_info(&ap) != ESP_OK ||
+        esp_wifi_get_config(WIFI_IF_STA, &config) != ESP_OK) {
+        return;
+    }
+
+    wifi_fast_cache_t cache = { 0 };
+    memcpy(cache.ssid, config.sta.ssid, sizeof(cache.ssid));
+    memcpy(cache.bssid, ap.bssid, sizeof(cache.bssid));
+    cache.channel = ap.primary;
+    cache.has_ip = 1;
+    cache.ip = event->ip_info;
+    esp_netif_dns_info_t dns;
+    if (esp_netif_get_dns_info(s_netif, ESP_NETIF_DNS_MAIN, &dns) == ESP_OK) {
+        cache.dns.addr = dns.ip.u_addr.ip4.addr;
+    }
+
+    s_cache_valid = true;
+    if (s_cache_stored && memcmp(&cache, &s_cache, sizeof(cache)) == 0) {
+        return;
+    }
+    s_cache = cache;
+    s_cache_stored = true;
+    save_cache(&cache);
+    ESP_LOGI(TAG, "链路缓存已更新，BSSID: "MACSTR"，信道: %d",
+             MAC2STR(cache.bssid), cache.channel);
+}
+
+/**
+ * @brief WiFi断开和获得IP事件处理（在延迟执行工作任务中运行）
+ *
+ * @param arg 未使用
+ * @param event_base 事件基础类型
+ * @param event_id 事件ID
+ * @param event_data 事件数据
+ */
+static void wifi_fast_event_handler(void* arg, esp_event_base_t event_base,
+                                    int32_t event_id, void* event_data)
+{
+    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
+        const wifi_event_sta_disconnected_t *evt = event_data;
+        switch (s_state) {
+        case WIFI_FAST_CACHED:
+            ESP_LOGW(TAG, "缓存的AP连接失败（原因 %d），改为普通扫描", evt->reason);
+            s_cache_valid = false;
+            connect_plain();
+            break;
+        case WIFI_FAST_PLAIN:
+            if (s_retries++ < CONFIG_WIFI_FAST_MAX_RETRY) {
+                s_stats.attempts++;
+                esp_wifi_connect();
+            } else {
+                ESP_LOGW(TAG, "连接失败（原因 %d），已重试 %d 次", evt->reason, CONFIG_WIFI_FAST_MAX_RETRY);
+                xEventGroupSetBits(s_events, WIFI_FAST_FAIL_BIT);
+            }
+            break;
+        case WIFI_FAST_CONNECTED:
+            ESP_LOGW(TAG, "连接断开（原因 %d），重新连接", evt->reason);
+            esp_wifi_connect();
+            break;
+        default:
+            break;
+        }
+    } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
+        if (s_state == WIFI_FAST_CACHED) {
+            // 缓存只用于第一次关联，之后断线重连时AP可能已换信道或换了同名AP；
+            // 在设置GOT_IP标志之前完成，此时存储模式仍为RAM
+            unpin_ap();
+        }
+        if (s_state == WIFI_FAST_CACHED || s_state == WIFI_FAST_PLAIN) {
+            int64_t now_us = esp_timer_get_time();
+            s_stats.connect_us = now_us - s_connect_start_us;
+            s_stats.boot_to_ip_us = now_us;
+            xEventGroupSetBits(s_events, WIFI_FAST_GOT_IP_BIT);
+        }
+        // 包括ESPTouch配网后的连接，此后断开都自动重连
+        s_state = WIFI_FAST_CONNECTED;
+        if (s_wifi_event_group != NULL) {
+            xEventGroupSetBits(s_wifi_event_group, CONNECTED_BIT);
+        }
+        update_cache((const ip_event_got_ip_t *)event_data);
+    }
+}
+
+/**
+ * @brief 初始化快速连接模块
+ *
+ * @param sta_netif STA网络接口，用于设置静态IP
+ * @return esp_err_t 成功返回ESP_OK，失败返回相应错误码
+ */
+esp_err_t wifi_fast_init(esp_netif_t *sta_netif)
+{
+    if (sta_netif == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_netif = sta_netif;
+    if (s_events == NULL) {
+        s_events = xEventGroupCreate();
+        if (s_events == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    // 重连和写NVS会阻塞，不在默认事件循环中执行
+    esp_err_t ret = event_handler_register_deferred(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED,
+                                                    &wifi_fast_event_handler, NULL,
+                                                    sizeof(wifi_event_sta_disconnected_t));
+    if (ret == ESP_OK) {
+        ret = event_handler_register_deferred(IP_EVENT, IP_EVENT_STA_GOT_IP,
+                                              &wifi_fast_event_handler, NULL,
+                                              sizeof(ip_event_got_ip_t));
+    }
+    return ret;
+}
+
+/**
+ * @brief 用NVS中保存的凭据直接连接AP，阻塞到获得IP或超时
+ *
+ * @param timeout_ms 超时时间（毫秒）
+ * @return esp_err_t 获得IP返回ESP_OK；没有保存的凭据返回ESP_ERR_NOT_FOUND；
+ *                   连接失败返回ESP_ERR_TIMEOUT
+ */
+esp_err_t wifi_fast_connect(uint32_t timeout_ms)
+{
+    if (s_events == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    wifi_config_t stored;
+    if (esp_wifi_get_config(WIFI_IF_STA, &stored) != ESP_OK || stored.sta.ssid[0] == '\0') {
+        ESP_LOGI(TAG, "没有保存的WiFi凭据");
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    memset(&s_config, 0, sizeof(s_config));
+    memcpy(s_config.sta.ssid, stored.sta.ssid, sizeof(s_config.sta.ssid));
+    memcpy(s_config.sta.password, stored.sta.password, sizeof(s_config.sta.password));
+
+    s_cache_stored = load_cache(&s_cache);
+    s_cache_valid = s_cache_stored &&
+                    memcmp(s_cache.ssid, s_config.sta.ssid, sizeof(s_cache.ssid)) == 0;
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_stats.connect_us = -1;
+    s_stats.boot_to_ip_us = -1;
+    s_stats.used_cache = s_cache_valid;
+    s_stats.attempts = 1;
+    xEventGroupClearBits(s_events, WIFI_FAST_GOT_IP_BIT | WIFI_FAST_FAIL_BIT);
+
+    if (s_cache_valid) {
+        // 锁定BSSID和信道，只在该信道上探测
+        s_config.sta.bssid_set = true;
+        memcpy(s_config.sta.bssid, s_cache.bssid, sizeof(s_config.sta.bssid));
+        s_config.sta.channel = s_cache.channel;
+#if CONFIG_WIFI_FAST_STATIC_IP
+        if (s_cache.has_ip && esp_netif_dhcpc_stop(s_netif) == ESP_OK) {
+            s_dhcp_stopped = true;
+            esp_netif_set_ip_info(s_netif, &s_cache.ip);
+            if (s_cache.dns.addr != 0) {
+                esp_netif_dns_info_t dns = { .ip.type = ESP_IPADDR_TYPE_V4 };
+                dns.ip.u_addr.ip4 = s_cache.dns;
+                esp_netif_set_dns_info(s_netif, ESP_NETIF_DNS_MAIN, &dns);
+            }
+            s_stats.used_static_ip = true;
+        }
+#endif
+        ESP_LOGI(TAG, "使用缓存连接 %s，BSSID: "MACSTR"，信道: %d%s", (const char *)s_config.sta.ssid,
+                 MAC2STR(s_cache.bssid), s_cache.channel, s_stats.used_static_ip ? "，静态IP" : "");
+    } else {
+        ESP_LOGI(TAG, "连接 %s", (const char *)s_config.sta.ssid);
+    }
+
+    // 锁定的BSSID/信道只用于本次连接，不覆盖flash中保存的凭据
+    esp_wifi_set_storage(WIFI_STORAGE_RAM);
+    s_retries = 0;
+    s_state = s_cache_valid ? WIFI_FAST_CACHED : WIFI_FAST_PLAIN;
+    s_connect_start_us = esp_timer_get_time();
+    esp_err_t ret = esp_wifi_set_config(WIFI_IF_STA, &s_config);
+    if (ret == ESP_OK) {
+        ret = esp_wifi_connect();
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "发起连接失败，错误代码: %d", ret);
+        xEventGroupSetBits(s_events, WIFI_FAST_FAIL_BIT);
+    }
+
+    EventBits_t bits = xEventGroupWaitBits(s_events, WIFI_FAST_GOT_IP_BIT | WIFI_FAST_FAIL_BIT,
+                                           pdFALSE, pdFALSE, pdMS_TO_TICKS(timeout_ms));
+    if (bits & WIFI_FAST_GOT_IP_BIT) {
+        esp_wifi_set_storage(WIFI_STORAGE_FLASH);
+        ESP_LOGI(TAG, "已连接，耗时 %lld ms（上电后 %lld ms），尝试 %lu 次",
+                 (long long)(s_stats.connect_us / 1000), (long long)(s_stats.boot_to_ip_us / 1000),
+                 (unsigned long)s_stats.attempts);
+        return ESP_OK;
+    }
+
+    // 先改状态再断开，断开事件不会再触发重连
+    s_state = WIFI_FAST_GAVE_UP;
+    esp_wifi_disconnect();
+    restore_dhcp();
+    esp_wifi_set_storage(WIFI_STORAGE_FLASH);
+    ESP_LOGW(TAG, "快速连接失败");
+    return ESP_ERR_TIMEOUT;
+}
+
+/**
+ * @brief 读取最近一次快速连接的统计
+ *
+ * @param stats 输出统计
+ */
+void wifi_fast_get_stats(wifi_fast_stats_t *stats)
+{
+    *stats = s_stats;
+}
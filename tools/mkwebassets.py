@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+"""将 web-demo/dist 打包为可内存映射的静态资源镜像。
+
+镜像布局（小端）：
+    header    magic "WAST", version, entry_count, hash_seed, slot_count, image_size
+    slots     uint16[slot_count]，值为条目序号+1，0表示空槽
+    entries   web_asset_entry_t[entry_count]
+    strings   URI 与 MIME 字符串，NUL 结尾
+    blobs     文件内容，4字节对齐
+
+URI 查找使用以 hash_seed 为初值、末尾加 fmix32 混合的 FNV-1a 32 位哈希，脚本选择一个使所有 URI
+落在不同槽位的种子（完美哈希），固件只需一次哈希和一次字符串比较。
+格式须与 include/web_assets.h 保持一致。
+"""
+import argparse
+import gzip
+import os
+import struct
+import sys
+
+MAGIC = b'WAST'
+VERSION = 1
+HEADER_FMT = '<4sHHIHHI'
+BLOB_FMT = '<II20s'
+ENTRY_FMT = '<II' + BLOB_FMT[1:] * 2
+ETAG_LEN = 20
+
+MIME_TYPES = {
+    '.html': 'text/html',
+    '.js': 'application/javascript',
+    '.css': 'text/css',
+    '.png': 'image/png',
+    '.ico': 'image/x-icon',
+    '.svg': 'image/svg+xml',
+    '.json': 'application/json',
+    '.map': 'application/json',
+    '.woff': 'font/woff',
+    '.woff2': 'font/woff2',
+}
+
+# 小于该大小或压缩率不足的文件不生成 gzip 变体
+GZIP_THRESHOLD = 1024
+GZIP_MIN_RATIO = 0.8
+
+
+def asset_hash(data, seed):
+    h = seed
+    for b in data:
+        h ^= b
+        h = (h * 16777619) & 0xFFFFFFFF
+    # FNV 的低位只受种子低位影响，按槽数取低位前需做一次雪崩混合（murmur3 fmix32）
+    h ^= h >> 16
+    h = (h * 0x85ebca6b) & 0xFFFFFFFF
+    h ^= h >> 13
+    h = (h * 0xc2b2ae35) & 0xFFFFFFFF
+    h ^= h >> 16
+    return h
+
+
+def fnv1a64_etag(data):
+    h = 0xcbf29ce484222325
+    for b in data:
+        h ^= b
+        h = (h * 0x100000001b3) & 0xFFFFFFFFFFFFFFFF
+    return ('"%016x"' % h).encode()
+
+
+def find_seed(uris, slot_count):
+    for seed in range(0x811c9dc5, 0x811c9dc5 + 1000000):
+        used = set()
+        for uri in uris:
+            slot = asset_hash(uri, seed) & (slot_count - 1)
+            if slot in used:
+                break
+            used.add(slot)
+        else:
+            return seed
+    raise RuntimeError('no perfect hash seed found, increase slot count')
+
+
+def collect(dist_dir):
+    assets = []
+    for root, _, files in os.walk(dist_dir):
+        for name in sorted(files):
+            if name.endswith('.gz'):
+                continue
+            path = os.path.join(root, name)
+            uri = '/' + os.path.relpath(path, dist_dir).replace(os.sep, '/')
+            with open(path, 'rb') as f:
+                plain = f.read()
+            packed = None
+            if len(plain) >= GZIP_THRESHOLD:
+                candidate = gzip.compress(plain, 9, mtime=0)
+                if len(candidate) <= len(plain) * GZIP_MIN_RATIO:
+                    packed = candidate
+            mime = MIME_TYPES.get(os.path.splitext(name)[1].lower(), 'text/plain')
+            assets.append((uri.encode(), mime.encode(), plain, packed))
+    assets.sort(key=lambda a: a[0])
+    return assets
+
+
+def align4(n):
+    return (n + 3) & ~3
+
+
+def build(assets):
+    count = len(assets)
+    slot_count = 1
+    while slot_count < count * 2:
+        slot_count <<= 1
+    seed = find_seed([a[0] for a in assets], slot_count)
+
+    header_size = struct.calcsize(HEADER_FMT)
+    slots_offset = header_size
+    entries_offset = align4(slots_offset + 2 * slot_count)
+    strings_offset = entries_offset + struct.calcsize(ENTRY_FMT) * count
+
+    strings = bytearray()
+    string_offsets = {}
+
+    def add_string(s):
+        if s not in string_offsets:
+            string_offsets[s] = strings_offset + len(strings)
+            strings.extend(s + b'\0')
+        return string_offsets[s]
+
+    for uri, mime, _, _ in assets:
+        add_string(uri)
+        add_string(mime)
+
+    blobs = bytearray()
+    blobs_offset = align4(strings_offset + len(strings))
+
+    def add_blob(data):
+        if data is None:
+            return (0, 0, b'')
+        while len(blobs) % 4:
+            blobs.append(0)
+        offset = blobs_offset + len(blobs)
+        blobs.extend(data)
+        return (offset, len(data), fnv1a64_etag(data))
+
+    entries = bytearray()
+    slots = [0] * slot_count
+    for index, (uri, mime, plain, packed) in enumerate(assets):
+        p = add_blob(plain)
+        g = add_blob(packed)
+        entries += struct.pack(ENTRY_FMT, string_offsets[uri], string_offsets[mime],
+                               p[0], p[1], p[2].ljust(ETAG_LEN, b'\0'),
+                               g[0], g[1], g[2].ljust(ETAG_LEN, b'\0'))
+        slots[asset_hash(uri, seed) & (slot_count - 1)] = index + 1
+
+    image_size = blobs_offset + len(blobs)
+    image = bytearray(struct.pack(HEADER_FMT, MAGIC, VERSION, count, seed, slot_count, 0, image_size))
+    image += struct.pack('<%dH' % slot_count, *slots)
+    image += b'\0' * (entries_offset - len(image))
+    image += entries
+    image += strings
+    image += b'\0' * (blobs_offset - len(image))
+    image += blobs
+    return bytes(image), slot_count, seed
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('dist_dir', help='web-demo/dist directory')
+    parser.add_argument('output', help='asset image to write')
+    parser.add_argument('--max-size', type=lambda x: int(x, 0), default=0,
+                        help='fail if the image exceeds this size (partition size)')
+    args = parser.parse_args()
+
+    if not os.path.isdir(args.dist_dir):
+        sys.exit('%s not found, run "npm run build" in web-demo first' % args.dist_dir)
+
+    assets = collect(args.dist_dir)
+    if not assets:
+        sys.exit('no assets found in %s' % args.dist_dir)
+    image, slot_count, seed = build(assets)
+    if args.max_size and len(image) > args.max_size:
+        sys.exit('asset image is %d bytes, partition holds %d' % (len(image), args.max_size))
+
+    with open(args.output, 'wb') as f:
+        f.write(image)
+    print('packed %d assets into %s: %d bytes, %d slots, seed 0x%08x'
+          % (len(assets), args.output, len(image), slot_count, seed))
+
+
+if __name__ == '__main__':
+    main()
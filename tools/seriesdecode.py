@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""解码 /api/v1/temp/history?res=raw&format=delta 和 /api/v1/temp/log?format=delta 的差分编码流。
+
+编码流由连续的点组成，每点三个varint（小端7位分组，最高位为延续位）：
+    第一个点  时间戳、zigzag(温度)、湿度
+    其余各点  zigzag(时间差 - 上次时间差)、zigzag(温度差)、zigzag(湿度差)
+温湿度单位为0.01。格式须与 include/series_codec.h 保持一致。
+
+用法：
+    seriesdecode.py series.bin
+    seriesdecode.py "http://esp32.local/api/v1/temp/log?format=delta"
+"""
+import argparse
+import sys
+import urllib.request
+
+
+def read_varint(data, offset):
+    result = 0
+    shift = 0
+    while offset < len(data):
+        byte = data[offset]
+        offset += 1
+        result |= (byte & 0x7F) << shift
+        if not byte & 0x80:
+            return result, offset
+        shift += 7
+    raise ValueError('truncated varint at offset %d' % offset)
+
+
+def unzigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def decode(data):
+    points = []
+    offset = 0
+    ts = delta = temp = hum = 0
+    while offset < len(data):
+        a, offset = read_varint(data, offset)
+        b, offset = read_varint(data, offset)
+        c, offset = read_varint(data, offset)
+        if not points:
+            ts, temp, hum = a, unzigzag(b), c
+        else:
+            delta += unzigzag(a)
+            ts += delta
+            temp += unzigzag(b)
+            hum += unzigzag(c)
+        points.append((ts, temp, hum))
+    return points
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('source', help='编码流文件路径或URL，"-"表示标准输入')
+    args = parser.parse_args()
+
+    if args.source == '-':
+        data = sys.stdin.buffer.read()
+    elif args.source.startswith(('http://', 'https://')):
+        with urllib.request.urlopen(args.source) as resp:
+            data = resp.read()
+    else:
+        with open(args.source, 'rb') as f:
+            data = f.read()
+
+    try:
+        points = decode(data)
+    except ValueError as e:
+        print('error: %s' % e, file=sys.stderr)
+        return 1
+    print('timestamp,temperature,humidity')
+    for ts, temp, hum in points:
+        print('%d,%.2f,%.2f' % (ts, temp / 100, hum / 100))
+    print('# %d points, %d bytes, %.2f bytes/point' %
+          (len(points), len(data), len(data) / len(points) if points else 0), file=sys.stderr)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
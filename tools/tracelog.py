@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+"""解码 /api/v1/system/log?format=bin 下载的二进制跟踪日志。
+
+转储布局（小端）：
+    header    magic "TRLG", version, entry_size, event_count, cores, dropped, now_us
+    formats   event_count 个 uint16 长度 + UTF-8 格式串，下标即事件ID
+    entries   trace_log_entry_t，按时间顺序，直到文件结束
+
+格式须与 include/trace_log.h 保持一致。
+
+用法：
+    tracelog.py dump.bin
+    tracelog.py http://esp32.local/api/v1/system/log?format=bin
+"""
+import argparse
+import re
+import struct
+import sys
+import urllib.request
+
+MAGIC = b'TRLG'
+VERSION = 1
+HEADER_FMT = '<4sHHHHIq'
+ENTRY_FMT = '<qHBB4II'
+
+# 固件中所有参数均按32位整数记录，只支持这些转换
+CONVERSION_RE = re.compile(r'%[-+ #0]*\d*(?:\.\d+)?([diouxXc%])')
+
+
+def to_signed(value):
+    return value - (1 << 32) if value & 0x80000000 else value
+
+
+def format_entry(fmt, args):
+    values = []
+    index = 0
+    for m in CONVERSION_RE.finditer(fmt):
+        conv = m.group(1)
+        if conv == '%':
+            continue
+        value = args[index] if index < len(args) else 0
+        index += 1
+        values.append(to_signed(value) if conv in 'di' else value)
+    return fmt % tuple(values)
+
+
+def decode(data):
+    header_size = struct.calcsize(HEADER_FMT)
+    if len(data) < header_size:
+        raise ValueError('dump too short')
+    magic, version, entry_size, event_count, cores, dropped, now_us = \
+        struct.unpack_from(HEADER_FMT, data, 0)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError('not a trace log dump (magic %r, version %d)' % (magic, version))
+    if entry_size != struct.calcsize(ENTRY_FMT):
+        raise ValueError('entry size %d does not match decoder' % entry_size)
+
+    offset = header_size
+    formats = []
+    for _ in range(event_count):
+        (length,) = struct.unpack_from('<H', data, offset)
+        offset += 2
+        formats.append(data[offset:offset + length].decode('utf-8'))
+        offset += length
+
+    lines = []
+    while offset + entry_size <= len(data):
+        ts, event_id, core, _, a0, a1, a2, a3, _ = struct.unpack_from(ENTRY_FMT, data, offset)
+        offset += entry_size
+        if event_id < len(formats):
+            message = format_entry(formats[event_id], (a0, a1, a2, a3))
+        else:
+            message = '未知事件 %d' % event_id
+        lines.append('[%d.%06d] C%d %s' % (ts // 1000000, ts % 1000000, core, message))
+    if dropped:
+        lines.append('# dropped before init %d' % dropped)
+    return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('source', help='转储文件路径或URL，"-"表示标准输入')
+    args = parser.parse_args()
+
+    if args.source == '-':
+        data = sys.stdin.buffer.read()
+    elif args.source.startswith(('http://', 'https://')):
+        with urllib.request.urlopen(args.source) as resp:
+            data = resp.read()
+    else:
+        with open(args.source, 'rb') as f:
+            data = f.read()
+
+    try:
+        for line in decode(data):
+            print(line)
+    except ValueError as e:
+        print('error: %s' % e, file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,164 @@
+// CBOR（RFC 8949）解码，用于设备批量数据接口的Accept: application/cbor响应
+// 支持整数、字符串、数组、映射（含不定长）、布尔/null及半精度/单精度/双精度浮点，标签只保留其内容
+
+const BREAK = Symbol("break");
+const textDecoder = new TextDecoder();
+
+function decodeHalf(bits) {
+  const exponent = (bits >> 10) & 0x1f;
+  const mantissa = bits & 0x3ff;
+  const sign = bits & 0x8000 ? -1 : 1;
+  if (exponent === 0) {
+    return sign * mantissa * Math.pow(2, -24);
+  }
+  if (exponent === 31) {
+    return mantissa ? NaN : sign * Infinity;
+  }
+  return sign * (1024 + mantissa) * Math.pow(2, exponent - 25);
+}
+
+export function decodeCbor(buffer) {
+  const view = new DataView(buffer);
+  let pos = 0;
+
+  // 读取类型头的参数，不定长返回-1
+  function readArgument(info) {
+    if (info < 24) {
+      return info;
+    }
+    let value;
+    switch (info) {
+      case 24:
+        value = view.getUint8(pos);
+        pos += 1;
+        return value;
+      case 25:
+        value = view.getUint16(pos);
+        pos += 2;
+        return value;
+      case 26:
+        value = view.getUint32(pos);
+        pos += 4;
+        return value;
+      case 27:
+        value = view.getUint32(pos) * 4294967296 + view.getUint32(pos + 4);
+        pos += 8;
+        return value;
+      case 31:
+        return -1;
+      default:
+        throw new Error(`CBOR: invalid additional info ${info} at ${pos - 1}`);
+    }
+  }
+
+  // 读取不定长字符串的各分段并拼接
+  function readChunks(major) {
+    const chunks = [];
+    for (;;) {
+      const head = view.getUint8(pos++);
+      if (head === 0xff) {
+        break;
+      }
+      if (head >> 5 !== major) {
+        throw new Error("CBOR: invalid chunk in indefinite string");
+      }
+      const length = readArgument(head & 0x1f);
+      chunks.push(new Uint8Array(buffer, pos, length));
+      pos += length;
+    }
+    const out = new Uint8Array(chunks.reduce((sum, chunk) => sum + chunk.length, 0));
+    let offset = 0;
+    chunks.forEach(chunk => {
+      out.set(chunk, offset);
+      offset += chunk.length;
+    });
+    return out;
+  }
+
+  function readItem() {
+    const head = view.getUint8(pos++);
+    const major = head >> 5;
+    const info = head & 0x1f;
+
+    if (major === 7) {
+      switch (info) {
+        case 20:
+          return false;
+        case 21:
+          return true;
+        case 22:
+          return null;
+        case 23:
+          return undefined;
+        case 25:
+          pos += 2;
+          return decodeHalf(view.getUint16(pos - 2));
+        case 26:
+          pos += 4;
+          return view.getFloat32(pos - 4);
+        case 27:
+          pos += 8;
+          return view.getFloat64(pos - 8);
+        case 31:
+          return BREAK;
+        default:
+          return info < 24 ? info : readArgument(info);
+      }
+    }
+
+    const length = readArgument(info);
+    switch (major) {
+      case 0:
+        return length;
+      case 1:
+        return -1 - length;
+      case 2:
+      case 3: {
+        let bytes;
+        if (length < 0) {
+          bytes = readChunks(major);
+        } else {
+          bytes = new Uint8Array(buffer, pos, length);
+          pos += length;
+        }
+        return major === 3 ? textDecoder.decode(bytes) : bytes;
+      }
+      case 4: {
+        const array = [];
+        if (length < 0) {
+          for (let item = readItem(); item !== BREAK; item = readItem()) {
+            array.push(item);
+          }
+        } else {
+          for (let i = 0; i < length; i++) {
+            array.push(readItem());
+          }
+        }
+        return array;
+      }
+      case 5: {
+        const map = {};
+        if (length < 0) {
+          for (let key = readItem(); key !== BREAK; key = readItem()) {
+            map[key] = readItem();
+          }
+        } else {
+          for (let i = 0; i < length; i++) {
+            const key = readItem();
+            map[key] = readItem();
+          }
+        }
+        return map;
+      }
+      default:
+        // 标签：忽略标签号，返回被标记的值
+        return readItem();
+    }
+  }
+
+  const result = readItem();
+  if (pos !== view.byteLength) {
+    throw new Error(`CBOR: ${view.byteLength - pos} trailing bytes`);
+  }
+  return result;
+}
@@ -1,28 +1,135 @@
 import Vue from 'vue'
 import Vuex from 'vuex'
 import axios from 'axios'
+import { decodeCbor } from './cbor'
 
 Vue.use(Vuex)
 
+// 断线重连间隔（毫秒）
+const RECONNECT_DELAY_MS = 2000
+// 图表显示的点数
+const CHART_POINTS = 19
+// 每次增量同步请求最多取回的采样数
+const SYNC_BATCH = 256
+
+let socket = null
+let reconnectTimer = null
+// 同步进行中再次触发时只记录一次，结束后补做
+let syncing = false
+let syncPending = false
+
+// 以CBOR取回增量采样，温湿度为0.01单位的整数，换算为与JSON相同的[seq, ts, t, h]
+async function fetchSince(seq) {
+  const response = await axios.get("/api/v1/temp/since", {
+    params: { seq, max: SYNC_BATCH },
+    headers: { Accept: "application/cbor" },
+    responseType: "arraybuffer"
+  });
+  const data = decodeCbor(response.data);
+  data.samples = data.samples.map(([s, ts, t, h]) => [s, ts, t / 100, h / 100]);
+  return data;
+}
+
 export default new Vuex.Store({
   state: {
     chart_value: [8, 2, 5, 9, 5, 11, 3, 5, 10, 0, 1, 8, 2, 9, 0, 13, 10, 7, 16],
+    stream_connected: false,
+    // 已取得的最新采样序号
+    last_seq: 0,
+    // 设备本次启动的标识，变化说明设备已重启、序号从1重新开始
+    boot_id: null
   },
   mutations: {
-    update_chart_value(state, new_value) {
-      state.chart_value.push(new_value);
-      state.chart_value.shift();
+    // samples为[[seq, ts, t, h], ...]，按序号递增
+    append_samples(state, samples) {
+      const values = samples.map(sample => sample[2]);
+      state.chart_value = state.chart_value.concat(values).slice(-CHART_POINTS);
+    },
+    set_cursor(state, { seq, boot }) {
+      state.last_seq = seq;
+      state.boot_id = boot;
+    },
+    set_stream_connected(state, connected) {
+      state.stream_connected = connected;
     }
   },
   actions: {
-    update_chart_value({ commit }) {
-      axios.get("/api/v1/temp/raw")
-        .then(data => {
-          commit("update_chart_value", data.data.raw);
-        })
-        .catch(error => {
-          console.log(error);
-        });
+    // 取回last_seq之后的全部采样，每批一次请求
+    async sync({ commit, state, dispatch }) {
+      if (syncing) {
+        syncPending = true;
+        return;
+      }
+      syncing = true;
+      try {
+        if (state.boot_id === null) {
+          // 首次同步只需填满图表，从当前序号前CHART_POINTS个开始
+          const { data } = await axios.get("/api/v1/temp/raw");
+          commit("set_cursor", { seq: Math.max(data.seq - CHART_POINTS, 0), boot: null });
+        }
+        let more = true;
+        while (more) {
+          const data = await fetchSince(state.last_seq);
+          if (state.boot_id !== null && data.boot !== state.boot_id) {
+            // 设备已重启，按首次同步重新定位
+            commit("set_cursor", { seq: 0, boot: null });
+            const raw = await axios.get("/api/v1/temp/raw");
+            commit("set_cursor", { seq: Math.max(raw.data.seq - CHART_POINTS, 0), boot: data.boot });
+            continue;
+          }
+          if (data.samples.length > 0) {
+            commit("append_samples", data.samples);
+          }
+          commit("set_cursor", { seq: data.seq, boot: data.boot });
+          more = data.more;
+        }
+      } catch (error) {
+        console.log(error);
+      } finally {
+        syncing = false;
+      }
+      if (syncPending) {
+        syncPending = false;
+        dispatch("sync");
+      }
+    },
+    // 订阅设备推送的采样流，每个新采样只需一帧WebSocket数据
+    connect_stream({ commit, dispatch, state }) {
+      if (socket) {
+        return;
+      }
+      const scheme = window.location.protocol === "https:" ? "wss" : "ws";
+      socket = new WebSocket(`${scheme}://${window.location.host}/api/v1/temp/stream`);
+      socket.onopen = () => {
+        commit("set_stream_connected", true);
+        // 补齐断线期间错过的采样
+        dispatch("sync");
+      };
+      socket.onmessage = event => {
+        const sample = JSON.parse(event.data);
+        if (sample.s === state.last_seq + 1 && state.boot_id !== null) {
+          commit("append_samples", [[sample.s, null, sample.t, sample.h]]);
+          commit("set_cursor", { seq: sample.s, boot: state.boot_id });
+        } else if (sample.s !== state.last_seq) {
+          // 序号不连续（漏帧或设备重启），改用增量同步
+          dispatch("sync");
+        }
+      };
+      socket.onclose = () => {
+        commit("set_stream_connected", false);
+        socket = null;
+        // 断线期间每次重连前同步一次，退化为轮询
+        dispatch("sync");
+        reconnectTimer = setTimeout(() => dispatch("connect_stream"), RECONNECT_DELAY_MS);
+      };
+    },
+    disconnect_stream() {
+      clearTimeout(reconnectTimer);
+      if (socket) {
+        socket.onclose = null;
+        socket.close();
+        socket = null;
+      }
     }
   }
 })
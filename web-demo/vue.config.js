@@ -1,4 +1,17 @@
+const CompressionPlugin = require('compression-webpack-plugin')
+
 module.exports = {
+  // 固件在 Accept-Encoding 含 gzip 时直接发送 .gz 文件，原始文件保留给不支持的客户端
+  configureWebpack: config => {
+    if (process.env.NODE_ENV === 'production') {
+      config.plugins.push(new CompressionPlugin({
+        test: /\.(js|css|html|svg|json|map)$/,
+        threshold: 1024,
+        minRatio: 0.8,
+        deleteOriginalAssets: false
+      }))
+    }
+  },
   devServer: {
     proxy: {
       '/api': {